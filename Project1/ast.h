@@ -0,0 +1,143 @@
+#ifndef AST_H
+#define AST_H
+
+#include <memory>
+#include <vector>
+#include "scanner.h"
+#include "value.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. EXPRESSIONS
+// =============================================================================
+
+enum ExprKind {
+    EXPR_LITERAL,   // INTEGER | DOUBLE | STRING | TRUE | FALSE
+    EXPR_VARIABLE,  // IDENTIFIER
+    EXPR_ASSIGN,    // IDENTIFIER ASSIGN Expr
+    EXPR_CALL,      // IDENTIFIER LPAREN ArgList? RPAREN
+    EXPR_UNARY,     // (NOT | MINUS) Unary
+    EXPR_BINARY,    // Expr op Expr
+    EXPR_INLINE,    // A call the linker inlined: args bound to slots, then left
+    EXPR_SQUAD,     // LBRACKET ArgList? RBRACKET
+    EXPR_INDEX,     // Postfix LBRACKET Expr RBRACKET
+    EXPR_SET_INDEX, // IDENTIFIER LBRACKET Expr RBRACKET ASSIGN Expr
+    EXPR_BUILTIN    // A CALL the Resolver bound to a built-in rather than a tactic
+};
+
+// Built-in operations on squads. A tactic of the same name hides one.
+enum Builtin {
+    BUILTIN_SIZE,   // size(squad)
+    BUILTIN_SUM,    // sum(squad)
+    BUILTIN_MIN,    // min(squad)
+    BUILTIN_MAX,    // max(squad)
+    BUILTIN_FILL,   // fill(count, value): 'count' copies of a troop or ammo
+    BUILTIN_RANGE   // range(count): the troop squad 0, 1, ..., count - 1
+};
+
+struct Expr {
+    ExprKind kind;
+    int line;
+
+    Value literal;        // LITERAL
+    TokenType op;         // UNARY, BINARY
+    Symbol name;          // VARIABLE, ASSIGN, CALL, INLINE, SET_INDEX, BUILTIN
+
+    // Filled in by the Resolver
+    int slot;             // VARIABLE, ASSIGN, SET_INDEX: frame slot or global index; INLINE: first argument slot
+    bool global;          // VARIABLE, ASSIGN, SET_INDEX: slot is a global index
+    int function;         // CALL: index into Program::functions; BUILTIN: a Builtin
+
+    // Filled in by the linker
+    vector<ValueType> paramTypes;   // INLINE: args convert to these, into slot, slot+1, ...
+
+    unique_ptr<Expr> left;          // UNARY operand, BINARY left, INLINE body, INDEX squad, SET_INDEX index
+    unique_ptr<Expr> right;         // BINARY right, ASSIGN and SET_INDEX value, INDEX index
+    vector<unique_ptr<Expr>> args;  // CALL, INLINE, SQUAD elements, BUILTIN
+
+    Expr(ExprKind kind, int line)
+        : kind(kind), line(line), op(TOK_ERROR), name(NO_SYMBOL), slot(-1), global(false), function(-1) {}
+};
+
+// =============================================================================
+// 2. STATEMENTS
+// =============================================================================
+
+enum StmtKind {
+    STMT_BLOCK,    // LBRACE StatementList RBRACE
+    STMT_VAR,      // Type IDENTIFIER (ASSIGN Expr)? SEMICOLON
+    STMT_IF,       // EVALUATE ... ElsePart?
+    STMT_WHILE,    // MAINTAIN ...
+    STMT_FOR,      // DEPLOY PARALLEL? ...
+    STMT_BRIEF,    // BRIEF Expr SEMICOLON
+    STMT_INTEL,    // INTEL IDENTIFIER SEMICOLON
+    STMT_RETREAT,  // RETREAT Expr? SEMICOLON
+    STMT_ABORT,    // ABORT SEMICOLON
+    STMT_EXPR      // Expr SEMICOLON
+};
+
+// An outer variable a parallel 'deploy' combines across iterations:
+// 'x = x op e' (accumulatorFirst) or 'x = e op x'
+struct Reduction {
+    int slot;
+    ValueType type;
+    TokenType op;          // TOK_PLUS, TOK_MULTIPLY, TOK_AND or TOK_OR
+    bool accumulatorFirst;
+};
+
+struct Stmt {
+    StmtKind kind;
+    int line;
+
+    ValueType varType;    // VAR; INTEL (filled in by the Resolver)
+    Symbol name;          // VAR, INTEL
+
+    // Filled in by the Resolver
+    int slot;             // VAR, INTEL
+    bool global;          // VAR, INTEL
+    bool tailCall;        // RETREAT whose value is a call in tail position
+    bool parallel;        // FOR: 'deploy parallel' (set by the Parser)
+    vector<Reduction> reductions;       // FOR parallel
+
+    unique_ptr<Expr> expr;              // VAR init, IF/WHILE/FOR condition, BRIEF, RETREAT, EXPR
+    unique_ptr<Stmt> init;              // FOR
+    unique_ptr<Expr> update;            // FOR
+    unique_ptr<Stmt> body;              // IF then-branch, WHILE, FOR
+    unique_ptr<Stmt> elseBranch;        // IF
+    vector<unique_ptr<Stmt>> statements; // BLOCK
+
+    Stmt(StmtKind kind, int line)
+        : kind(kind), line(line), varType(VAL_NONE), name(NO_SYMBOL), slot(-1), global(false), tailCall(false), parallel(false) {}
+};
+
+// =============================================================================
+// 3. PROGRAM
+// =============================================================================
+
+struct Param {
+    ValueType type;
+    Symbol name;
+};
+
+struct Function {
+    Symbol name;
+    int line;
+    vector<Param> params;
+    unique_ptr<Stmt> body;   // Null until the body is parsed
+    int bodyBegin = -1;      // Token range of the body, LBRACE .. RBRACE,
+    int bodyEnd = -1;        // recorded by the skim pass for deferred parsing
+    int frameSize = 0;       // Slots needed by params and locals (Resolver, grown by inlining)
+    int module = 0;          // Source file it came from: 0 is the main file, then #supply order
+    bool resolved = false;
+};
+
+struct Program {
+    vector<Symbol> supplies;           // #supply module names
+    vector<unique_ptr<Stmt>> globals;  // Global STMT_VAR declarations, in order
+    vector<Function> functions;
+    int campaign = -1;                 // Index of 'tactic campaign()', or -1
+    shared_ptr<Interner> names;        // Text of its symbols; null for Interner::global()
+};
+
+#endif // AST_H
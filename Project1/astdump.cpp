@@ -0,0 +1,235 @@
+#include "astdump.h"
+#include "interpreter.h"
+
+static const string& nameOf(Symbol symbol) {
+    return Interner::current().name(symbol);
+}
+
+string operatorText(TokenType op) {
+    switch (op) {
+        case TOK_PLUS:          return "+";
+        case TOK_MINUS:         return "-";
+        case TOK_MULTIPLY:      return "*";
+        case TOK_DIVIDE:        return "/";
+        case TOK_MODULO:        return "%";
+        case TOK_EQUAL:         return "==";
+        case TOK_NOT_EQUAL:     return "!=";
+        case TOK_LESS:          return "<";
+        case TOK_GREATER:       return ">";
+        case TOK_LESS_EQUAL:    return "<=";
+        case TOK_GREATER_EQUAL: return ">=";
+        case TOK_AND:           return "&&";
+        case TOK_OR:            return "||";
+        case TOK_NOT:           return "!";
+        default:                return Scanner::tokenTypeToString(op);
+    }
+}
+
+static void dumpExpr(const Expr& expr, ostream& out) {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            if (expr.literal.type == VAL_CODENAME) {
+                out << '"' << expr.literal.codename() << '"';
+            } else {
+                out << Interpreter::format(expr.literal, expr.line);
+            }
+            break;
+
+        case EXPR_VARIABLE:
+            out << nameOf(expr.name);
+            break;
+
+        case EXPR_ASSIGN:
+            out << "(= " << nameOf(expr.name) << " ";
+            dumpExpr(*expr.right, out);
+            out << ")";
+            break;
+
+        case EXPR_CALL:
+            out << "(call " << nameOf(expr.name);
+            for (const unique_ptr<Expr>& arg : expr.args) {
+                out << " ";
+                dumpExpr(*arg, out);
+            }
+            out << ")";
+            break;
+
+        case EXPR_UNARY:
+            out << "(" << operatorText(expr.op) << " ";
+            dumpExpr(*expr.left, out);
+            out << ")";
+            break;
+
+        case EXPR_BINARY:
+            out << "(" << operatorText(expr.op) << " ";
+            dumpExpr(*expr.left, out);
+            out << " ";
+            dumpExpr(*expr.right, out);
+            out << ")";
+            break;
+
+        case EXPR_INLINE:
+            out << "(inline " << nameOf(expr.name) << " (";
+            for (size_t i = 0; i < expr.args.size(); i++) {
+                if (i > 0) out << " ";
+                dumpExpr(*expr.args[i], out);
+            }
+            out << ") ";
+            dumpExpr(*expr.left, out);
+            out << ")";
+            break;
+
+        case EXPR_SQUAD:
+            out << "(squad";
+            for (const unique_ptr<Expr>& element : expr.args) {
+                out << " ";
+                dumpExpr(*element, out);
+            }
+            out << ")";
+            break;
+
+        case EXPR_INDEX:
+            out << "(index ";
+            dumpExpr(*expr.left, out);
+            out << " ";
+            dumpExpr(*expr.right, out);
+            out << ")";
+            break;
+
+        case EXPR_SET_INDEX:
+            out << "(set-index " << nameOf(expr.name) << " ";
+            dumpExpr(*expr.left, out);
+            out << " ";
+            dumpExpr(*expr.right, out);
+            out << ")";
+            break;
+
+        case EXPR_BUILTIN:
+            out << "(builtin " << nameOf(expr.name);
+            for (const unique_ptr<Expr>& arg : expr.args) {
+                out << " ";
+                dumpExpr(*arg, out);
+            }
+            out << ")";
+            break;
+    }
+}
+
+static void indent(int depth, ostream& out) {
+    for (int i = 0; i < depth; i++) out << "  ";
+}
+
+static void dumpStmt(const Stmt& stmt, int depth, ostream& out) {
+    indent(depth, out);
+    switch (stmt.kind) {
+        case STMT_BLOCK:
+            out << "(block";
+            for (const unique_ptr<Stmt>& inner : stmt.statements) {
+                out << "\n";
+                dumpStmt(*inner, depth + 1, out);
+            }
+            out << ")";
+            break;
+
+        case STMT_VAR:
+            out << "(var " << valueTypeName(stmt.varType) << " " << nameOf(stmt.name);
+            if (stmt.expr) {
+                out << " ";
+                dumpExpr(*stmt.expr, out);
+            }
+            out << ")";
+            break;
+
+        case STMT_IF:
+            out << "(evaluate ";
+            dumpExpr(*stmt.expr, out);
+            out << "\n";
+            dumpStmt(*stmt.body, depth + 1, out);
+            if (stmt.elseBranch) {
+                out << "\n";
+                dumpStmt(*stmt.elseBranch, depth + 1, out);
+            }
+            out << ")";
+            break;
+
+        case STMT_WHILE:
+            out << "(maintain ";
+            dumpExpr(*stmt.expr, out);
+            out << "\n";
+            dumpStmt(*stmt.body, depth + 1, out);
+            out << ")";
+            break;
+
+        case STMT_FOR:
+            out << (stmt.parallel ? "(deploy parallel\n" : "(deploy\n");
+            if (stmt.init) {
+                dumpStmt(*stmt.init, depth + 1, out);
+            } else {
+                indent(depth + 1, out);
+                out << "()";
+            }
+            out << "\n";
+            indent(depth + 1, out);
+            if (stmt.expr) dumpExpr(*stmt.expr, out); else out << "()";
+            out << "\n";
+            indent(depth + 1, out);
+            if (stmt.update) dumpExpr(*stmt.update, out); else out << "()";
+            out << "\n";
+            dumpStmt(*stmt.body, depth + 1, out);
+            out << ")";
+            break;
+
+        case STMT_BRIEF:
+            out << "(brief ";
+            dumpExpr(*stmt.expr, out);
+            out << ")";
+            break;
+
+        case STMT_INTEL:
+            out << "(intel " << nameOf(stmt.name) << ")";
+            break;
+
+        case STMT_RETREAT:
+            out << "(retreat";
+            if (stmt.expr) {
+                out << " ";
+                dumpExpr(*stmt.expr, out);
+            }
+            out << ")";
+            break;
+
+        case STMT_ABORT:
+            out << "(abort)";
+            break;
+
+        case STMT_EXPR:
+            dumpExpr(*stmt.expr, out);
+            break;
+    }
+}
+
+void dumpProgram(const Program& program, ostream& out) {
+    InternerScope scope(program.names.get());
+    for (Symbol module : program.supplies) {
+        out << "(supply " << nameOf(module) << ")\n";
+    }
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        dumpStmt(*global, 0, out);
+        out << "\n";
+    }
+    for (const Function& function : program.functions) {
+        out << "(tactic " << nameOf(function.name) << " (";
+        for (size_t i = 0; i < function.params.size(); i++) {
+            if (i > 0) out << " ";
+            out << "(" << valueTypeName(function.params[i].type) << " " << nameOf(function.params[i].name) << ")";
+        }
+        out << ")\n";
+        if (function.body) {
+            dumpStmt(*function.body, 1, out);
+        } else {
+            indent(1, out);
+            out << "(deferred tokens " << function.bodyBegin << ".." << function.bodyEnd << ")";
+        }
+        out << ")\n";
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef ASTDUMP_H
+#define ASTDUMP_H
+
+#include <ostream>
+#include "ast.h"
+
+using namespace std;
+
+// Writes the program as one S-expression per declaration, e.g.
+//   (tactic f ((troop n)) (block (retreat (+ n 1))))
+// Tactics whose bodies are still deferred print as (deferred tokens A..B).
+// The output is stable, so an eager and a lazy parse can be diffed.
+void dumpProgram(const Program& program, ostream& out);
+
+// Source spelling of an operator token, e.g. "<=" for TOK_LESS_EQUAL
+string operatorText(TokenType op);
+
+#endif // ASTDUMP_H
@@ -0,0 +1,194 @@
+#include "compiler.h"
+#include <fstream>   // For readFile
+#include <sstream>   // For readFile
+
+// =============================================================================
+// 1. SOURCE FILES
+// =============================================================================
+
+string readFile(const string& filepath) {
+    ifstream file(filepath);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file '" << filepath << "'" << endl;
+        return "";
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    file.close();
+    return buffer.str();
+}
+
+// Directory part of a path, with its trailing separator ("" for a bare file name)
+static string directoryOf(const string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == string::npos ? "" : path.substr(0, slash + 1);
+}
+
+bool findModuleFile(const string& name, const string& supplier, string& path, string& source) {
+    path = directoryOf(supplier) + name + ".tac";
+    if (!ifstream(path).is_open()) return false;
+    source = readFile(path);
+    return true;
+}
+
+bool findNoModule(const string& name, const string&, string& path, string&) {
+    path = name;
+    return false;
+}
+
+// Reports scanner errors. Returns false if there were any.
+static bool checkTokens(const vector<Token>& tokens, ostream& errors) {
+    int errorCount = 0;
+    for (const Token& token : tokens) {
+        if (token.type == TOK_ERROR) {
+            errors << "Scanner Error: " << token.text() << " at line " << token.line << endl;
+            errorCount++;
+        }
+    }
+
+    if (errorCount > 0) {
+        errors << "Scanning failed with " << errorCount << " errors." << endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// 2. SCANNING AND PARSING
+// =============================================================================
+
+Compilation::Compilation(const string& path, bool lazy, ostream& errors, ostream& log, ModuleFinder findModule)
+    : path(path), lazy(lazy), errors(errors), log(log), findModule(move(findModule)) {
+    // The main file counts as supplied already, under its own name
+    string name = path.substr(directoryOf(path).size());
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tac") == 0) name.resize(name.size() - 4);
+    loaded.insert(Interner::current().intern(name));
+}
+
+bool Compilation::scan(const string& source) {
+    Scanner scanner(source);
+    tokens = scanner.scanTokens();
+    tokenCount = tokens.size();
+    return checkTokens(tokens, errors);
+}
+
+bool Compilation::parse() {
+    parsers.push_back(unique_ptr<Parser>(new Parser(move(tokens), errors, lazy)));
+    return parseFile(*parsers.back());
+}
+
+bool Compilation::parseFile(Parser& parser) {
+    if (!parser.parse()) return false;
+    if (lazy) {
+        log << "Skim complete. " << parser.getProgram().functions.size()
+            << " tactic signatures found; bodies are parsed on demand." << endl;
+    } else {
+        log << "Parsing complete. Syntax is valid." << endl;
+    }
+    return true;
+}
+
+// =============================================================================
+// 3. SUPPLIED MODULES
+// =============================================================================
+
+bool Compilation::supply() {
+    return supplyModules(0, path);
+}
+
+// Loads every '#supply Name' of one file through findModule. Modules load
+// depth first and once each, so a module's declarations land ahead of its
+// supplier's and its globals initialize first. A missing module is only a
+// warning: nothing in a file may depend on one being present.
+bool Compilation::supplyModules(int module, const string& supplier) {
+    bool ok = true;
+    vector<Symbol> supplies = parsers[module]->getProgram().supplies;
+    for (Symbol name : supplies) {
+        if (!loaded.insert(name).second) continue;
+        string modulePath;
+        string source;
+        if (!findModule(Interner::current().name(name), supplier, modulePath, source)) {
+            errors << "Warning: Supplied module '" << Interner::current().name(name)
+                   << "' not found at '" << modulePath << "'; skipping it." << endl;
+            continue;
+        }
+
+        log << "Supplying " << Interner::current().name(name) << " from " << modulePath << endl;
+        Scanner scanner(source);
+        vector<Token> scanned = scanner.scanTokens();
+        moduleBytes += source.size();
+        moduleTokens += scanned.size();
+        if (!checkTokens(scanned, errors)) {
+            ok = false;
+            continue;
+        }
+
+        parsers.push_back(unique_ptr<Parser>(new Parser(move(scanned), errors, lazy)));
+        int index = (int)parsers.size() - 1;
+        if (!parseFile(*parsers[index])) {
+            ok = false;
+            continue;
+        }
+        if (!supplyModules(index, modulePath)) ok = false;
+    }
+    append(module);
+    return ok;
+}
+
+// Moves one file's declarations to the end of the combined program.
+// Each tactic keeps the index of the parser that can parse its body.
+void Compilation::append(int module) {
+    Program& own = parsers[module]->getProgram();
+    program.supplies.insert(program.supplies.end(), own.supplies.begin(), own.supplies.end());
+    for (unique_ptr<Stmt>& global : own.globals) program.globals.push_back(move(global));
+    for (Function& function : own.functions) {
+        function.module = module;
+        program.functions.push_back(move(function));
+    }
+    own.globals.clear();
+    own.functions.clear();
+}
+
+// =============================================================================
+// 4. RESOLUTION AND LINKING
+// =============================================================================
+
+bool Compilation::resolve() {
+    Resolver resolver(program, errors);
+    return lazy ? materialize(resolver) : resolver.resolve();
+}
+
+// Parses and resolves only the tactic bodies reachable from 'campaign' and
+// the global initializers, starting from a skimmed program.
+bool Compilation::materialize(Resolver& resolver) {
+    bool ok = resolver.declare();
+    vector<int> pending(resolver.getCalls());
+    if (program.campaign >= 0) pending.push_back(program.campaign);
+
+    vector<bool> visited(program.functions.size(), false);
+    int parsedCount = 0;
+    while (!pending.empty()) {
+        int index = pending.back();
+        pending.pop_back();
+        if (visited[index]) continue;
+        visited[index] = true;
+
+        Function& function = program.functions[index];
+        if (!parsers[function.module]->parseBody(function)) {
+            ok = false;
+            continue;
+        }
+        parsedCount++;
+        if (!resolver.resolveFunction(function)) ok = false;
+        pending.insert(pending.end(), resolver.getCalls().begin(), resolver.getCalls().end());
+    }
+    if (!resolver.checkParallelCalls()) ok = false;
+
+    log << "Parsed " << parsedCount << " of " << program.functions.size()
+        << " tactic bodies (reachable from campaign)." << endl;
+    return ok;
+}
+
+LinkStats Compilation::link(const LinkOptions& options) {
+    return linkProgram(program, options);
+}
@@ -0,0 +1,85 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "parser.h"
+#include "resolver.h"
+#include "linker.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. SOURCE FILES
+// =============================================================================
+
+// The whole file, or "" after reporting to cerr that it cannot be opened
+string readFile(const string& filepath);
+
+// Where a '#supply Name' comes from. Given the module name and the path of
+// the file that supplies it, always fills in the module's path (for
+// messages, and for the modules it supplies in turn) and, if the module
+// exists, its source. Returns false if it does not.
+typedef function<bool(const string& name, const string& supplier, string& path, string& source)> ModuleFinder;
+
+// Name.tac in the supplying file's directory
+bool findModuleFile(const string& name, const string& supplier, string& path, string& source);
+
+// No module at all, so every '#supply' is reported missing. The library's
+// default: an embedded compile reads no file the host did not hand it.
+bool findNoModule(const string& name, const string& supplier, string& path, string& source);
+
+// =============================================================================
+// 2. COMPILATION CLASS DECLARATION
+// =============================================================================
+
+// Takes one main file and the modules it supplies through the front end
+// to a single resolved, linked Program. The steps run in this order, and
+// each returns false once it has written its errors to 'errors'; nothing
+// may run after a step fails. Progress notes go to 'log'.
+// The command line times each step as a phase of its own.
+class Compilation {
+private:
+    string path;
+    bool lazy;
+    ostream& errors;
+    ostream& log;
+    ModuleFinder findModule;
+
+    vector<Token> tokens;
+    size_t tokenCount = 0;
+    vector<unique_ptr<Parser>> parsers;   // One per file; a tactic's 'module' indexes it
+    unordered_set<Symbol> loaded;
+
+    bool parseFile(Parser& parser);
+    bool supplyModules(int module, const string& supplier);
+    void append(int module);
+    bool materialize(Resolver& resolver);
+
+public:
+    Program program;            // Complete once link() has run
+    size_t moduleBytes = 0;     // Source read for supplied modules
+    size_t moduleTokens = 0;
+
+    // With 'lazy' set, parse() only skims tactic bodies, and resolve()
+    // parses just the ones reachable from 'campaign' and the globals. A
+    // body never reached is only checked for matching braces, so a syntax
+    // error inside it goes unreported.
+    Compilation(const string& path, bool lazy, ostream& errors, ostream& log,
+                ModuleFinder findModule = findModuleFile);
+
+    bool scan(const string& source);
+    bool parse();
+    bool supply();
+    bool resolve();
+    LinkStats link(const LinkOptions& options);
+
+    size_t getTokenCount() const { return tokenCount; }
+    size_t getFileCount() const { return parsers.size(); }
+};
+
+#endif // COMPILER_H
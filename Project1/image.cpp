@@ -0,0 +1,777 @@
+#include "image.h"
+#include "squad.h"
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char IMAGE_MAGIC[8] = { 'T', 'L', 'I', 'M', 'A', 'G', 'E', '\0' };
+static const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+// The flags after a node's kind in the CODE section: which fields and
+// children follow. A field left at its default (no name, slot -1, ...) is
+// not written. The common ones come first, so most flags fit in one byte.
+enum NodeFlag {
+    FLAG_NAME        = 1 << 3,    // Expr, Stmt
+    FLAG_SLOT        = 1 << 4,
+    FLAG_GLOBAL      = 1 << 5,
+
+    FLAG_LEFT        = 1 << 0,    // Expr
+    FLAG_RIGHT       = 1 << 1,
+    FLAG_OP          = 1 << 2,
+    FLAG_LITERAL     = 1 << 6,
+    FLAG_ARGS        = 1 << 7,
+    FLAG_FUNCTION    = 1 << 8,
+    FLAG_PARAM_TYPES = 1 << 9,
+
+    FLAG_EXPR        = 1 << 0,    // Stmt
+    FLAG_BODY        = 1 << 1,
+    FLAG_STATEMENTS  = 1 << 2,
+    FLAG_TYPE        = 1 << 6,
+    FLAG_ELSE        = 1 << 7,
+    FLAG_INIT        = 1 << 8,
+    FLAG_UPDATE      = 1 << 9,
+    FLAG_TAIL_CALL   = 1 << 10,
+    FLAG_PARALLEL    = 1 << 11,
+    FLAG_REDUCTIONS  = 1 << 12
+};
+
+// =============================================================================
+// 1. CHECKSUM AND MAPPING
+// =============================================================================
+
+// FNV-1a, as the Interner hashes names
+static uint64_t checksum(const unsigned char* data, size_t size) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// A whole file mapped read-only for as long as the object lives
+class MappedFile {
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+public:
+    explicit MappedFile(const string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile(const string& path) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) throw ImageError("Could not open image '" + path + "'.");
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        throw ImageError("Image '" + path + "' is empty or unreadable.");
+    }
+    length = (size_t)fileSize.QuadPart;
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL) bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (bytes == nullptr) {
+        if (mapping != NULL) CloseHandle(mapping);
+        CloseHandle(file);
+        throw ImageError("Could not map image '" + path + "'.");
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(bytes);
+    CloseHandle(mapping);
+    CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw ImageError("Could not open image '" + path + "'.");
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw ImageError("Image '" + path + "' is empty or unreadable.");
+    }
+    length = (size_t)info.st_size;
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // The mapping keeps the file open
+    if (address == MAP_FAILED) throw ImageError("Could not map image '" + path + "'.");
+    bytes = (const unsigned char*)address;
+}
+
+MappedFile::~MappedFile() {
+    munmap((void*)bytes, length);
+}
+#endif
+
+// LEB128: seven bits a byte, low bits first, the top bit set on all but
+// the last byte
+static void putVarint(vector<unsigned char>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+// False if the number runs past 'end' or past 32 bits
+static bool getVarint(const unsigned char* bytes, size_t end, size_t& at, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (at >= end) return false;
+        unsigned char byte = bytes[at++];
+        if (shift == 28 && byte > 0x0F) return false;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// 2. WRITER
+// =============================================================================
+
+// Flattens a program into sections. Nodes are written depth first, tactic
+// bodies in function-table order and then the globals, and the reader
+// depends on that order to match nodes with the line table.
+class ImageWriter {
+private:
+    vector<string> strings;
+    unordered_map<string, uint32_t> stringIndex;
+    vector<ConstantRecord> constants;
+    map<tuple<uint32_t, uint32_t, uint64_t>, uint32_t> constantIndex;
+    vector<FunctionRecord> functions;
+    vector<uint32_t> params;     // (type, name) pairs
+    vector<uint32_t> globals;
+    vector<uint32_t> supplies;
+    vector<unsigned char> code;
+    vector<unsigned char> lines; // (node delta, line delta) pairs
+    uint32_t nodes = 0;
+    uint32_t lastLineNode = 0;
+    int lastLine = 0;
+
+    uint32_t text(const string& value);
+    uint32_t symbol(Symbol name);
+    uint32_t constant(const Value& value);
+    void node(int line);
+    void writeExpr(const Expr& expr);
+    void writeStmt(const Stmt& stmt);
+
+public:
+    vector<unsigned char> write(const Program& program);
+};
+
+uint32_t ImageWriter::text(const string& value) {
+    unordered_map<string, uint32_t>::const_iterator found = stringIndex.find(value);
+    if (found != stringIndex.end()) return found->second;
+    uint32_t index = (uint32_t)strings.size();
+    strings.push_back(value);
+    stringIndex[value] = index;
+    return index;
+}
+
+uint32_t ImageWriter::symbol(Symbol name) {
+    return name == NO_SYMBOL ? IMAGE_NONE : text(Interner::current().name(name));
+}
+
+uint32_t ImageWriter::constant(const Value& value) {
+    ConstantRecord record = { (uint32_t)value.type, IMAGE_NONE, 0 };
+    switch (value.type) {
+        case VAL_TROOP:    record.bits = (uint32_t)value.troop; break;
+        case VAL_AMMO:     memcpy(&record.bits, &value.ammo, sizeof value.ammo); break;
+        case VAL_STATUS:   record.bits = value.status ? 1 : 0; break;
+        case VAL_CODENAME: record.text = text(value.codename()); break;
+        default:
+            throw ImageError("A " + valueTypeName(value.type) + " constant cannot be stored in an image.");
+    }
+    tuple<uint32_t, uint32_t, uint64_t> key(record.type, record.text, record.bits);
+    map<tuple<uint32_t, uint32_t, uint64_t>, uint32_t>::const_iterator found = constantIndex.find(key);
+    if (found != constantIndex.end()) return found->second;
+    constants.push_back(record);
+    constantIndex[key] = (uint32_t)constants.size() - 1;
+    return (uint32_t)constants.size() - 1;
+}
+
+// A line table entry wherever the line changes: how many nodes since the
+// last entry, and the change in line, zigzag-encoded
+void ImageWriter::node(int line) {
+    if (nodes == 0 || line != lastLine) {
+        uint32_t delta = (uint32_t)line - (uint32_t)lastLine;
+        putVarint(lines, nodes - lastLineNode);
+        putVarint(lines, (delta << 1) ^ (uint32_t)((int32_t)delta >> 31));
+        lastLineNode = nodes;
+        lastLine = line;
+    }
+    nodes++;
+}
+
+// kind flags, then those of op name slot function literal argCount
+// (paramTypeCount paramTypes...) that the flags name; then left, right
+// and args
+void ImageWriter::writeExpr(const Expr& expr) {
+    node(expr.line);
+    uint32_t flags = (expr.left ? FLAG_LEFT : 0) | (expr.right ? FLAG_RIGHT : 0) |
+                     (expr.op != TOK_ERROR ? FLAG_OP : 0) | (expr.name != NO_SYMBOL ? FLAG_NAME : 0) |
+                     (expr.slot != -1 ? FLAG_SLOT : 0) | (expr.global ? FLAG_GLOBAL : 0) |
+                     (expr.kind == EXPR_LITERAL ? FLAG_LITERAL : 0) | (expr.args.empty() ? 0 : FLAG_ARGS) |
+                     (expr.function != -1 ? FLAG_FUNCTION : 0) | (expr.paramTypes.empty() ? 0 : FLAG_PARAM_TYPES);
+    putVarint(code, expr.kind);
+    putVarint(code, flags);
+    if (flags & FLAG_OP) putVarint(code, expr.op);
+    if (flags & FLAG_NAME) putVarint(code, symbol(expr.name));
+    if (flags & FLAG_SLOT) putVarint(code, (uint32_t)expr.slot);
+    if (flags & FLAG_FUNCTION) putVarint(code, (uint32_t)expr.function);
+    if (flags & FLAG_LITERAL) putVarint(code, constant(expr.literal));
+    if (flags & FLAG_ARGS) putVarint(code, (uint32_t)expr.args.size());
+    if (flags & FLAG_PARAM_TYPES) {
+        putVarint(code, (uint32_t)expr.paramTypes.size());
+        for (ValueType type : expr.paramTypes) putVarint(code, type);
+    }
+    if (expr.left) writeExpr(*expr.left);
+    if (expr.right) writeExpr(*expr.right);
+    for (const unique_ptr<Expr>& arg : expr.args) writeExpr(*arg);
+}
+
+// kind flags, then those of varType name slot statementCount
+// (reductionCount (slot type op accumulatorFirst)...) that the flags
+// name; then expr, init, update, body, elseBranch and statements
+void ImageWriter::writeStmt(const Stmt& stmt) {
+    node(stmt.line);
+    uint32_t flags = (stmt.expr ? FLAG_EXPR : 0) | (stmt.body ? FLAG_BODY : 0) |
+                     (stmt.statements.empty() ? 0 : FLAG_STATEMENTS) | (stmt.name != NO_SYMBOL ? FLAG_NAME : 0) |
+                     (stmt.slot != -1 ? FLAG_SLOT : 0) | (stmt.global ? FLAG_GLOBAL : 0) |
+                     (stmt.varType != VAL_NONE ? FLAG_TYPE : 0) | (stmt.elseBranch ? FLAG_ELSE : 0) |
+                     (stmt.init ? FLAG_INIT : 0) | (stmt.update ? FLAG_UPDATE : 0) |
+                     (stmt.tailCall ? FLAG_TAIL_CALL : 0) | (stmt.parallel ? FLAG_PARALLEL : 0) |
+                     (stmt.reductions.empty() ? 0 : FLAG_REDUCTIONS);
+    putVarint(code, stmt.kind);
+    putVarint(code, flags);
+    if (flags & FLAG_TYPE) putVarint(code, stmt.varType);
+    if (flags & FLAG_NAME) putVarint(code, symbol(stmt.name));
+    if (flags & FLAG_SLOT) putVarint(code, (uint32_t)stmt.slot);
+    if (flags & FLAG_STATEMENTS) putVarint(code, (uint32_t)stmt.statements.size());
+    if (flags & FLAG_REDUCTIONS) {
+        putVarint(code, (uint32_t)stmt.reductions.size());
+        for (const Reduction& reduction : stmt.reductions) {
+            putVarint(code, (uint32_t)reduction.slot);
+            putVarint(code, reduction.type);
+            putVarint(code, reduction.op);
+            putVarint(code, reduction.accumulatorFirst ? 1 : 0);
+        }
+    }
+    if (stmt.expr) writeExpr(*stmt.expr);
+    if (stmt.init) writeStmt(*stmt.init);
+    if (stmt.update) writeExpr(*stmt.update);
+    if (stmt.body) writeStmt(*stmt.body);
+    if (stmt.elseBranch) writeStmt(*stmt.elseBranch);
+    for (const unique_ptr<Stmt>& inner : stmt.statements) writeStmt(*inner);
+}
+
+// Appends one section at the next 8-byte boundary
+static void appendSection(vector<unsigned char>& file, ImageHeader& header, ImageSection which,
+                          const void* data, size_t bytes, size_t count) {
+    file.resize((file.size() + 7) & ~(size_t)7, 0);
+    header.sections[which].offset = (uint32_t)file.size();
+    header.sections[which].count = (uint32_t)count;
+    const unsigned char* first = (const unsigned char*)data;
+    file.insert(file.end(), first, first + bytes);
+}
+
+template <class T>
+static void appendSection(vector<unsigned char>& file, ImageHeader& header, ImageSection which,
+                          const vector<T>& items, size_t count) {
+    appendSection(file, header, which, items.data(), items.size() * sizeof(T), count);
+}
+
+vector<unsigned char> ImageWriter::write(const Program& program) {
+    for (const Function& function : program.functions) {
+        FunctionRecord record = { symbol(function.name), function.line, function.frameSize, function.module,
+                                  (uint32_t)params.size() / 2, (uint32_t)function.params.size(),
+                                  function.body ? (uint32_t)code.size() : IMAGE_NONE };
+        for (const Param& param : function.params) {
+            params.push_back(param.type);
+            params.push_back(symbol(param.name));
+        }
+        functions.push_back(record);
+        if (function.body) writeStmt(*function.body);
+    }
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        globals.push_back((uint32_t)code.size());
+        writeStmt(*global);
+    }
+    for (Symbol supply : program.supplies) supplies.push_back(symbol(supply));
+
+    // STRINGS: (offset, length) from the section start, then the text
+    vector<unsigned char> stringData(strings.size() * 2 * sizeof(uint32_t));
+    for (size_t i = 0; i < strings.size(); i++) {
+        uint32_t entry[2] = { (uint32_t)stringData.size(), (uint32_t)strings[i].size() };
+        memcpy(&stringData[i * sizeof entry], entry, sizeof entry);
+        stringData.insert(stringData.end(), strings[i].begin(), strings[i].end());
+    }
+
+    ImageHeader header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, IMAGE_MAGIC, sizeof header.magic);
+    header.version = IMAGE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.campaign = program.campaign;
+
+    vector<unsigned char> file(sizeof header);
+    appendSection(file, header, IMAGE_STRINGS, stringData, strings.size());
+    appendSection(file, header, IMAGE_CONSTANTS, constants, constants.size());
+    appendSection(file, header, IMAGE_FUNCTIONS, functions, functions.size());
+    appendSection(file, header, IMAGE_PARAMS, params, params.size() / 2);
+    appendSection(file, header, IMAGE_GLOBALS, globals, globals.size());
+    appendSection(file, header, IMAGE_SUPPLIES, supplies, supplies.size());
+    appendSection(file, header, IMAGE_CODE, code, code.size());
+    appendSection(file, header, IMAGE_LINES, lines, lines.size());
+    if (file.size() > UINT32_MAX) throw ImageError("Program is too large for an image.");
+
+    header.size = file.size();
+    header.checksum = checksum(file.data() + sizeof header, file.size() - sizeof header);
+    memcpy(file.data(), &header, sizeof header);
+    return file;
+}
+
+// =============================================================================
+// 3. READER
+// =============================================================================
+
+// Rebuilds a Program from mapped image bytes. Every index read from the
+// image is range-checked before use, since the Interpreter trusts slots,
+// tactic indices and child links without checking them again.
+class ImageReader {
+private:
+    const unsigned char* data;
+    size_t size;
+    ImageHeader header;
+
+    vector<Symbol> symbols;      // String index -> interned name
+    vector<Value> constants;
+    const unsigned char* code = nullptr;
+    size_t codeSize = 0;
+    const unsigned char* lines = nullptr;
+    size_t linesSize = 0;
+    size_t lineAt = 0;
+    bool lineChange = false;     // Whether the next entry has been read
+    uint32_t changeNode = 0;     // The node it starts on, and its line
+    uint32_t changeLine = 0;
+    uint32_t node = 0;
+    int line = 0;
+
+    // What the code being read may refer to
+    const Program* program = nullptr;
+    int frameSize = 0;           // Slots of the tactic being read; 0 in globals
+    size_t globalCount = 0;
+
+    [[noreturn]] static void malformed(const string& what);
+    const unsigned char* section(ImageSection which, size_t elementSize) const;
+    uint32_t word(size_t& at) const;
+    uint32_t count(size_t& at) const;
+    void readLineChange();
+    int nodeLine();
+    Symbol name(uint32_t index) const;
+    ValueType valueType(uint32_t type, bool allowNone) const;
+    void checkSlot(int slot, bool global, const char* what) const;
+    unique_ptr<Expr> readExpr(size_t& at);
+    unique_ptr<Stmt> readStmt(size_t& at);
+    void checkExpr(Expr& expr, uint32_t literal) const;
+    void checkStmt(const Stmt& stmt) const;
+
+public:
+    ImageReader(const unsigned char* data, size_t size, const string& path);
+    void read(Program& program);
+};
+
+void ImageReader::malformed(const string& what) {
+    throw ImageError("Image is malformed: " + what + ".");
+}
+
+ImageReader::ImageReader(const unsigned char* data, size_t size, const string& path) : data(data), size(size) {
+    if (size < sizeof header || memcmp(data, IMAGE_MAGIC, sizeof IMAGE_MAGIC) != 0) {
+        throw ImageError("'" + path + "' is not a TacticLang image.");
+    }
+    memcpy(&header, data, sizeof header);
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        throw ImageError("Image was written with a different byte order; recompile it on this machine.");
+    }
+    if (header.version != IMAGE_VERSION) {
+        throw ImageError("Image version " + to_string(header.version) + " is not supported (this build reads version " +
+                         to_string(IMAGE_VERSION) + "); recompile the source with --emit-image.");
+    }
+    if (header.size != size) {
+        throw ImageError("Image is truncated or padded: " + to_string(size) + " bytes, expected " +
+                         to_string(header.size) + ".");
+    }
+    if (checksum(data + sizeof header, size - sizeof header) != header.checksum) {
+        throw ImageError("Image checksum does not match; the file is corrupt.");
+    }
+}
+
+const unsigned char* ImageReader::section(ImageSection which, size_t elementSize) const {
+    const ImageSectionEntry& entry = header.sections[which];
+    if (entry.offset % 8 != 0 || entry.offset > size || entry.count > (size - entry.offset) / elementSize) {
+        malformed("section " + to_string(which) + " lies outside the file");
+    }
+    return data + entry.offset;
+}
+
+uint32_t ImageReader::word(size_t& at) const {
+    uint32_t value;
+    if (!getVarint(code, codeSize, at, value)) malformed("code ends inside a node");
+    return value;
+}
+
+// A number of children or fields to follow. Each takes at least a byte,
+// so a count larger than the code left is refused before anything is
+// reserved for it.
+uint32_t ImageReader::count(size_t& at) const {
+    uint32_t value = word(at);
+    if (value > codeSize - at) malformed("a node counts more parts than the code holds");
+    return value;
+}
+
+void ImageReader::readLineChange() {
+    lineChange = lineAt < linesSize;
+    if (!lineChange) return;
+    uint32_t nodeDelta, lineDelta;
+    if (!getVarint(lines, linesSize, lineAt, nodeDelta) || !getVarint(lines, linesSize, lineAt, lineDelta)) {
+        malformed("the line table ends inside an entry");
+    }
+    changeNode += nodeDelta;
+    changeLine += (lineDelta >> 1) ^ (0u - (lineDelta & 1));
+}
+
+// Nodes are numbered in the order they are read
+int ImageReader::nodeLine() {
+    while (lineChange && changeNode <= node) {
+        line = (int)changeLine;
+        readLineChange();
+    }
+    node++;
+    return line;
+}
+
+Symbol ImageReader::name(uint32_t index) const {
+    if (index == IMAGE_NONE) return NO_SYMBOL;
+    if (index >= symbols.size()) malformed("string " + to_string(index) + " does not exist");
+    return symbols[index];
+}
+
+ValueType ImageReader::valueType(uint32_t type, bool allowNone) const {
+    if (type > VAL_NONE || (type == VAL_NONE && !allowNone)) malformed("unknown type " + to_string(type));
+    return (ValueType)type;
+}
+
+void ImageReader::checkSlot(int slot, bool global, const char* what) const {
+    int limit = global ? (int)globalCount : frameSize;
+    if (slot < 0 || slot >= limit) malformed(string(what) + " uses slot " + to_string(slot) + " of " + to_string(limit));
+}
+
+unique_ptr<Expr> ImageReader::readExpr(size_t& at) {
+    int exprLine = nodeLine();
+    uint32_t kind = word(at);
+    if (kind > EXPR_BUILTIN) malformed("unknown expression kind " + to_string(kind));
+    unique_ptr<Expr> expr(new Expr((ExprKind)kind, exprLine));
+    uint32_t flags = word(at);
+    if (flags & FLAG_OP) {
+        uint32_t op = word(at);
+        if (op > TOK_ERROR) malformed("unknown operator " + to_string(op));
+        expr->op = (TokenType)op;
+    }
+    if (flags & FLAG_NAME) expr->name = name(word(at));
+    if (flags & FLAG_SLOT) expr->slot = (int)word(at);
+    if (flags & FLAG_FUNCTION) expr->function = (int)word(at);
+    uint32_t literal = (flags & FLAG_LITERAL) ? word(at) : IMAGE_NONE;
+    uint32_t argCount = (flags & FLAG_ARGS) ? count(at) : 0;
+    expr->global = (flags & FLAG_GLOBAL) != 0;
+    if (flags & FLAG_PARAM_TYPES) {
+        uint32_t paramTypeCount = count(at);
+        expr->paramTypes.reserve(paramTypeCount);
+        for (uint32_t i = 0; i < paramTypeCount; i++) expr->paramTypes.push_back(valueType(word(at), false));
+    }
+    if (flags & FLAG_LEFT) expr->left = readExpr(at);
+    if (flags & FLAG_RIGHT) expr->right = readExpr(at);
+    expr->args.reserve(argCount);
+    for (uint32_t i = 0; i < argCount; i++) expr->args.push_back(readExpr(at));
+    checkExpr(*expr, literal);
+    return expr;
+}
+
+void ImageReader::checkExpr(Expr& expr, uint32_t literal) const {
+    bool needsLeft = false;
+    bool needsRight = false;
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            if (literal >= constants.size()) malformed("a literal names no constant");
+            expr.literal = constants[literal];
+            break;
+        case EXPR_VARIABLE:
+            checkSlot(expr.slot, expr.global, "a variable");
+            break;
+        case EXPR_ASSIGN:
+            checkSlot(expr.slot, expr.global, "an assignment");
+            needsRight = true;
+            break;
+        case EXPR_SET_INDEX:
+            checkSlot(expr.slot, expr.global, "an element assignment");
+            needsLeft = needsRight = true;
+            break;
+        case EXPR_CALL:
+            if (expr.function < 0 || expr.function >= (int)program->functions.size() ||
+                expr.args.size() != program->functions[expr.function].params.size()) {
+                malformed("a call does not match the function table");
+            }
+            break;
+        case EXPR_BUILTIN:
+            if (expr.function < BUILTIN_SIZE || expr.function > BUILTIN_RANGE ||
+                expr.args.size() != builtinArity((Builtin)expr.function)) {
+                malformed("a built-in call is out of range");
+            }
+            break;
+        case EXPR_INLINE:
+            if (expr.paramTypes.size() != expr.args.size() || expr.slot < 0 ||
+                expr.slot + (long long)expr.args.size() > frameSize) {
+                malformed("an inlined call does not fit its frame");
+            }
+            needsLeft = true;
+            break;
+        case EXPR_UNARY:
+            needsLeft = true;
+            break;
+        case EXPR_BINARY:
+        case EXPR_INDEX:
+            needsLeft = needsRight = true;
+            break;
+        case EXPR_SQUAD:
+            break;
+    }
+    if ((needsLeft && !expr.left) || (needsRight && !expr.right)) malformed("an expression is missing an operand");
+}
+
+unique_ptr<Stmt> ImageReader::readStmt(size_t& at) {
+    int stmtLine = nodeLine();
+    uint32_t kind = word(at);
+    if (kind > STMT_EXPR) malformed("unknown statement kind " + to_string(kind));
+    unique_ptr<Stmt> stmt(new Stmt((StmtKind)kind, stmtLine));
+    uint32_t flags = word(at);
+    if (flags & FLAG_TYPE) stmt->varType = valueType(word(at), true);
+    if (flags & FLAG_NAME) stmt->name = name(word(at));
+    if (flags & FLAG_SLOT) stmt->slot = (int)word(at);
+    uint32_t statementCount = (flags & FLAG_STATEMENTS) ? count(at) : 0;
+    uint32_t reductionCount = (flags & FLAG_REDUCTIONS) ? count(at) : 0;
+    stmt->global = (flags & FLAG_GLOBAL) != 0;
+    stmt->tailCall = (flags & FLAG_TAIL_CALL) != 0;
+    stmt->parallel = (flags & FLAG_PARALLEL) != 0;
+    for (uint32_t i = 0; i < reductionCount; i++) {
+        Reduction reduction;
+        reduction.slot = (int)word(at);
+        reduction.type = valueType(word(at), false);
+        reduction.op = (TokenType)word(at);
+        reduction.accumulatorFirst = word(at) != 0;
+        checkSlot(reduction.slot, false, "a reduction");
+        if (reduction.op != TOK_PLUS && reduction.op != TOK_MULTIPLY && reduction.op != TOK_AND && reduction.op != TOK_OR) {
+            malformed("a reduction has operator " + to_string(reduction.op));
+        }
+        stmt->reductions.push_back(reduction);
+    }
+    if (flags & FLAG_EXPR) stmt->expr = readExpr(at);
+    if (flags & FLAG_INIT) stmt->init = readStmt(at);
+    if (flags & FLAG_UPDATE) stmt->update = readExpr(at);
+    if (flags & FLAG_BODY) stmt->body = readStmt(at);
+    if (flags & FLAG_ELSE) stmt->elseBranch = readStmt(at);
+    stmt->statements.reserve(statementCount);
+    for (uint32_t i = 0; i < statementCount; i++) stmt->statements.push_back(readStmt(at));
+    checkStmt(*stmt);
+    return stmt;
+}
+
+// The loop shape Interpreter::parallelFor relies on, as the Resolver checks it
+static bool countingShape(const Stmt& stmt) {
+    const Expr* update = stmt.update.get();
+    return stmt.init && stmt.init->kind == STMT_VAR && stmt.init->expr && stmt.expr && stmt.expr->kind == EXPR_BINARY &&
+           (stmt.expr->op == TOK_LESS || stmt.expr->op == TOK_LESS_EQUAL) &&
+           update && update->kind == EXPR_ASSIGN && update->right->kind == EXPR_BINARY &&
+           update->right->right->kind == EXPR_LITERAL && update->right->right->literal.type == VAL_TROOP &&
+           update->right->right->literal.troop > 0;
+}
+
+void ImageReader::checkStmt(const Stmt& stmt) const {
+    bool ok = true;
+    switch (stmt.kind) {
+        case STMT_VAR:
+        case STMT_INTEL:
+            if (stmt.varType == VAL_NONE) malformed("a declaration has no type");
+            checkSlot(stmt.slot, stmt.global, "a declaration");
+            break;
+        case STMT_IF:
+        case STMT_WHILE:
+            ok = stmt.expr && stmt.body;
+            break;
+        case STMT_FOR:
+            ok = stmt.body && (!stmt.parallel || countingShape(stmt));
+            break;
+        case STMT_RETREAT:
+            ok = !stmt.tailCall || (stmt.expr && stmt.expr->kind == EXPR_CALL);
+            break;
+        case STMT_BRIEF:
+        case STMT_EXPR:
+            ok = stmt.expr != nullptr;
+            break;
+        default:
+            break;
+    }
+    if (!ok) malformed("a statement is missing a part");
+}
+
+void ImageReader::read(Program& out) {
+    program = &out;
+    globalCount = header.sections[IMAGE_GLOBALS].count;
+
+    // --- Strings and constants ---
+    const unsigned char* strings = section(IMAGE_STRINGS, 2 * sizeof(uint32_t));
+    const uint32_t* stringTable = (const uint32_t*)strings;
+    size_t stringSpace = size - header.sections[IMAGE_STRINGS].offset;
+    symbols.reserve(header.sections[IMAGE_STRINGS].count);
+    for (uint32_t i = 0; i < header.sections[IMAGE_STRINGS].count; i++) {
+        uint32_t offset = stringTable[2 * i];
+        uint32_t length = stringTable[2 * i + 1];
+        if (offset > stringSpace || length > stringSpace - offset) malformed("string " + to_string(i) + " runs past the file");
+        symbols.push_back(Interner::current().intern((const char*)strings + offset, length));
+    }
+
+    const ConstantRecord* constantTable = (const ConstantRecord*)section(IMAGE_CONSTANTS, sizeof(ConstantRecord));
+    constants.reserve(header.sections[IMAGE_CONSTANTS].count);
+    for (uint32_t i = 0; i < header.sections[IMAGE_CONSTANTS].count; i++) {
+        const ConstantRecord& record = constantTable[i];
+        switch (record.type) {
+            case VAL_TROOP:
+                constants.push_back(Value::makeTroop((int)(uint32_t)record.bits));
+                break;
+            case VAL_AMMO: {
+                double ammo;
+                memcpy(&ammo, &record.bits, sizeof ammo);
+                constants.push_back(Value::makeAmmo(ammo));
+                break;
+            }
+            case VAL_STATUS:
+                constants.push_back(Value::makeStatus(record.bits != 0));
+                break;
+            case VAL_CODENAME:
+                if (record.text == IMAGE_NONE) malformed("a codename constant has no text");
+                constants.push_back(Value::makeCodename(Interner::current().name(name(record.text))));
+                break;
+            default:
+                malformed("constant " + to_string(i) + " has type " + to_string(record.type));
+        }
+    }
+
+    // --- Function table ---
+    const FunctionRecord* functionTable = (const FunctionRecord*)section(IMAGE_FUNCTIONS, sizeof(FunctionRecord));
+    const uint32_t* paramTable = (const uint32_t*)section(IMAGE_PARAMS, 2 * sizeof(uint32_t));
+    uint32_t paramCount = header.sections[IMAGE_PARAMS].count;
+    out.functions.reserve(header.sections[IMAGE_FUNCTIONS].count);
+    for (uint32_t i = 0; i < header.sections[IMAGE_FUNCTIONS].count; i++) {
+        const FunctionRecord& record = functionTable[i];
+        if (record.firstParam > paramCount || record.paramCount > paramCount - record.firstParam ||
+            record.frameSize < (int32_t)record.paramCount) {
+            malformed("tactic " + to_string(i) + " has a bad parameter list");
+        }
+        Function function;
+        function.name = name(record.name);
+        function.line = record.line;
+        function.frameSize = record.frameSize;
+        function.module = record.module;
+        function.resolved = true;
+        for (uint32_t p = 0; p < record.paramCount; p++) {
+            Param param;
+            param.type = valueType(paramTable[2 * (record.firstParam + p)], false);
+            param.name = name(paramTable[2 * (record.firstParam + p) + 1]);
+            function.params.push_back(param);
+        }
+        out.functions.push_back(move(function));
+    }
+    if (header.campaign < -1 || header.campaign >= (int32_t)out.functions.size()) malformed("campaign is out of range");
+    out.campaign = header.campaign;
+
+    // --- Code ---
+    // Bodies and globals must tile the code section in order, which is
+    // also the order the line table numbers nodes in
+    code = section(IMAGE_CODE, 1);
+    codeSize = header.sections[IMAGE_CODE].count;
+    lines = section(IMAGE_LINES, 1);
+    linesSize = header.sections[IMAGE_LINES].count;
+    readLineChange();
+    size_t at = 0;
+    for (uint32_t i = 0; i < out.functions.size(); i++) {
+        uint32_t body = functionTable[i].body;
+        if (body == IMAGE_NONE) continue;
+        if (body != at) malformed("tactic " + to_string(i) + " does not start where the previous one ended");
+        frameSize = out.functions[i].frameSize;
+        out.functions[i].body = readStmt(at);
+    }
+
+    const uint32_t* globalTable = (const uint32_t*)section(IMAGE_GLOBALS, sizeof(uint32_t));
+    frameSize = 0;
+    for (size_t i = 0; i < globalCount; i++) {
+        if (globalTable[i] != at) malformed("global " + to_string(i) + " is out of order");
+        unique_ptr<Stmt> global = readStmt(at);
+        if (global->kind != STMT_VAR || !global->global) malformed("global " + to_string(i) + " is not a declaration");
+        out.globals.push_back(move(global));
+    }
+    if (at != codeSize) malformed("code continues past the last global");
+
+    const uint32_t* supplyTable = (const uint32_t*)section(IMAGE_SUPPLIES, sizeof(uint32_t));
+    for (uint32_t i = 0; i < header.sections[IMAGE_SUPPLIES].count; i++) out.supplies.push_back(name(supplyTable[i]));
+}
+
+// =============================================================================
+// 4. ENTRY POINTS
+// =============================================================================
+
+bool isImageFile(const string& path) {
+    ifstream file(path, ios::binary);
+    char magic[sizeof IMAGE_MAGIC];
+    return file.read(magic, sizeof magic) && memcmp(magic, IMAGE_MAGIC, sizeof magic) == 0;
+}
+
+size_t writeImage(const Program& program, const string& path) {
+    InternerScope scope(program.names.get());
+    ImageWriter writer;
+    vector<unsigned char> image = writer.write(program);
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) throw ImageError("Could not write image '" + path + "'.");
+    file.write((const char*)image.data(), (streamsize)image.size());
+    if (!file) throw ImageError("Could not write image '" + path + "'.");
+    return image.size();
+}
+
+void loadImage(const string& path, Program& program) {
+    MappedFile file(path);
+    ImageReader reader(file.data(), file.size(), path);
+    reader.read(program);
+}
@@ -0,0 +1,114 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. IMAGE FORMAT
+// =============================================================================
+
+// A compiled program image (.tlimg) holds a program after parsing,
+// resolution and linking have all succeeded. Running one needs no source,
+// and none of those phases run again.
+//
+// The file is an ImageHeader followed by these sections, each aligned to
+// 8 bytes:
+//   STRINGS    names and codename text: (offset, length) pairs, then bytes
+//   CONSTANTS  literal values, one ConstantRecord each
+//   FUNCTIONS  the function table, one FunctionRecord per tactic
+//   PARAMS     (type, name) pairs that FunctionRecords point into
+//   GLOBALS    code offset of each global declaration, in order
+//   SUPPLIES   string index of each '#supply' name
+//   CODE       statement and expression nodes in pre-order, as LEB128
+//              varints: kind, a flag word, then only the fields the flags
+//              name (see NodeFlag in image.cpp)
+//   LINES      varint (node delta, zigzag line delta) pairs, one wherever
+//              the source line changes
+// Sections refer to each other by index or offset, never by address, so
+// the file can be mapped anywhere. Integers in the fixed-size sections are
+// in the writer's byte order, which the header records.
+//
+// An image is about the size of its source: 6.6 KB for the 6.8 KB
+// soldier.tac, 2.1 MB for a 2.5 MB generated program.
+const uint32_t IMAGE_VERSION = 2;
+
+enum ImageSection {
+    IMAGE_STRINGS,
+    IMAGE_CONSTANTS,
+    IMAGE_FUNCTIONS,
+    IMAGE_PARAMS,
+    IMAGE_GLOBALS,
+    IMAGE_SUPPLIES,
+    IMAGE_CODE,
+    IMAGE_LINES,
+    IMAGE_SECTION_COUNT
+};
+
+struct ImageSectionEntry {
+    uint32_t offset;    // From the start of the file
+    uint32_t count;     // Elements, not bytes; bytes for CODE and LINES
+};
+
+struct ImageHeader {
+    char magic[8];          // "TLIMAGE" and a NUL
+    uint32_t version;       // IMAGE_VERSION
+    uint32_t byteOrder;     // 0x01020304 as the writer stored it
+    uint64_t checksum;      // FNV-1a of every byte after the header
+    uint64_t size;          // Whole file, header included
+    int32_t campaign;       // Function index, or -1
+    uint32_t reserved;
+    ImageSectionEntry sections[IMAGE_SECTION_COUNT];
+};
+
+struct ConstantRecord {
+    uint32_t type;          // ValueType
+    uint32_t text;          // VAL_CODENAME: string index
+    uint64_t bits;          // troop, ammo or status
+};
+
+struct FunctionRecord {
+    uint32_t name;          // String index
+    int32_t line;
+    int32_t frameSize;
+    int32_t module;
+    uint32_t firstParam;    // Index into PARAMS
+    uint32_t paramCount;
+    uint32_t body;          // CODE byte offset, or IMAGE_NONE for an unparsed body
+};
+
+const uint32_t IMAGE_NONE = 0xFFFFFFFFu;
+
+// A missing, corrupt or incompatible image, or one that cannot be written
+class ImageError : public runtime_error {
+public:
+    explicit ImageError(const string& message) : runtime_error(message) {}
+};
+
+// =============================================================================
+// 2. WRITING AND LOADING
+// =============================================================================
+
+// Whether the file at 'path' starts with the image magic
+bool isImageFile(const string& path);
+
+// Writes a resolved, linked program. Returns the image size in bytes.
+size_t writeImage(const Program& program, const string& path);
+
+// Maps the image read-only, checks its version and checksum, and rebuilds
+// the program from it in one pass. The rebuild validates every index, slot
+// and child link, so a damaged image is refused rather than run. The
+// mapping is released before this returns.
+//
+// The rebuild allocates every node of every linked tactic up front, so a
+// load costs about as many allocations as the program has nodes. It skips
+// scanning, parsing, resolution and linking, but it is not free: the
+// 2.5 MB program that takes 187 ms to compile loads in 73-78 ms, with
+// 408k allocations totalling 43 MB.
+void loadImage(const string& path, Program& program);
+
+#endif // IMAGE_H
@@ -0,0 +1,134 @@
+#include "interner.h"
+#include <cstring>
+#include <stdexcept>
+
+// --- Global Instance ---
+Interner& Interner::global() {
+    static Interner interner;
+    return interner;
+}
+
+static thread_local Interner* currentInterner = nullptr;
+
+Interner& Interner::current() {
+    Interner* interner = currentInterner;
+    return interner ? *interner : global();
+}
+
+InternerScope::InternerScope(Interner* interner) : saved(currentInterner) {
+    if (interner) currentInterner = interner;
+}
+
+InternerScope::~InternerScope() {
+    currentInterner = saved;
+}
+
+Interner::Shard::Shard() : count(0) {
+    for (atomic<string*>& segment : segments) segment.store(nullptr, memory_order_relaxed);
+}
+
+Interner::Shard::~Shard() {
+    for (atomic<string*>& segment : segments) delete[] segment.load(memory_order_relaxed);
+}
+
+// The text slot of 'index', whose segment must already be published
+string* Interner::entry(const Shard& shard, uint32_t index) {
+    uint32_t segmentStart = 0;
+    uint32_t segmentSize = FIRST_SEGMENT;
+    int segment = 0;
+    while (index - segmentStart >= segmentSize) {
+        segmentStart += segmentSize;
+        segmentSize *= 2;
+        segment++;
+    }
+    return shard.segments[segment].load(memory_order_acquire) + (index - segmentStart);
+}
+
+// FNV-1a: cheap and good enough for short identifiers
+uint64_t Interner::hash(const char* text, size_t length) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void Interner::insertSlot(Shard& shard, uint64_t hash, uint32_t index) {
+    size_t mask = shard.slots.size() - 1;
+    size_t slot = (size_t)(hash >> SHARD_BITS) & mask;
+    while (shard.slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    shard.slots[slot] = index + 1;
+}
+
+Symbol Interner::intern(const char* text, size_t length) {
+    uint64_t h = hash(text, length);
+    Shard& shard = shards[h & (SHARD_COUNT - 1)];
+    lock_guard<mutex> guard(shard.lock);
+
+    // Lookup
+    if (!shard.slots.empty()) {
+        size_t mask = shard.slots.size() - 1;
+        size_t slot = (size_t)(h >> SHARD_BITS) & mask;
+        while (shard.slots[slot] != 0) {
+            uint32_t index = shard.slots[slot] - 1;
+            if (shard.hashes[index] == h) {
+                const string& candidate = *entry(shard, index);
+                if (candidate.size() == length && memcmp(candidate.data(), text, length) == 0) {
+                    return (Symbol)(index << SHARD_BITS) | (Symbol)(h & (SHARD_COUNT - 1));
+                }
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    // Insert, keeping the load factor at or below one half
+    uint32_t index = shard.count.load(memory_order_relaxed);
+    if (index >= (NO_SYMBOL >> SHARD_BITS)) {
+        throw runtime_error("Interner is full.");
+    }
+
+    // A new segment starts at the index that doubles the shard's capacity
+    uint32_t segmentStart = 0;
+    uint32_t segmentSize = FIRST_SEGMENT;
+    int segment = 0;
+    while (segmentStart < index) {
+        segmentStart += segmentSize;
+        segmentSize *= 2;
+        segment++;
+    }
+    if (segmentStart == index) {
+        shard.segments[segment].store(new string[segmentSize], memory_order_release);
+    }
+    entry(shard, index)->assign(text, length);
+    shard.hashes.push_back(h);
+    shard.count.store(index + 1, memory_order_release);
+
+    if ((index + 1) * 2 > shard.slots.size()) {
+        size_t slotCount = shard.slots.empty() ? 64 : shard.slots.size() * 2;
+        shard.slots.assign(slotCount, 0);
+        for (uint32_t i = 0; i <= index; i++) {
+            insertSlot(shard, shard.hashes[i], i);
+        }
+    } else {
+        insertSlot(shard, h, index);
+    }
+    return (Symbol)(index << SHARD_BITS) | (Symbol)(h & (SHARD_COUNT - 1));
+}
+
+const string& Interner::name(Symbol symbol) const {
+    const Shard& shard = shards[symbol & (SHARD_COUNT - 1)];
+    uint32_t index = symbol >> SHARD_BITS;
+    if (index >= shard.count.load(memory_order_acquire)) {
+        throw out_of_range("Unknown symbol.");
+    }
+    return *entry(shard, index);
+}
+
+size_t Interner::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) total += shard.count.load(memory_order_acquire);
+    return total;
+}
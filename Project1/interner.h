@@ -0,0 +1,93 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+using namespace std;
+
+// =============================================================================
+// 1. SYMBOLS
+// =============================================================================
+
+// A 32-bit handle for an interned identifier or string literal.
+// Equal text always yields the equal Symbol, so comparisons are integer ones.
+typedef uint32_t Symbol;
+
+const Symbol NO_SYMBOL = 0xFFFFFFFFu;
+
+// =============================================================================
+// 2. INTERNER CLASS DECLARATION
+// =============================================================================
+
+// Thread-safe string interner shared by the scanner, parser and runtime.
+//
+// The table is split into shards by hash, each with its own lock, so threads
+// interning different names rarely contend. A Symbol packs the shard number
+// in its low bits and the index inside the shard in the rest.
+//
+// name() takes no lock. A shard keeps its text in segments that double in
+// size and never move: segment s holds the names from 64 * (2^s - 1) on.
+// A segment is published once, fully allocated, before any symbol in it is
+// handed out, and interned text is never freed, so references returned by
+// name() stay valid for as long as the Interner.
+//
+// The command line interns into global(). The library gives each program
+// it compiles or loads an Interner of its own (Program::names), made
+// current by an InternerScope while it is built or its names are read,
+// so a host that compiles many programs does not keep every name any of
+// them ever used.
+class Interner {
+private:
+    static const int SHARD_BITS = 4;
+    static const int SHARD_COUNT = 1 << SHARD_BITS;
+    static const uint32_t FIRST_SEGMENT = 64;
+    static const int SEGMENT_COUNT = 23;    // 64 * (2^23 - 1) names: past what a Symbol can index
+
+    struct Shard {
+        mutex lock;
+        atomic<uint32_t> count;                 // Names interned so far
+        atomic<string*> segments[SEGMENT_COUNT];
+        vector<uint64_t> hashes;                // Index -> full hash, to skip most compares
+        vector<uint32_t> slots;                 // Open addressing: index + 1, or 0 if empty
+
+        Shard();
+        ~Shard();
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    static uint64_t hash(const char* text, size_t length);
+    static void insertSlot(Shard& shard, uint64_t hash, uint32_t index);
+    static string* entry(const Shard& shard, uint32_t index);
+
+public:
+    // --- Public Interface ---
+    static Interner& global();
+    static Interner& current();   // The one in scope on this thread, else global()
+
+    Symbol intern(const char* text, size_t length);
+    Symbol intern(const string& text) { return intern(text.data(), text.size()); }
+
+    const string& name(Symbol symbol) const;
+    size_t size() const;
+};
+
+// Makes 'interner' current on this thread until the scope ends. A null
+// interner leaves the current one in place.
+class InternerScope {
+private:
+    Interner* saved;
+
+public:
+    explicit InternerScope(Interner* interner);
+    ~InternerScope();
+
+    InternerScope(const InternerScope&) = delete;
+    InternerScope& operator=(const InternerScope&) = delete;
+};
+
+#endif // INTERNER_H
@@ -0,0 +1,749 @@
+#include "interpreter.h"
+#include "workpool.h"
+#include "squad.h"
+#include <sstream>
+#include <cmath>
+#include <climits>
+#include <exception>
+#include <algorithm>
+
+// =============================================================================
+// 1. VALUE HELPERS
+// =============================================================================
+
+string valueTypeName(ValueType type) {
+    switch (type) {
+        case VAL_TROOP:    return "troop";
+        case VAL_AMMO:     return "ammo";
+        case VAL_CODENAME: return "codename";
+        case VAL_STATUS:   return "status";
+        case VAL_TROOP_SQUAD: return "squad troop";
+        case VAL_AMMO_SQUAD:  return "squad ammo";
+        default:           return "nothing";
+    }
+}
+
+// Truncates toward zero. NaN, infinities and values whose truncation does
+// not fit in an int are a runtime error rather than an undefined cast.
+int Interpreter::ammoToTroop(double ammo, int line) {
+    if (!(ammo > INT_MIN - 1.0 && ammo < INT_MAX + 1.0)) {
+        ostringstream text;
+        text << "Ammo value " << ammo << " does not fit in a troop.";
+        throw RuntimeError(line, text.str());
+    }
+    return (int)ammo;
+}
+
+// Converts for assignment to a variable or parameter of 'type'
+Value Interpreter::convert(const Value& value, ValueType type, int line) {
+    if (value.type == type) return value;
+    switch (type) {
+        case VAL_TROOP:
+            if (value.type == VAL_AMMO) return Value::makeTroop(ammoToTroop(value.ammo, line));
+            if (value.type == VAL_STATUS) return Value::makeTroop(value.status ? 1 : 0);
+            break;
+        case VAL_AMMO:
+            if (value.type == VAL_TROOP) return Value::makeAmmo(value.troop);
+            if (value.type == VAL_STATUS) return Value::makeAmmo(value.status ? 1.0 : 0.0);
+            break;
+        case VAL_STATUS:
+            if (value.isNumber()) return Value::makeStatus(value.asDouble() != 0.0);
+            break;
+        case VAL_TROOP_SQUAD:
+        case VAL_AMMO_SQUAD:
+            if (value.isSquad()) return squadConvert(value, type, line);
+            break;
+        default:
+            break;
+    }
+    throw RuntimeError(line, "Cannot convert " + valueTypeName(value.type) + " to " + valueTypeName(type) + ".");
+}
+
+bool Interpreter::truthy(const Value& value, int line) {
+    if (value.type == VAL_STATUS) return value.status;
+    if (value.type == VAL_TROOP) return value.troop != 0;
+    if (value.type == VAL_AMMO) return value.ammo != 0.0;
+    throw RuntimeError(line, "Expected a status but got " + valueTypeName(value.type) + ".");
+}
+
+string Interpreter::format(const Value& value, int line) {
+    switch (value.type) {
+        case VAL_TROOP:    return to_string(value.troop);
+        case VAL_CODENAME: return value.codename();
+        case VAL_STATUS:   return value.status ? "true" : "false";
+        case VAL_TROOP_SQUAD:
+        case VAL_AMMO_SQUAD:   return squadFormat(value);
+        case VAL_AMMO: {
+            ostringstream text;
+            text << value.ammo;
+            return text.str();
+        }
+        default:
+            throw RuntimeError(line, "Tactic retreated without a value.");
+    }
+}
+
+// =============================================================================
+// 2. RUN BUDGETS AND THE FRAME STACK
+// =============================================================================
+
+static thread_local MemoryAccount* currentAccount = nullptr;
+
+void chargeMemory(long long bytes) {
+    MemoryAccount* account = currentAccount;
+    if (account) account->bytes.fetch_add(bytes, memory_order_relaxed);
+}
+
+void freeObject(StringObject* object) {
+    chargeMemory(-object->bytes());
+    delete object;
+}
+
+void freeObject(SquadObject* object) {
+    chargeMemory(-object->bytes());
+    delete object;
+}
+
+AccountScope::AccountScope(MemoryAccount* account) : saved(currentAccount) {
+    currentAccount = account;
+}
+
+AccountScope::~AccountScope() {
+    currentAccount = saved;
+}
+
+void reserveMemory(size_t bytes, int line) {
+    MemoryAccount* account = currentAccount;
+    if (!account || account->limit == 0) return;
+    if (account->bytes.load(memory_order_relaxed) + (long long)bytes > (long long)account->limit) {
+        throw LimitError(line, "Memory limit exceeded (" + to_string(account->limit / 1024) + " KB).");
+    }
+}
+
+// Doubles the slots until 'needed' fit, as memory of the current run
+void FrameStack::grow(size_t needed, int line) {
+    if (needed > capacity) {
+        throw RuntimeError(line, "Tactic frame stack exhausted (" + to_string(capacity) + " slots).");
+    }
+    size_t size = max(slots.size() * 2, needed);
+    if (size > capacity) size = capacity;
+    size_t added = (size - slots.size()) * sizeof(Value);
+    reserveMemory(added, line);
+    chargeMemory((long long)added);
+    slots.resize(size);
+}
+
+void FrameStack::depthError(int line) {
+    throw RuntimeError(line, "Recursion limit exceeded (" + to_string(maxDepth) +
+                             " nested tactic calls). Use 'retreat f(...)' for deep recursion.");
+}
+
+// =============================================================================
+// 3. SETUP AND CALLS
+// =============================================================================
+
+Interpreter::Interpreter(const Program& program, const RunOptions& options, RunIO& io)
+    : program(program), options(options), frames(options.stackSlots, options.maxCallDepth),
+      maxNativeStack(options.maxNativeStack), stepBudget(options.maxSteps > 0 ? options.maxSteps : LLONG_MAX),
+      stepsLeft(stepBudget), account(options.maxMemory), io(io) {}
+
+Interpreter::~Interpreter() {}
+
+void Interpreter::nativeStackError(int line) {
+    throw RuntimeError(line, "Recursion too deep for the native stack (" + to_string(maxNativeStack / 1024) +
+                             " KB, depth " + to_string(frames.getDepth()) + "). Use 'retreat f(...)' for deep recursion.");
+}
+
+// Steps a worker takes from its loop's budget at a time
+static const long long stepGrant = 1024;
+
+// A worker draws more steps from the budget its parallel loop shares; any
+// other interpreter, or a worker that finds that budget empty, is done
+void Interpreter::outOfSteps(int line) {
+    if (sharedSteps) {
+        long long available = sharedSteps->load(memory_order_relaxed);
+        while (available > 0 &&
+               !sharedSteps->compare_exchange_weak(available, available - min(available, stepGrant))) {}
+        if (available > 0) {
+            long long grant = min(available, stepGrant);
+            stepsLeft += grant;
+            stepsDrawn += grant;
+            return;
+        }
+    }
+    throw LimitError(line, "Step limit exceeded (" + to_string(stepBudget) + " statements).");
+}
+
+Value Interpreter::run() {
+    char marker;
+    nativeStackBase = &marker;
+    AccountScope scope(memory);
+    stepsLeft = stepBudget;
+    frames.reset();
+    frameBase = 0;
+
+    globalValues.assign(program.globals.size(), Value());
+    globals = globalValues.data();
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        globals[global->slot] = global->expr ? convert(evaluate(*global->expr), global->varType, global->line)
+                                             : Value::defaultFor(global->varType);
+    }
+
+    if (program.campaign < 0) {
+        throw RuntimeError(0, "No 'tactic campaign()' to run.");
+    }
+    const Function& campaign = program.functions[program.campaign];
+    if (!campaign.params.empty()) {
+        throw RuntimeError(campaign.line, "'campaign' must not take parameters.");
+    }
+    vector<unique_ptr<Expr>> noArgs;
+    return callFunction(program.campaign, noArgs, campaign.line);
+}
+
+// Evaluates the arguments into the parameter slots of the frame at 'base'.
+// Arguments are evaluated in the caller's frame.
+void Interpreter::stageArguments(const Function& function, const vector<unique_ptr<Expr>>& args, size_t base) {
+    for (size_t i = 0; i < args.size(); i++) {
+        Value value = evaluate(*args[i]);
+        if (value.type != function.params[i].type) {
+            value = convert(value, function.params[i].type, args[i]->line);
+        }
+        frames[base + i] = move(value);
+    }
+}
+
+Value Interpreter::callFunction(int index, const vector<unique_ptr<Expr>>& args, int line) {
+    // Each nested call also recurses in this interpreter, so guard the
+    // native stack as well as the frame depth
+    char marker;
+    if ((size_t)(nativeStackBase - &marker) > maxNativeStack) {
+        nativeStackError(line);
+    }
+
+    const Function* function = &program.functions[index];
+    size_t base = frames.push(function->frameSize, line);
+    stageArguments(*function, args, base);
+    size_t callerBase = frameBase;
+    frameBase = base;
+
+    ExecResult status;
+    while ((status = runBody(*function->body)) == EXEC_TAIL_CALL) {
+        // 'retreat f(...)': the arguments were staged just above this
+        // frame, as no call of their own. Slide them down and run f here.
+        function = &program.functions[tailFunction];
+        for (size_t i = 0; i < function->params.size(); i++) {
+            frames[base + i] = move(frames[tailBase + i]);
+        }
+        frames.resize(base, function->frameSize, line);
+    }
+
+    frameBase = callerBase;
+    frames.pop(base);
+    return status == EXEC_RETREAT ? move(returnValue) : Value();
+}
+
+// A tactic's body block, run without a dispatch of its own. It still
+// counts as a step, as execute() would count it.
+Interpreter::ExecResult Interpreter::runBody(const Stmt& body) {
+    if (body.kind != STMT_BLOCK) return execute(body);
+    if (--stepsLeft < 0) outOfSteps(body.line);
+    for (const unique_ptr<Stmt>& inner : body.statements) {
+        ExecResult status = execute(*inner);
+        if (status != EXEC_NORMAL) return status;
+    }
+    return EXEC_NORMAL;
+}
+
+// =============================================================================
+// 4. STATEMENTS
+// =============================================================================
+
+Interpreter::ExecResult Interpreter::execute(const Stmt& stmt) {
+    if (--stepsLeft < 0) outOfSteps(stmt.line);
+    switch (stmt.kind) {
+        case STMT_BLOCK:
+            for (const unique_ptr<Stmt>& inner : stmt.statements) {
+                ExecResult status = execute(*inner);
+                if (status != EXEC_NORMAL) return status;
+            }
+            return EXEC_NORMAL;
+
+        case STMT_VAR: {
+            if (!stmt.expr) {
+                variable(stmt.slot, stmt.global) = Value::defaultFor(stmt.varType);
+            } else {
+                Value value = evaluate(*stmt.expr);
+                variable(stmt.slot, stmt.global) =
+                    value.type == stmt.varType ? move(value) : convert(value, stmt.varType, stmt.line);
+            }
+            return EXEC_NORMAL;
+        }
+
+        case STMT_IF:
+            if (truthy(evaluate(*stmt.expr), stmt.line)) return execute(*stmt.body);
+            if (stmt.elseBranch) return execute(*stmt.elseBranch);
+            return EXEC_NORMAL;
+
+        case STMT_WHILE:
+            while (truthy(evaluate(*stmt.expr), stmt.line)) {
+                ExecResult status = execute(*stmt.body);
+                if (status == EXEC_ABORT) break;
+                if (status != EXEC_NORMAL) return status;
+            }
+            return EXEC_NORMAL;
+
+        case STMT_FOR:
+            if (stmt.parallel) return parallelFor(stmt);
+            if (stmt.init) execute(*stmt.init);
+            while (!stmt.expr || truthy(evaluate(*stmt.expr), stmt.line)) {
+                ExecResult status = execute(*stmt.body);
+                if (status == EXEC_ABORT) break;
+                if (status != EXEC_NORMAL) return status;
+                if (stmt.update) evaluate(*stmt.update);
+            }
+            return EXEC_NORMAL;
+
+        case STMT_BRIEF:
+            io.brief(format(evaluate(*stmt.expr), stmt.line));
+            return EXEC_NORMAL;
+
+        case STMT_INTEL:
+            readIntel(stmt);
+            return EXEC_NORMAL;
+
+        case STMT_RETREAT:
+            if (stmt.tailCall) {
+                const Expr& call = *stmt.expr;
+                tailFunction = call.function;
+                const Function& callee = program.functions[call.function];
+                tailBase = frames.stage((int)callee.params.size(), call.line);
+                stageArguments(callee, call.args, tailBase);
+                return EXEC_TAIL_CALL;
+            }
+            returnValue = stmt.expr ? evaluate(*stmt.expr) : Value();
+            return EXEC_RETREAT;
+
+        case STMT_ABORT:
+            return EXEC_ABORT;
+
+        case STMT_EXPR:
+            evaluate(*stmt.expr);
+            return EXEC_NORMAL;
+    }
+    return EXEC_NORMAL;
+}
+
+// 'intel x;' reads one line and converts it to x's declared type
+void Interpreter::readIntel(const Stmt& stmt) {
+    variable(stmt.slot, stmt.global) = readIntelValue(io, stmt.varType, stmt.line);
+}
+
+Value Interpreter::readIntelValue(RunIO& io, ValueType type, int line) {
+    string input;
+    if (!io.intel(input)) {
+        throw RuntimeError(line, "No input left for 'intel'.");
+    }
+    if (!input.empty() && input.back() == '\r') input.pop_back();
+
+    if (type == VAL_CODENAME) {
+        reserveMemory(sizeof(StringObject) + input.size(), line);
+        return Value::makeCodename(input);
+    }
+
+    istringstream stream(input);
+    Value result;
+    bool ok = false;
+    if (type == VAL_TROOP) {
+        int value;
+        ok = (bool)(stream >> value);
+        if (ok) result = Value::makeTroop(value);
+    } else if (type == VAL_AMMO) {
+        double value;
+        ok = (bool)(stream >> value);
+        if (ok) result = Value::makeAmmo(value);
+    } else {
+        string word;
+        stream >> word;
+        ok = word == "true" || word == "false";
+        if (ok) result = Value::makeStatus(word == "true");
+    }
+    if (!ok || !(stream >> ws).eof()) {
+        throw RuntimeError(line, "Invalid " + valueTypeName(type) + " input '" + input + "'.");
+    }
+    return result;
+}
+
+// =============================================================================
+// 5. EXPRESSIONS
+// =============================================================================
+
+Value Interpreter::evaluate(const Expr& expr) {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            return expr.literal;
+
+        case EXPR_VARIABLE:
+            return variable(expr.slot, expr.global);
+
+        case EXPR_ASSIGN: {
+            Value value = evaluate(*expr.right);
+            Value& target = variable(expr.slot, expr.global);
+            target = value.type == target.type ? value : convert(value, target.type, expr.line);
+            return target;
+        }
+
+        case EXPR_CALL:
+            return callFunction(expr.function, expr.args, expr.line);
+
+        case EXPR_UNARY: {
+            Value operand = evaluate(*expr.left);
+            if (expr.op == TOK_NOT) return Value::makeStatus(!truthy(operand, expr.line));
+            return negate(operand, expr.line);
+        }
+
+        case EXPR_BINARY:
+            return binary(expr);
+
+        case EXPR_INLINE:
+            return inlined(expr);
+
+        case EXPR_SQUAD:
+        case EXPR_INDEX:
+        case EXPR_SET_INDEX:
+        case EXPR_BUILTIN:
+            return squadExpression(expr);
+    }
+    return Value();
+}
+
+Value Interpreter::binary(const Expr& expr) {
+    // Short-circuit operators evaluate the right side only when needed
+    if (expr.op == TOK_AND) {
+        if (!truthy(evaluate(*expr.left), expr.line)) return Value::makeStatus(false);
+        return Value::makeStatus(truthy(evaluate(*expr.right), expr.line));
+    }
+    if (expr.op == TOK_OR) {
+        if (truthy(evaluate(*expr.left), expr.line)) return Value::makeStatus(true);
+        return Value::makeStatus(truthy(evaluate(*expr.right), expr.line));
+    }
+
+    Value a = evaluate(*expr.left);
+    Value b = evaluate(*expr.right);
+    return applyBinary(expr.op, a, b, expr.line);
+}
+
+// An inlined call binds its arguments in this frame, converting like
+// stageArguments(), then evaluates the callee's 'retreat' expression
+Value Interpreter::inlined(const Expr& expr) {
+    for (size_t i = 0; i < expr.args.size(); i++) {
+        Value value = evaluate(*expr.args[i]);
+        if (value.type != expr.paramTypes[i]) {
+            value = convert(value, expr.paramTypes[i], expr.args[i]->line);
+        }
+        frames[frameBase + expr.slot + i] = move(value);
+    }
+    return evaluate(*expr.left);
+}
+
+// Out of line, like binary(), so evaluate() stays small on the native stack
+Value Interpreter::squadExpression(const Expr& expr) {
+    switch (expr.kind) {
+        case EXPR_SQUAD: {
+            vector<Value> elements;
+            elements.reserve(expr.args.size());
+            for (const unique_ptr<Expr>& element : expr.args) elements.push_back(evaluate(*element));
+            return makeSquadLiteral(elements, expr.line);
+        }
+
+        // The index is evaluated before the squad, so a variable is read
+        // in place rather than copied
+        case EXPR_INDEX: {
+            Value index = evaluate(*expr.right);
+            if (expr.left->kind == EXPR_VARIABLE) {
+                return squadElement(variable(expr.left->slot, expr.left->global), index, expr.line);
+            }
+            return squadElement(evaluate(*expr.left), index, expr.line);
+        }
+
+        case EXPR_SET_INDEX: {
+            Value index = evaluate(*expr.left);
+            Value value = evaluate(*expr.right);
+            return squadStore(variable(expr.slot, expr.global), index, value, expr.line);
+        }
+
+        case EXPR_BUILTIN: {
+            Value args[2];
+            for (size_t i = 0; i < expr.args.size(); i++) args[i] = evaluate(*expr.args[i]);
+            return callBuiltin((Builtin)expr.function, args, expr.line);
+        }
+        default:
+            break;
+    }
+    return Value();
+}
+
+Value Interpreter::negate(const Value& operand, int line) {
+    if (operand.type == VAL_TROOP) return Value::makeTroop((int)(0u - (unsigned)operand.troop));
+    if (operand.type == VAL_AMMO) return Value::makeAmmo(-operand.ammo);
+    if (operand.isSquad()) return squadNegate(operand, line);
+    throw RuntimeError(line, "Cannot negate " + valueTypeName(operand.type) + ".");
+}
+
+// Every operator except the short-circuit '&&' and '||'
+Value Interpreter::applyBinary(TokenType op, const Value& a, const Value& b, int line) {
+    // troop op troop stays in integers (wrapping on overflow)
+    if (a.type == VAL_TROOP && b.type == VAL_TROOP) {
+        int x = a.troop;
+        int y = b.troop;
+        switch (op) {
+            case TOK_PLUS:     return Value::makeTroop((int)((unsigned)x + (unsigned)y));
+            case TOK_MINUS:    return Value::makeTroop((int)((unsigned)x - (unsigned)y));
+            case TOK_MULTIPLY: return Value::makeTroop((int)((unsigned)x * (unsigned)y));
+            case TOK_DIVIDE:
+            case TOK_MODULO:
+                if (y == 0) throw RuntimeError(line, "Division by zero.");
+                if (x == INT_MIN && y == -1) return Value::makeTroop(op == TOK_DIVIDE ? INT_MIN : 0);
+                return Value::makeTroop(op == TOK_DIVIDE ? x / y : x % y);
+            case TOK_EQUAL:         return Value::makeStatus(x == y);
+            case TOK_NOT_EQUAL:     return Value::makeStatus(x != y);
+            case TOK_LESS:          return Value::makeStatus(x < y);
+            case TOK_GREATER:       return Value::makeStatus(x > y);
+            case TOK_LESS_EQUAL:    return Value::makeStatus(x <= y);
+            case TOK_GREATER_EQUAL: return Value::makeStatus(x >= y);
+            default: break;
+        }
+    }
+
+    // '+' with a codename on either side concatenates
+    if (op == TOK_PLUS && (a.type == VAL_CODENAME || b.type == VAL_CODENAME)) {
+        string text = format(a, line) + format(b, line);
+        reserveMemory(sizeof(StringObject) + text.size(), line);
+        return Value::makeCodename(text);
+    }
+
+    // A squad on either side applies the operator elementwise
+    if (a.isSquad() || b.isSquad()) return squadBinary(op, a, b, line);
+
+    if (a.isNumber() && b.isNumber()) {
+        double x = a.asDouble();
+        double y = b.asDouble();
+        switch (op) {
+            case TOK_PLUS:     return Value::makeAmmo(x + y);
+            case TOK_MINUS:    return Value::makeAmmo(x - y);
+            case TOK_MULTIPLY: return Value::makeAmmo(x * y);
+            case TOK_DIVIDE:   return Value::makeAmmo(x / y);
+            case TOK_MODULO:   return Value::makeAmmo(fmod(x, y));
+            case TOK_EQUAL:         return Value::makeStatus(x == y);
+            case TOK_NOT_EQUAL:     return Value::makeStatus(x != y);
+            case TOK_LESS:          return Value::makeStatus(x < y);
+            case TOK_GREATER:       return Value::makeStatus(x > y);
+            case TOK_LESS_EQUAL:    return Value::makeStatus(x <= y);
+            case TOK_GREATER_EQUAL: return Value::makeStatus(x >= y);
+            default: break;
+        }
+    }
+
+    if (a.type == VAL_CODENAME && b.type == VAL_CODENAME) {
+        switch (op) {
+            case TOK_EQUAL:         return Value::makeStatus(a.codename() == b.codename());
+            case TOK_NOT_EQUAL:     return Value::makeStatus(a.codename() != b.codename());
+            case TOK_LESS:          return Value::makeStatus(a.codename() < b.codename());
+            case TOK_GREATER:       return Value::makeStatus(a.codename() > b.codename());
+            case TOK_LESS_EQUAL:    return Value::makeStatus(a.codename() <= b.codename());
+            case TOK_GREATER_EQUAL: return Value::makeStatus(a.codename() >= b.codename());
+            default: break;
+        }
+    }
+
+    if (a.type == VAL_STATUS && b.type == VAL_STATUS) {
+        if (op == TOK_EQUAL) return Value::makeStatus(a.status == b.status);
+        if (op == TOK_NOT_EQUAL) return Value::makeStatus(a.status != b.status);
+    }
+
+    operandError(op, a, b, line);
+}
+
+// Kept out of line so applyBinary() stays small on the native stack
+void Interpreter::operandError(TokenType op, const Value& a, const Value& b, int line) {
+    throw RuntimeError(line, "Operator '" + Scanner::tokenTypeToString(op) + "' cannot combine " +
+                                  valueTypeName(a.type) + " and " + valueTypeName(b.type) + ".");
+}
+
+// =============================================================================
+// 6. PARALLEL LOOPS
+// =============================================================================
+
+// Iterations are split into at most this many chunks. The split depends
+// only on the trip count, never on options.workers, so reductions combine
+// in the same order on any number of threads and an ammo sum comes out the
+// same bits every time. It is not the order of the sequential loop, though:
+// troop and codename reductions still agree with it, ammo ones may not.
+static const long long parallelChunks = 64;
+
+// What each chunk starts a reduction variable from
+static Value reductionIdentity(const Reduction& reduction, int line) {
+    if (reduction.type == VAL_CODENAME) return Value::makeCodename("");
+    Value identity;
+    switch (reduction.op) {
+        case TOK_PLUS:     identity = Value::makeTroop(0); break;
+        case TOK_MULTIPLY: identity = Value::makeTroop(1); break;
+        case TOK_AND:      identity = Value::makeStatus(true); break;
+        default:           identity = Value::makeStatus(false); break;
+    }
+    return Interpreter::convert(identity, reduction.type, line);
+}
+
+// 'x = a op b' as the loop body would have written it
+static Value combine(const Reduction& reduction, const Value& a, const Value& b, int line) {
+    Value result;
+    if (reduction.op == TOK_AND) {
+        result = Value::makeStatus(Interpreter::truthy(a, line) && Interpreter::truthy(b, line));
+    } else if (reduction.op == TOK_OR) {
+        result = Value::makeStatus(Interpreter::truthy(a, line) || Interpreter::truthy(b, line));
+    } else {
+        result = Interpreter::applyBinary(reduction.op, a, b, line);
+    }
+    return Interpreter::convert(result, reduction.type, line);
+}
+
+// The Resolver guarantees 'troop i = start; i < bound (or <=); i = i + step'
+// and a body that only writes its own locals and the loop's reductions.
+// Chunks run on the pool, or one after another in this frame when this is
+// already a worker. Either way their 'brief' output and first error come
+// out in iteration order, and the partial reductions are folded in chunk order.
+//
+// Workers draw their steps from one budget, what this interpreter has left,
+// and are charged exactly what each chunk executed. A chunk that fails stops
+// the chunks after it. A chunk that runs into a limit stops them all, and
+// the loop runs again in order here, so that it fails at the statement a
+// sequential loop would, with any number of workers.
+Interpreter::ExecResult Interpreter::parallelFor(const Stmt& stmt) {
+    const Stmt& init = *stmt.init;
+    const Expr& cond = *stmt.expr;
+    Value startValue = evaluate(*init.expr);
+    if (startValue.type != VAL_TROOP) startValue = convert(startValue, VAL_TROOP, init.line);
+    Value bound = evaluate(*cond.right);
+    if (!bound.isNumber()) applyBinary(cond.op, startValue, bound, cond.line);   // Throws
+
+    long long start = startValue.troop;
+    long long step = stmt.update->right->right->literal.troop;
+    long long last;
+    if (bound.type == VAL_TROOP) {
+        last = cond.op == TOK_LESS ? (long long)bound.troop - 1 : bound.troop;
+    } else {
+        double limit = cond.op == TOK_LESS ? ceil(bound.ammo) - 1 : floor(bound.ammo);
+        last = limit != limit ? start - 1 : (long long)max((double)INT_MIN - 1, min((double)INT_MAX, limit));
+    }
+    if (last > INT_MAX) last = INT_MAX;
+    if (last < start) return EXEC_NORMAL;
+    long long count = (last - start) / step + 1;
+    long long chunks = min(count, parallelChunks);
+
+    vector<vector<Value>> partials((size_t)chunks);
+    bool inOrder = isWorker || chunks == 1 || options.workers == 1;
+    if (!inOrder) {
+        atomic<long long> budget(stepsLeft);
+        startWorkers();
+        for (unique_ptr<Worker>& worker : workers) {
+            worker->interpreter->globals = globals;
+            worker->interpreter->stepsLeft = 0;
+            worker->interpreter->stepsDrawn = 0;
+            worker->interpreter->sharedSteps = &budget;
+            worker->ready = false;
+        }
+
+        vector<vector<string>> output((size_t)chunks);
+        vector<exception_ptr> failures((size_t)chunks);
+        vector<long long> stepsUsed((size_t)chunks, 0);
+        atomic<long long> firstFailure(chunks);   // -1 once a chunk runs into a limit
+        size_t frameSize = frames.getTop() - frameBase;
+
+        pool->run((size_t)chunks, [&](size_t task, int index) {
+            long long c = (long long)task;
+            if (c > firstFailure) return;   // Its output would never be shown
+            Worker& worker = *workers[index];
+            Interpreter& child = *worker.interpreter;
+            AccountScope scope(memory);
+            char marker;
+            child.nativeStackBase = index == 0 ? nativeStackBase : &marker;
+            long long usedBefore = child.stepsDrawn - child.stepsLeft;
+            try {
+                if (!worker.ready) {
+                    child.frames.reset();
+                    child.frameBase = child.frames.push((int)frameSize, stmt.line);
+                    for (size_t i = 0; i < frameSize; i++) child.frames[child.frameBase + i] = frames[frameBase + i];
+                    worker.ready = true;
+                }
+                child.runChunk(stmt, start, step, count * c / chunks, count * (c + 1) / chunks, partials[task], c,
+                               &firstFailure);
+            } catch (LimitError&) {
+                firstFailure = -1;
+            } catch (...) {
+                failures[task] = current_exception();
+                long long seen = firstFailure;
+                while (c < seen && !firstFailure.compare_exchange_weak(seen, c)) {}
+            }
+            stepsUsed[task] = child.stepsDrawn - child.stepsLeft - usedBefore;
+            output[task].swap(worker.output);
+            worker.output.clear();
+        });
+        for (unique_ptr<Worker>& worker : workers) worker->interpreter->sharedSteps = nullptr;
+
+        inOrder = firstFailure < 0;
+        if (!inOrder) {
+            for (size_t c = 0; c < output.size() && (long long)c <= firstFailure; c++) {
+                stepsLeft -= stepsUsed[c];
+                for (const string& text : output[c]) io.brief(text);
+                if (failures[c]) rethrow_exception(failures[c]);
+            }
+        }
+    }
+    if (inOrder) {
+        vector<Value> saved;
+        for (const Reduction& reduction : stmt.reductions) saved.push_back(frames[frameBase + reduction.slot]);
+        for (long long c = 0; c < chunks; c++) {
+            runChunk(stmt, start, step, count * c / chunks, count * (c + 1) / chunks, partials[(size_t)c], c, nullptr);
+        }
+        for (size_t r = 0; r < saved.size(); r++) frames[frameBase + stmt.reductions[r].slot] = move(saved[r]);
+    }
+
+    for (size_t r = 0; r < stmt.reductions.size(); r++) {
+        const Reduction& reduction = stmt.reductions[r];
+        Value& accumulator = frames[frameBase + reduction.slot];
+        for (vector<Value>& partial : partials) {
+            accumulator = reduction.accumulatorFirst ? combine(reduction, accumulator, partial[r], stmt.line)
+                                                     : combine(reduction, partial[r], accumulator, stmt.line);
+        }
+    }
+    return EXEC_NORMAL;
+}
+
+// Runs iterations [first, last) in the current frame, with every reduction
+// starting from its identity, and leaves the reductions' values in 'partial'.
+// On the pool it gives up between iterations once an earlier chunk has failed.
+void Interpreter::runChunk(const Stmt& stmt, long long start, long long step, long long first, long long last,
+                           vector<Value>& partial, long long chunk, const atomic<long long>* firstFailure) {
+    for (const Reduction& reduction : stmt.reductions) {
+        frames[frameBase + reduction.slot] = reductionIdentity(reduction, stmt.line);
+    }
+    for (long long k = first; k < last; k++) {
+        if (firstFailure && firstFailure->load(memory_order_relaxed) < chunk) return;
+        frames[frameBase + stmt.init->slot] = Value::makeTroop((int)(start + k * step));
+        execute(*stmt.body);   // Cannot abort or retreat out of the loop
+    }
+    partial.clear();
+    for (const Reduction& reduction : stmt.reductions) partial.push_back(frames[frameBase + reduction.slot]);
+}
+
+// The pool and its worker interpreters live as long as this interpreter
+void Interpreter::startWorkers() {
+    if (pool) return;
+    pool.reset(new WorkPool(options.workers));
+    for (int i = 0; i < pool->size(); i++) {
+        unique_ptr<Worker> worker(new Worker());
+        worker->interpreter.reset(new Interpreter(program, options, *worker));
+        worker->interpreter->isWorker = true;
+        worker->interpreter->memory = memory;
+        workers.push_back(move(worker));
+    }
+}
@@ -0,0 +1,268 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. RUNTIME CONFIGURATION AND ERRORS
+// =============================================================================
+
+struct RunOptions {
+    int maxCallDepth = 10000;           // Nested (non-tail) tactic calls allowed
+    size_t stackSlots = 1 << 16;        // Value slots all frames may use; grown on demand
+    size_t maxNativeStack = 512 * 1024; // C++ stack the interpreter may recurse into
+    int workers = 0;                    // Threads for 'deploy parallel', caller included; 0 = one per core
+    long long maxSteps = 0;             // Statements (IR: blocks) a run may execute; 0 = no limit
+    size_t maxMemory = 0;               // Bytes of frames, codenames and squads a run may hold; 0 = no limit
+};
+
+// Thrown for any error while a program runs; the message is ready to print
+class RuntimeError : public runtime_error {
+public:
+    int line;
+    RuntimeError(int line, const string& message)
+        : runtime_error("[Line " + to_string(line) + "] Runtime error: " + message), line(line) {}
+};
+
+// A run that used up RunOptions::maxSteps or maxMemory
+class LimitError : public RuntimeError {
+public:
+    LimitError(int line, const string& message) : RuntimeError(line, message) {}
+};
+
+// =============================================================================
+// 2. RUN BUDGETS AND I/O
+// =============================================================================
+
+// What a run holds in frames, codename text and squad elements. A run makes
+// its account current on every thread it uses, and Values charge and credit
+// whichever account is current where they are created and freed (see
+// chargeMemory() in value.h). Code that is about to grow a run's memory
+// calls reserveMemory() first, so the limit holds before the allocation.
+struct MemoryAccount {
+    atomic<long long> bytes;
+    size_t limit;               // 0 = no limit
+
+    explicit MemoryAccount(size_t limit) : bytes(0), limit(limit) {}
+};
+
+// Makes 'account' current on this thread until the scope ends
+class AccountScope {
+private:
+    MemoryAccount* saved;
+
+public:
+    explicit AccountScope(MemoryAccount* account);
+    ~AccountScope();
+
+    AccountScope(const AccountScope&) = delete;
+    AccountScope& operator=(const AccountScope&) = delete;
+};
+
+// Throws LimitError if the current account cannot take 'bytes' more
+void reserveMemory(size_t bytes, int line);
+
+// Where a run's 'brief' text goes and its 'intel' lines come from
+class RunIO {
+public:
+    virtual ~RunIO() {}
+    virtual void brief(const string& text) = 0;
+
+    // The next line of input, without its newline. Returns false if there is none.
+    virtual bool intel(string& line) = 0;
+};
+
+// 'brief' writes a line to 'out'; 'intel' flushes 'out', then reads from 'in'
+class StreamIO : public RunIO {
+private:
+    istream& in;
+    ostream& out;
+
+public:
+    StreamIO(istream& in, ostream& out) : in(in), out(out) {}
+
+    void brief(const string& text) override { out << text << '\n'; }
+    bool intel(string& line) override {
+        out.flush();
+        return (bool)getline(in, line);
+    }
+};
+
+// =============================================================================
+// 3. FRAME STACK
+// =============================================================================
+
+// All tactic frames live in one contiguous array of slots. A call is a
+// bump of 'top'; a return moves it back, and a tail call reuses the
+// caller's frame in place. The array starts small and doubles when a push
+// needs more, up to 'capacity' slots, so nothing is allocated per call
+// once a run has reached its deepest recursion. Growing moves every slot:
+// no reference into the stack may be held across a call.
+class FrameStack {
+private:
+    vector<Value> slots;
+    size_t top = 0;
+    int depth = 0;
+    int maxDepth;
+    size_t capacity;
+
+public:
+    FrameStack(size_t capacity, int maxDepth)
+        : slots(capacity < initialSlots ? capacity : initialSlots), maxDepth(maxDepth), capacity(capacity) {}
+
+    // Reserves 'size' slots and returns the new frame's base
+    size_t push(int size, int line) {
+        if (depth >= maxDepth) depthError(line);
+        size_t base = stage(size, line);
+        depth++;
+        return base;
+    }
+
+    // Reserves 'size' slots above the topmost frame without counting a
+    // call: the arguments of a tail call, which resize() then releases
+    size_t stage(int size, int line) {
+        if (top + size > slots.size()) grow(top + size, line);
+        size_t base = top;
+        top += size;
+        return base;
+    }
+
+    // Releases the frame at 'base' and everything above it
+    void pop(size_t base) {
+        top = base;
+        depth--;
+    }
+
+    // Resizes the frame at 'base', which must be the topmost one (tail calls)
+    void resize(size_t base, int size, int line) {
+        if (base + size > slots.size()) grow(base + size, line);
+        top = base + size;
+    }
+
+    void reset() {
+        top = 0;
+        depth = 0;
+    }
+
+    Value& operator[](size_t index) { return slots[index]; }
+    size_t getTop() const { return top; }
+    int getDepth() const { return depth; }
+
+private:
+    static const size_t initialSlots = 64;
+
+    void grow(size_t needed, int line);
+    [[noreturn]] void depthError(int line);
+};
+
+// =============================================================================
+// 4. INTERPRETER CLASS DECLARATION
+// =============================================================================
+
+class WorkPool;
+
+// Tree-walking interpreter over a resolved Program, which it never changes:
+// any number of interpreters may run one Program at once.
+// 'brief' and 'intel' go through 'io'.
+// A 'deploy parallel' loop runs its chunks on worker interpreters that
+// share this one's globals, each with a frame stack of its own.
+class Interpreter {
+private:
+    // How a statement finished
+    enum ExecResult {
+        EXEC_NORMAL,
+        EXEC_ABORT,      // 'abort' out of the innermost loop
+        EXEC_RETREAT,    // 'retreat', value in returnValue
+        EXEC_TAIL_CALL   // 'retreat f(...)', arguments staged at tailBase
+    };
+
+    // A worker of a parallel loop. Its 'brief' text collects here until
+    // the loop passes it on in iteration order.
+    struct Worker : public RunIO {
+        vector<string> output;
+        unique_ptr<Interpreter> interpreter;
+        bool ready = false;   // Holds a copy of the loop's frame
+
+        void brief(const string& text) override { output.push_back(text); }
+        bool intel(string&) override { return false; }   // The Resolver keeps 'intel' out
+    };
+
+    const Program& program;
+    RunOptions options;
+    FrameStack frames;
+    vector<Value> globalValues;
+    Value* globals = nullptr;   // globalValues, or the spawning interpreter's in a worker
+    size_t frameBase = 0;
+
+    unique_ptr<WorkPool> pool;
+    vector<unique_ptr<Worker>> workers;
+    bool isWorker = false;
+
+    const char* nativeStackBase = nullptr;
+    size_t maxNativeStack;
+
+    long long stepBudget;
+    long long stepsLeft;
+    atomic<long long>* sharedSteps = nullptr;   // A worker's parallel loop's budget, which it draws from
+    long long stepsDrawn = 0;                   // Taken from sharedSteps so far
+    MemoryAccount account;
+    MemoryAccount* memory = &account;   // Or the spawning interpreter's in a worker
+
+    RunIO& io;
+
+    Value returnValue;
+    int tailFunction = -1;
+    size_t tailBase = 0;
+
+    Value& variable(int slot, bool global) {
+        return global ? globals[slot] : frames[frameBase + slot];
+    }
+
+    Value callFunction(int index, const vector<unique_ptr<Expr>>& args, int line);
+    ExecResult runBody(const Stmt& body);
+    void stageArguments(const Function& function, const vector<unique_ptr<Expr>>& args, size_t base);
+    ExecResult execute(const Stmt& stmt);
+    ExecResult parallelFor(const Stmt& stmt);
+    void runChunk(const Stmt& stmt, long long start, long long step, long long first, long long last,
+                  vector<Value>& partial, long long chunk, const atomic<long long>* firstFailure);
+    void startWorkers();
+    Value evaluate(const Expr& expr);
+    Value binary(const Expr& expr);
+    Value inlined(const Expr& expr);
+    Value squadExpression(const Expr& expr);
+    void readIntel(const Stmt& stmt);
+    [[noreturn]] void nativeStackError(int line);
+    void outOfSteps(int line);
+    [[noreturn]] static void operandError(TokenType op, const Value& a, const Value& b, int line);
+
+public:
+    // --- Public Interface ---
+    Interpreter(const Program& program, const RunOptions& options, RunIO& io);
+    ~Interpreter();
+
+    // Initializes globals and runs 'campaign'. Throws RuntimeError, or
+    // LimitError once the run's step or memory budget is used up.
+    Value run();
+
+    // Statements executed by the last run()
+    long long getStepsUsed() const { return stepBudget - (stepsLeft > 0 ? stepsLeft : 0); }
+
+    // --- Value Helpers ---
+    static Value convert(const Value& value, ValueType type, int line);
+    static int ammoToTroop(double ammo, int line);   // Truncates; throws if NaN or out of range
+    static bool truthy(const Value& value, int line);
+    static string format(const Value& value, int line);
+
+    // --- Operators (shared with the IR executor) ---
+    static Value applyBinary(TokenType op, const Value& a, const Value& b, int line);
+    static Value negate(const Value& operand, int line);
+    static Value readIntelValue(RunIO& io, ValueType type, int line);
+};
+
+#endif // INTERPRETER_H
@@ -0,0 +1,134 @@
+#ifndef IR_H
+#define IR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ast.h"
+#include "interpreter.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. INSTRUCTIONS
+// =============================================================================
+
+// Mid-level IR in SSA form: every instruction defines at most one value,
+// and the value's id is its index in IrFunction::values. Local variables
+// disappear into values and phis; globals stay in memory and are reached
+// through LOAD_GLOBAL / STORE_GLOBAL, since any call may write them.
+enum IrOp {
+    IR_CONST,         // constant
+    IR_PARAM,         // index: parameter number
+    IR_UNDEF,         // a variable read no path has written
+    IR_PHI,           // args: one value per predecessor, in IrBlock::preds order
+    IR_CONVERT,       // args[0] converted to 'type' (assignment semantics)
+    IR_UNARY,         // op args[0]
+    IR_TEST,          // args[0] as a status, by truthiness (operand of '&&' / '||')
+    IR_BINARY,        // args[0] op args[1]; never '&&' or '||', which become branches
+    IR_ROTATE,        // args[0] + args[1], minus args[2] once it reaches args[2] (a rotating counter)
+    IR_LOAD_GLOBAL,   // index: global
+    IR_STORE_GLOBAL,  // index: global; args[0]
+    IR_CALL,          // index: tactic; args: arguments, already converted
+    IR_BRIEF,         // args[0]
+    IR_INTEL,         // reads a line as 'type'
+    IR_SQUAD,         // args: the elements of a squad literal
+    IR_INDEX,         // args[0][args[1]]
+    IR_STORE_INDEX,   // a copy of squad args[0] with element args[1] set to args[2]
+    IR_BUILTIN,       // index: Builtin; args: arguments
+    IR_JUMP,          // target[0]
+    IR_BRANCH,        // args[0] ? target[0] : target[1]
+    IR_RETURN         // args: empty or the value
+};
+
+struct IrInstr {
+    IrOp opcode;
+    ValueType type;       // Static result type; VAL_NONE when only known at runtime
+    TokenType op;         // UNARY, BINARY
+    int index;            // PARAM, LOAD/STORE_GLOBAL, CALL, BUILTIN
+    Value constant;       // CONST
+    vector<int> args;     // Operand value ids
+    int target[2];        // JUMP, BRANCH
+    int block;            // Owning block
+    int line;             // Source line, for runtime errors
+    bool dead;            // Removed by a pass; kept so value ids stay stable
+
+    IrInstr(IrOp opcode, ValueType type, int line)
+        : opcode(opcode), type(type), op(TOK_ERROR), index(-1), block(-1), line(line), dead(false) {
+        target[0] = target[1] = -1;
+    }
+
+    bool isTerminator() const { return opcode == IR_JUMP || opcode == IR_BRANCH || opcode == IR_RETURN; }
+};
+
+// =============================================================================
+// 2. BLOCKS, FUNCTIONS AND MODULES
+// =============================================================================
+
+// A basic block: phis first, then straight-line code, then one terminator
+struct IrBlock {
+    vector<int> code;     // Value ids in execution order
+    vector<int> preds;
+    vector<int> succs;
+};
+
+struct IrFunction {
+    Symbol name = NO_SYMBOL;
+    int line = 0;
+    vector<int> params;        // Value id of each IR_PARAM
+    vector<IrInstr> values;
+    vector<IrBlock> blocks;    // blocks[0] is the entry
+
+    bool empty() const { return blocks.empty(); }
+    size_t opCount() const;    // Live instructions
+};
+
+struct IrModule {
+    vector<IrFunction> functions;   // Parallel to Program::functions; empty if never parsed
+    IrFunction globalInit;          // Global initializers, in declaration order
+    vector<ValueType> globalTypes;
+    int campaign = -1;
+    shared_ptr<Interner> names;     // The Program's, for tactic names in dumpIr()
+
+    size_t opCount() const;
+};
+
+// =============================================================================
+// 3. BUILDING, OPTIMIZING AND RUNNING
+// =============================================================================
+
+// Lowers every parsed tactic of a resolved program, building SSA directly
+// from the AST (Braun et al., "Simple and Efficient Construction of SSA
+// Form"). The result is deliberately naive: every assignment converts,
+// every literal is a fresh constant.
+IrModule buildIr(const Program& program);
+
+// Recomputes the static type of every value from its operands. Loop phis
+// start optimistic, so a counter that starts and steps as a troop is a troop.
+void inferIrTypes(IrFunction& function);
+
+// Op counts and time for one optimization pass over the whole module
+struct IrPassReport {
+    string name;
+    size_t opsBefore;
+    size_t opsAfter;
+    double wallMs;
+};
+
+// Runs the pass pipeline (copy propagation, CSE, loop-invariant code motion,
+// induction-variable strength reduction, dead code elimination). Each pass
+// is also recorded in Telemetry as an "ir:<pass>" phase.
+vector<IrPassReport> optimizeIr(IrModule& module);
+void printIrReport(const vector<IrPassReport>& report, ostream& out);
+
+// One line per instruction, e.g. "v7 = + v4 v6 : troop"
+void dumpIr(const IrModule& module, ostream& out);
+
+// Executes 'campaign' from the IR, with the same semantics and errors as the
+// Interpreter. It does not reuse frames for tail calls, so deep 'retreat f()'
+// recursion is bounded by RunOptions like any other call. Squads are values
+// in SSA form, so every STORE_INDEX copies its squad; element stores in a
+// loop cost O(size) each here, against O(1) in the Interpreter.
+Value runIr(const IrModule& module, const RunOptions& options, RunIO& io);
+
+#endif // IR_H
@@ -0,0 +1,676 @@
+#include "ir.h"
+#include "squad.h"
+
+size_t IrFunction::opCount() const {
+    size_t count = 0;
+    for (const IrBlock& block : blocks) count += block.code.size();
+    return count;
+}
+
+size_t IrModule::opCount() const {
+    size_t count = globalInit.opCount();
+    for (const IrFunction& function : functions) count += function.opCount();
+    return count;
+}
+
+// =============================================================================
+// 1. IR BUILDER CLASS
+// =============================================================================
+
+// Lowers one tactic (or the global initializers) at a time. Locals never
+// get storage: writeVariable/readVariable track the value each frame slot
+// holds per block, and phis appear on demand where control flow merges.
+class IrBuilder {
+private:
+    const Program& program;
+    IrFunction* fn = nullptr;
+    int current = 0;              // Block receiving new code
+    int slotCount = 0;
+    vector<ValueType> slotTypes;  // Declared type of the variable now in each slot
+
+    // --- SSA construction state ---
+    vector<vector<int>> definitions;               // [block][slot] -> value, or -1
+    vector<vector<pair<int, int>>> incompletePhis; // [block] -> (slot, phi) awaiting operands
+    vector<bool> sealed;                           // All predecessors are known
+    vector<int> forwarded;                         // Removed trivial phi -> its replacement
+    int undefined = -1;
+
+    vector<int> loopExits;        // 'abort' targets, innermost last
+
+    void begin(IrFunction& function, int slots);
+    void finish();
+    void removeUnreachableBlocks();
+
+    // --- Blocks and instructions ---
+    int newBlock();
+    int emit(IrInstr instr);
+    int constant(const Value& value, int line);
+    int convert(int value, ValueType type, int line);
+    void addEdge(int from, int to);
+    void jump(int to, int line);
+    void branch(int condition, int whenTrue, int whenFalse, int line);
+    void startUnreachable();
+
+    // --- Variables ---
+    int resolve(int value) const;
+    void writeVariable(int slot, int block, int value);
+    int readVariable(int slot, int block);
+    int readVariableRecursive(int slot, int block);
+    int newPhi(int block);
+    int addPhiOperands(int slot, int phi);
+    int tryRemoveTrivialPhi(int phi);
+    void sealBlock(int block);
+    int undef();
+
+    // --- Lowering ---
+    void statement(const Stmt& stmt);
+    void loop(const Stmt& stmt);
+    int expression(const Expr& expr);
+    int logical(const Expr& expr);
+
+public:
+    explicit IrBuilder(const Program& program) : program(program) {}
+
+    void lowerFunction(const Function& function, IrFunction& out);
+    void lowerGlobals(IrFunction& out);
+};
+
+// =============================================================================
+// 2. BLOCKS AND INSTRUCTIONS
+// =============================================================================
+
+void IrBuilder::begin(IrFunction& function, int slots) {
+    fn = &function;
+    slotCount = slots;
+    slotTypes.assign(slots, VAL_NONE);
+    definitions.clear();
+    incompletePhis.clear();
+    sealed.clear();
+    forwarded.clear();
+    undefined = -1;
+    loopExits.clear();
+
+    current = newBlock();
+    sealBlock(current);
+}
+
+int IrBuilder::newBlock() {
+    fn->blocks.push_back(IrBlock());
+    definitions.push_back(vector<int>(slotCount, -1));
+    incompletePhis.push_back(vector<pair<int, int>>());
+    sealed.push_back(false);
+    return (int)fn->blocks.size() - 1;
+}
+
+int IrBuilder::emit(IrInstr instr) {
+    instr.block = current;
+    int id = (int)fn->values.size();
+    fn->values.push_back(move(instr));
+    fn->blocks[current].code.push_back(id);
+    forwarded.push_back(-1);
+    return id;
+}
+
+int IrBuilder::constant(const Value& value, int line) {
+    IrInstr instr(IR_CONST, value.type, line);
+    instr.constant = value;
+    return emit(move(instr));
+}
+
+// Every store converts; copy propagation drops the ones that cannot change the value
+int IrBuilder::convert(int value, ValueType type, int line) {
+    IrInstr instr(IR_CONVERT, type, line);
+    instr.args.push_back(value);
+    return emit(move(instr));
+}
+
+void IrBuilder::addEdge(int from, int to) {
+    fn->blocks[from].succs.push_back(to);
+    fn->blocks[to].preds.push_back(from);
+}
+
+void IrBuilder::jump(int to, int line) {
+    IrInstr instr(IR_JUMP, VAL_NONE, line);
+    instr.target[0] = to;
+    emit(move(instr));
+    addEdge(current, to);
+}
+
+void IrBuilder::branch(int condition, int whenTrue, int whenFalse, int line) {
+    IrInstr instr(IR_BRANCH, VAL_NONE, line);
+    instr.args.push_back(condition);
+    instr.target[0] = whenTrue;
+    instr.target[1] = whenFalse;
+    emit(move(instr));
+    addEdge(current, whenTrue);
+    addEdge(current, whenFalse);
+}
+
+// Code after 'retreat' or 'abort' goes to a block nothing jumps to
+void IrBuilder::startUnreachable() {
+    current = newBlock();
+    sealBlock(current);
+}
+
+// =============================================================================
+// 3. VARIABLES (SSA CONSTRUCTION)
+// =============================================================================
+
+int IrBuilder::resolve(int value) const {
+    while (forwarded[value] >= 0) value = forwarded[value];
+    return value;
+}
+
+void IrBuilder::writeVariable(int slot, int block, int value) {
+    definitions[block][slot] = value;
+}
+
+int IrBuilder::readVariable(int slot, int block) {
+    int value = definitions[block][slot];
+    if (value >= 0) return resolve(value);
+    return readVariableRecursive(slot, block);
+}
+
+int IrBuilder::readVariableRecursive(int slot, int block) {
+    const vector<int>& preds = fn->blocks[block].preds;
+    int value;
+    if (!sealed[block]) {
+        // More predecessors may still arrive (a loop header)
+        value = newPhi(block);
+        incompletePhis[block].push_back(make_pair(slot, value));
+    } else if (preds.empty()) {
+        value = undef();
+    } else if (preds.size() == 1) {
+        value = readVariable(slot, preds[0]);
+    } else {
+        // Write the phi first so a cycle through a loop finds it
+        value = newPhi(block);
+        writeVariable(slot, block, value);
+        value = addPhiOperands(slot, value);
+    }
+    writeVariable(slot, block, value);
+    return value;
+}
+
+// Phis go after the block's existing phis, ahead of its other code
+int IrBuilder::newPhi(int block) {
+    IrInstr instr(IR_PHI, VAL_NONE, 0);
+    instr.block = block;
+    int id = (int)fn->values.size();
+    fn->values.push_back(move(instr));
+    forwarded.push_back(-1);
+
+    vector<int>& code = fn->blocks[block].code;
+    size_t at = 0;
+    while (at < code.size() && fn->values[code[at]].opcode == IR_PHI) at++;
+    code.insert(code.begin() + at, id);
+    return id;
+}
+
+int IrBuilder::addPhiOperands(int slot, int phi) {
+    int block = fn->values[phi].block;
+    for (int pred : fn->blocks[block].preds) {
+        int operand = readVariable(slot, pred);
+        fn->values[phi].args.push_back(operand);
+    }
+    return tryRemoveTrivialPhi(phi);
+}
+
+// A phi whose operands are all one value (or itself) is that value
+int IrBuilder::tryRemoveTrivialPhi(int phi) {
+    int same = -1;
+    for (int operand : fn->values[phi].args) {
+        operand = resolve(operand);
+        if (operand == same || operand == phi) continue;
+        if (same >= 0) return phi;
+        same = operand;
+    }
+    if (same < 0) same = undef();
+    fn->values[phi].dead = true;
+    forwarded[phi] = same;
+    return same;
+}
+
+void IrBuilder::sealBlock(int block) {
+    // Copy first: completing a phi can read (and extend) other blocks' lists
+    vector<pair<int, int>> pending;
+    pending.swap(incompletePhis[block]);
+    sealed[block] = true;
+    for (const pair<int, int>& entry : pending) {
+        addPhiOperands(entry.first, entry.second);
+    }
+}
+
+int IrBuilder::undef() {
+    if (undefined >= 0) return undefined;
+    IrInstr instr(IR_UNDEF, VAL_NONE, 0);
+    instr.block = 0;
+    undefined = (int)fn->values.size();
+    fn->values.push_back(move(instr));
+    forwarded.push_back(-1);
+    vector<int>& code = fn->blocks[0].code;
+    code.insert(code.begin(), undefined);
+    return undefined;
+}
+
+// =============================================================================
+// 4. ENTRY POINTS AND CLEANUP
+// =============================================================================
+
+void IrBuilder::lowerFunction(const Function& function, IrFunction& out) {
+    out.name = function.name;
+    out.line = function.line;
+    begin(out, function.frameSize);
+
+    for (size_t i = 0; i < function.params.size(); i++) {
+        IrInstr instr(IR_PARAM, function.params[i].type, function.line);
+        instr.index = (int)i;
+        int param = emit(move(instr));
+        out.params.push_back(param);
+        slotTypes[i] = function.params[i].type;
+        writeVariable((int)i, current, param);
+    }
+
+    // The body block shares the parameters' scope
+    for (const unique_ptr<Stmt>& stmt : function.body->statements) {
+        statement(*stmt);
+    }
+
+    IrInstr ret(IR_RETURN, VAL_NONE, function.line);
+    emit(move(ret));
+    finish();
+}
+
+void IrBuilder::lowerGlobals(IrFunction& out) {
+    begin(out, 0);
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        int value = global->expr ? convert(expression(*global->expr), global->varType, global->line)
+                                 : constant(Value::defaultFor(global->varType), global->line);
+        IrInstr store(IR_STORE_GLOBAL, VAL_NONE, global->line);
+        store.index = global->slot;
+        store.args.push_back(value);
+        emit(move(store));
+    }
+    IrInstr ret(IR_RETURN, VAL_NONE, 0);
+    emit(move(ret));
+    finish();
+}
+
+// Points every operand past removed phis and drops what cannot run
+void IrBuilder::finish() {
+    for (IrInstr& instr : fn->values) {
+        for (int& arg : instr.args) arg = resolve(arg);
+    }
+    for (IrBlock& block : fn->blocks) {
+        vector<int> live;
+        for (int id : block.code) {
+            if (!fn->values[id].dead) live.push_back(id);
+        }
+        block.code.swap(live);
+    }
+    removeUnreachableBlocks();
+    fn = nullptr;
+}
+
+void IrBuilder::removeUnreachableBlocks() {
+    vector<IrBlock>& blocks = fn->blocks;
+    vector<bool> reachable(blocks.size(), false);
+    vector<int> work(1, 0);
+    reachable[0] = true;
+    while (!work.empty()) {
+        int block = work.back();
+        work.pop_back();
+        for (int succ : blocks[block].succs) {
+            if (!reachable[succ]) {
+                reachable[succ] = true;
+                work.push_back(succ);
+            }
+        }
+    }
+
+    // Cut edges out of dead blocks, with the matching phi operands
+    for (size_t block = 0; block < blocks.size(); block++) {
+        if (reachable[block]) continue;
+        for (int succ : blocks[block].succs) {
+            vector<int>& preds = blocks[succ].preds;
+            for (size_t k = 0; k < preds.size(); k++) {
+                if (preds[k] != (int)block) continue;
+                preds.erase(preds.begin() + k);
+                for (int id : blocks[succ].code) {
+                    IrInstr& phi = fn->values[id];
+                    if (phi.opcode != IR_PHI) break;
+                    phi.args.erase(phi.args.begin() + k);
+                }
+                break;
+            }
+        }
+        for (int id : blocks[block].code) fn->values[id].dead = true;
+    }
+
+    // Renumber the survivors
+    vector<int> renumber(blocks.size(), -1);
+    vector<IrBlock> kept;
+    for (size_t block = 0; block < blocks.size(); block++) {
+        if (!reachable[block]) continue;
+        renumber[block] = (int)kept.size();
+        kept.push_back(move(blocks[block]));
+    }
+    for (size_t block = 0; block < kept.size(); block++) {
+        for (int& pred : kept[block].preds) pred = renumber[pred];
+        for (int& succ : kept[block].succs) succ = renumber[succ];
+        for (int id : kept[block].code) {
+            IrInstr& instr = fn->values[id];
+            instr.block = (int)block;
+            if (instr.target[0] >= 0) instr.target[0] = renumber[instr.target[0]];
+            if (instr.target[1] >= 0) instr.target[1] = renumber[instr.target[1]];
+        }
+    }
+    blocks.swap(kept);
+}
+
+// =============================================================================
+// 5. STATEMENTS
+// =============================================================================
+
+void IrBuilder::statement(const Stmt& stmt) {
+    switch (stmt.kind) {
+        case STMT_BLOCK:
+            for (const unique_ptr<Stmt>& inner : stmt.statements) statement(*inner);
+            break;
+
+        case STMT_VAR: {
+            int value = stmt.expr ? convert(expression(*stmt.expr), stmt.varType, stmt.line)
+                                  : constant(Value::defaultFor(stmt.varType), stmt.line);
+            slotTypes[stmt.slot] = stmt.varType;
+            writeVariable(stmt.slot, current, value);
+            break;
+        }
+
+        case STMT_IF: {
+            int condition = expression(*stmt.expr);
+            int thenBlock = newBlock();
+            int elseBlock = stmt.elseBranch ? newBlock() : -1;
+            int merge = newBlock();
+            branch(condition, thenBlock, stmt.elseBranch ? elseBlock : merge, stmt.line);
+
+            sealBlock(thenBlock);
+            current = thenBlock;
+            statement(*stmt.body);
+            jump(merge, stmt.line);
+
+            if (stmt.elseBranch) {
+                sealBlock(elseBlock);
+                current = elseBlock;
+                statement(*stmt.elseBranch);
+                jump(merge, stmt.line);
+            }
+
+            sealBlock(merge);
+            current = merge;
+            break;
+        }
+
+        case STMT_WHILE:
+        case STMT_FOR:
+            loop(stmt);
+            break;
+
+        case STMT_BRIEF: {
+            IrInstr instr(IR_BRIEF, VAL_NONE, stmt.line);
+            instr.args.push_back(expression(*stmt.expr));
+            emit(move(instr));
+            break;
+        }
+
+        case STMT_INTEL: {
+            IrInstr instr(IR_INTEL, stmt.varType, stmt.line);
+            int value = emit(move(instr));
+            if (stmt.global) {
+                IrInstr store(IR_STORE_GLOBAL, VAL_NONE, stmt.line);
+                store.index = stmt.slot;
+                store.args.push_back(value);
+                emit(move(store));
+            } else {
+                writeVariable(stmt.slot, current, value);
+            }
+            break;
+        }
+
+        case STMT_RETREAT: {
+            IrInstr instr(IR_RETURN, VAL_NONE, stmt.line);
+            if (stmt.expr) instr.args.push_back(expression(*stmt.expr));
+            emit(move(instr));
+            startUnreachable();
+            break;
+        }
+
+        case STMT_ABORT:
+            jump(loopExits.back(), stmt.line);
+            startUnreachable();
+            break;
+
+        case STMT_EXPR:
+            expression(*stmt.expr);
+            break;
+    }
+}
+
+// maintain (cond) body            deploy (init; cond; update) body
+//
+//   preheader -> header: cond ? body : exit
+//   body ... -> latch: update; jump header
+//
+// The header is sealed once the latch's back edge exists, and the exit
+// once every 'abort' inside the body has jumped to it. A 'deploy parallel'
+// lowers the same way, so the IR executor runs its iterations in order.
+void IrBuilder::loop(const Stmt& stmt) {
+    if (stmt.kind == STMT_FOR && stmt.init) statement(*stmt.init);
+
+    int header = newBlock();
+    jump(header, stmt.line);
+    current = header;
+
+    int body = newBlock();
+    int exit = newBlock();
+    if (stmt.expr) {
+        branch(expression(*stmt.expr), body, exit, stmt.line);
+    } else {
+        jump(body, stmt.line);
+    }
+    sealBlock(body);
+
+    loopExits.push_back(exit);
+    current = body;
+    statement(*stmt.body);
+    if (stmt.kind == STMT_FOR && stmt.update) expression(*stmt.update);
+    jump(header, stmt.line);
+    loopExits.pop_back();
+
+    sealBlock(header);
+    sealBlock(exit);
+    current = exit;
+}
+
+// =============================================================================
+// 6. EXPRESSIONS
+// =============================================================================
+
+int IrBuilder::expression(const Expr& expr) {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            return constant(expr.literal, expr.line);
+
+        case EXPR_VARIABLE: {
+            if (!expr.global) return readVariable(expr.slot, current);
+            IrInstr instr(IR_LOAD_GLOBAL, program.globals[expr.slot]->varType, expr.line);
+            instr.index = expr.slot;
+            return emit(move(instr));
+        }
+
+        case EXPR_ASSIGN: {
+            ValueType type = expr.global ? program.globals[expr.slot]->varType : slotTypes[expr.slot];
+            int value = convert(expression(*expr.right), type, expr.line);
+            if (expr.global) {
+                IrInstr store(IR_STORE_GLOBAL, VAL_NONE, expr.line);
+                store.index = expr.slot;
+                store.args.push_back(value);
+                emit(move(store));
+            } else {
+                writeVariable(expr.slot, current, value);
+            }
+            return value;
+        }
+
+        case EXPR_CALL: {
+            const Function& callee = program.functions[expr.function];
+            IrInstr instr(IR_CALL, VAL_NONE, expr.line);
+            instr.index = expr.function;
+            for (size_t i = 0; i < expr.args.size(); i++) {
+                int arg = expression(*expr.args[i]);
+                instr.args.push_back(convert(arg, callee.params[i].type, expr.args[i]->line));
+            }
+            return emit(move(instr));
+        }
+
+        case EXPR_UNARY: {
+            int operand = expression(*expr.left);
+            IrInstr instr(IR_UNARY, expr.op == TOK_NOT ? VAL_STATUS : VAL_NONE, expr.line);
+            instr.op = expr.op;
+            instr.args.push_back(operand);
+            return emit(move(instr));
+        }
+
+        case EXPR_BINARY: {
+            if (expr.op == TOK_AND || expr.op == TOK_OR) return logical(expr);
+            int left = expression(*expr.left);
+            int right = expression(*expr.right);
+            IrInstr instr(IR_BINARY, VAL_NONE, expr.line);
+            instr.op = expr.op;
+            instr.args.push_back(left);
+            instr.args.push_back(right);
+            return emit(move(instr));
+        }
+
+        case EXPR_INLINE:
+            for (size_t i = 0; i < expr.args.size(); i++) {
+                int slot = expr.slot + (int)i;
+                int arg = convert(expression(*expr.args[i]), expr.paramTypes[i], expr.args[i]->line);
+                slotTypes[slot] = expr.paramTypes[i];
+                writeVariable(slot, current, arg);
+            }
+            return expression(*expr.left);
+
+        case EXPR_SQUAD: {
+            IrInstr instr(IR_SQUAD, VAL_NONE, expr.line);
+            for (const unique_ptr<Expr>& element : expr.args) instr.args.push_back(expression(*element));
+            return emit(move(instr));
+        }
+
+        // Index first, as the Interpreter evaluates it
+        case EXPR_INDEX: {
+            int index = expression(*expr.right);
+            int squad = expression(*expr.left);
+            IrInstr instr(IR_INDEX, VAL_NONE, expr.line);
+            instr.args.push_back(squad);
+            instr.args.push_back(index);
+            return emit(move(instr));
+        }
+
+        // s[i] = e   ->   s' = STORE_INDEX s i e, then s = s'. The store
+        // checks and converts e, so the CONVERT after it cannot throw.
+        case EXPR_SET_INDEX: {
+            int index = expression(*expr.left);
+            int value = expression(*expr.right);
+            ValueType type = expr.global ? program.globals[expr.slot]->varType : slotTypes[expr.slot];
+            int squad;
+            if (expr.global) {
+                IrInstr load(IR_LOAD_GLOBAL, type, expr.line);
+                load.index = expr.slot;
+                squad = emit(move(load));
+            } else {
+                squad = readVariable(expr.slot, current);
+            }
+            IrInstr instr(IR_STORE_INDEX, type, expr.line);
+            instr.args.push_back(squad);
+            instr.args.push_back(index);
+            instr.args.push_back(value);
+            int updated = emit(move(instr));
+            if (expr.global) {
+                IrInstr store(IR_STORE_GLOBAL, VAL_NONE, expr.line);
+                store.index = expr.slot;
+                store.args.push_back(updated);
+                emit(move(store));
+            } else {
+                writeVariable(expr.slot, current, updated);
+            }
+            return convert(value, type == VAL_TROOP_SQUAD ? VAL_TROOP : VAL_AMMO, expr.line);
+        }
+
+        case EXPR_BUILTIN: {
+            IrInstr instr(IR_BUILTIN, VAL_NONE, expr.line);
+            instr.index = expr.function;
+            for (const unique_ptr<Expr>& arg : expr.args) instr.args.push_back(expression(*arg));
+            return emit(move(instr));
+        }
+    }
+    return undef();
+}
+
+// a && b   ->   a ? (b tested as a status) : false, merged by a phi
+// a || b   ->   a ? true : (b tested as a status)
+int IrBuilder::logical(const Expr& expr) {
+    bool isAnd = expr.op == TOK_AND;
+    int left = expression(*expr.left);
+    int shortValue = constant(Value::makeStatus(!isAnd), expr.line);
+    int shortBlock = current;
+
+    int right = newBlock();
+    int merge = newBlock();
+    if (isAnd) {
+        branch(left, right, merge, expr.line);
+    } else {
+        branch(left, merge, right, expr.line);
+    }
+
+    sealBlock(right);
+    current = right;
+    IrInstr test(IR_TEST, VAL_STATUS, expr.line);
+    test.args.push_back(expression(*expr.right));
+    int rightValue = emit(move(test));
+    jump(merge, expr.line);
+
+    sealBlock(merge);
+    current = merge;
+    int phi = newPhi(merge);
+    const vector<int>& preds = fn->blocks[merge].preds;
+    for (int pred : preds) {
+        fn->values[phi].args.push_back(pred == shortBlock ? shortValue : rightValue);
+    }
+    return phi;
+}
+
+// =============================================================================
+// 7. MODULE
+// =============================================================================
+
+IrModule buildIr(const Program& program) {
+    IrModule module;
+    module.campaign = program.campaign;
+    module.names = program.names;
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        module.globalTypes.push_back(global->varType);
+    }
+
+    IrBuilder builder(program);
+    builder.lowerGlobals(module.globalInit);
+    inferIrTypes(module.globalInit);
+
+    module.functions.resize(program.functions.size());
+    for (size_t i = 0; i < program.functions.size(); i++) {
+        const Function& function = program.functions[i];
+        if (!function.body || !function.resolved) continue;
+        builder.lowerFunction(function, module.functions[i]);
+        inferIrTypes(module.functions[i]);
+    }
+    return module;
+}
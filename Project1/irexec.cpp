@@ -0,0 +1,237 @@
+#include "ir.h"
+#include "squad.h"
+#include <climits>
+
+// =============================================================================
+// 1. IR EXECUTOR CLASS
+// =============================================================================
+
+// Runs the IR directly. A call gets one register per value id, carved out
+// of the same kind of FrameStack the Interpreter uses; entering a block
+// assigns its phis from the edge that was taken. The step budget counts
+// blocks entered, which every loop iteration and call does at least once.
+class IrExecutor {
+private:
+    const IrModule& module;
+    FrameStack registers;
+    vector<Value> globals;
+    vector<Value> phiValues;   // Phi inputs, read before any phi is written
+
+    const char* nativeStackBase = nullptr;
+    size_t maxNativeStack;
+
+    long long stepBudget;
+    long long stepsLeft;
+    MemoryAccount account;
+
+    RunIO& io;
+
+    Value execute(const IrFunction& fn, size_t base);
+    Value call(const IrInstr& instr, size_t callerBase);
+    [[noreturn]] void nativeStackError(int line);
+    [[noreturn]] void stepLimitError(int line);
+
+public:
+    IrExecutor(const IrModule& module, const RunOptions& options, RunIO& io)
+        : module(module), registers(options.stackSlots, options.maxCallDepth),
+          maxNativeStack(options.maxNativeStack), stepBudget(options.maxSteps > 0 ? options.maxSteps : LLONG_MAX),
+          stepsLeft(stepBudget), account(options.maxMemory), io(io) {}
+
+    Value run();
+};
+
+// =============================================================================
+// 2. CALLS
+// =============================================================================
+
+void IrExecutor::nativeStackError(int line) {
+    throw RuntimeError(line, "Recursion too deep for the native stack (" + to_string(maxNativeStack / 1024) +
+                             " KB, depth " + to_string(registers.getDepth()) + ").");
+}
+
+void IrExecutor::stepLimitError(int line) {
+    throw LimitError(line, "Step limit exceeded (" + to_string(stepBudget) + " blocks).");
+}
+
+Value IrExecutor::run() {
+    char marker;
+    nativeStackBase = &marker;
+    AccountScope scope(&account);
+    stepsLeft = stepBudget;
+    registers.reset();
+
+    globals.assign(module.globalTypes.size(), Value());
+    size_t base = registers.push((int)module.globalInit.values.size(), 0);
+    execute(module.globalInit, base);
+    registers.pop(base);
+
+    if (module.campaign < 0) {
+        throw RuntimeError(0, "No 'tactic campaign()' to run.");
+    }
+    const IrFunction& campaign = module.functions[module.campaign];
+    if (!campaign.params.empty()) {
+        throw RuntimeError(campaign.line, "'campaign' must not take parameters.");
+    }
+    base = registers.push((int)campaign.values.size(), campaign.line);
+    Value result = execute(campaign, base);
+    registers.pop(base);
+    return result;
+}
+
+Value IrExecutor::call(const IrInstr& instr, size_t callerBase) {
+    char marker;
+    if ((size_t)(nativeStackBase - &marker) > maxNativeStack) {
+        nativeStackError(instr.line);
+    }
+
+    const IrFunction& callee = module.functions[instr.index];
+    size_t base = registers.push((int)callee.values.size(), instr.line);
+    for (size_t i = 0; i < instr.args.size(); i++) {
+        registers[base + callee.params[i]] = registers[callerBase + instr.args[i]];
+    }
+    Value result = execute(callee, base);
+    registers.pop(base);
+    return result;
+}
+
+// =============================================================================
+// 3. INSTRUCTIONS
+// =============================================================================
+
+Value IrExecutor::execute(const IrFunction& fn, size_t base) {
+    int block = 0;
+    int from = -1;
+    while (true) {
+        const IrBlock& current = fn.blocks[block];
+        const vector<int>& code = current.code;
+        size_t i = 0;
+        if (--stepsLeft < 0) stepLimitError(fn.line);
+
+        // Phis read the operand for the edge we came in on, all at once
+        if (from >= 0) {
+            size_t edge = 0;
+            while (current.preds[edge] != from) edge++;
+            while (i < code.size() && fn.values[code[i]].opcode == IR_PHI) {
+                phiValues.push_back(registers[base + fn.values[code[i]].args[edge]]);
+                i++;
+            }
+            for (size_t p = 0; p < i; p++) registers[base + code[p]] = move(phiValues[p]);
+            phiValues.clear();
+        }
+
+        for (; i < code.size(); i++) {
+            int id = code[i];
+            const IrInstr& instr = fn.values[id];
+            Value& result = registers[base + id];
+            switch (instr.opcode) {
+                case IR_CONST:
+                    result = instr.constant;
+                    break;
+
+                case IR_PARAM:
+                case IR_PHI:
+                    break;
+
+                case IR_UNDEF:
+                    result = Value();
+                    break;
+
+                case IR_CONVERT: {
+                    const Value& value = registers[base + instr.args[0]];
+                    result = value.type == instr.type ? value : Interpreter::convert(value, instr.type, instr.line);
+                    break;
+                }
+
+                case IR_UNARY: {
+                    const Value& operand = registers[base + instr.args[0]];
+                    result = instr.op == TOK_NOT ? Value::makeStatus(!Interpreter::truthy(operand, instr.line))
+                                                 : Interpreter::negate(operand, instr.line);
+                    break;
+                }
+
+                case IR_TEST:
+                    result = Value::makeStatus(Interpreter::truthy(registers[base + instr.args[0]], instr.line));
+                    break;
+
+                case IR_BINARY:
+                    result = Interpreter::applyBinary(instr.op, registers[base + instr.args[0]],
+                                                      registers[base + instr.args[1]], instr.line);
+                    break;
+
+                case IR_ROTATE: {
+                    long long next = (long long)registers[base + instr.args[0]].troop + registers[base + instr.args[1]].troop;
+                    int modulus = registers[base + instr.args[2]].troop;
+                    if (next >= modulus) next -= modulus;
+                    result = Value::makeTroop((int)next);
+                    break;
+                }
+
+                case IR_LOAD_GLOBAL:
+                    result = globals[instr.index];
+                    break;
+
+                case IR_STORE_GLOBAL:
+                    globals[instr.index] = registers[base + instr.args[0]];
+                    break;
+
+                case IR_CALL: {
+                    Value value = call(instr, base);
+                    registers[base + id] = move(value);
+                    break;
+                }
+
+                case IR_BRIEF:
+                    io.brief(Interpreter::format(registers[base + instr.args[0]], instr.line));
+                    break;
+
+                case IR_INTEL:
+                    result = Interpreter::readIntelValue(io, instr.type, instr.line);
+                    break;
+
+                case IR_SQUAD: {
+                    vector<Value> elements;
+                    for (int arg : instr.args) elements.push_back(registers[base + arg]);
+                    result = makeSquadLiteral(elements, instr.line);
+                    break;
+                }
+
+                case IR_INDEX:
+                    result = squadElement(registers[base + instr.args[0]], registers[base + instr.args[1]], instr.line);
+                    break;
+
+                case IR_STORE_INDEX: {
+                    Value squad = registers[base + instr.args[0]];
+                    squadStore(squad, registers[base + instr.args[1]], registers[base + instr.args[2]], instr.line);
+                    result = move(squad);
+                    break;
+                }
+
+                case IR_BUILTIN: {
+                    Value args[2];
+                    for (size_t a = 0; a < instr.args.size(); a++) args[a] = registers[base + instr.args[a]];
+                    result = callBuiltin((Builtin)instr.index, args, instr.line);
+                    break;
+                }
+
+                case IR_JUMP:
+                    from = block;
+                    block = instr.target[0];
+                    break;
+
+                case IR_BRANCH:
+                    from = block;
+                    block = Interpreter::truthy(registers[base + instr.args[0]], instr.line) ? instr.target[0]
+                                                                                           : instr.target[1];
+                    break;
+
+                case IR_RETURN:
+                    return instr.args.empty() ? Value() : registers[base + instr.args[0]];
+            }
+        }
+    }
+}
+
+Value runIr(const IrModule& module, const RunOptions& options, RunIO& io) {
+    IrExecutor executor(module, options, io);
+    return executor.run();
+}
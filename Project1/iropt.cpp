@@ -0,0 +1,824 @@
+#include "ir.h"
+#include "astdump.h"
+#include "squad.h"
+#include "telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+
+// =============================================================================
+// 1. STATIC TYPES
+// =============================================================================
+
+static bool isNumeric(ValueType type) {
+    return type == VAL_TROOP || type == VAL_AMMO;
+}
+
+static bool isSquad(ValueType type) {
+    return type == VAL_TROOP_SQUAD || type == VAL_AMMO_SQUAD;
+}
+
+static bool isComparison(TokenType op) {
+    return op == TOK_EQUAL || op == TOK_NOT_EQUAL || op == TOK_LESS || op == TOK_GREATER ||
+           op == TOK_LESS_EQUAL || op == TOK_GREATER_EQUAL;
+}
+
+// Mirrors Interpreter::applyBinary: the type of the result when it does not
+// throw. A comparison gives a status only if neither side can be a squad.
+static ValueType binaryType(TokenType op, ValueType a, ValueType b) {
+    if (op == TOK_PLUS && (a == VAL_CODENAME || b == VAL_CODENAME)) return VAL_CODENAME;
+    if (isSquad(a) || isSquad(b)) {
+        if (isComparison(op)) return VAL_TROOP_SQUAD;
+        bool ammo = a == VAL_AMMO || a == VAL_AMMO_SQUAD || b == VAL_AMMO || b == VAL_AMMO_SQUAD;
+        return ammo ? VAL_AMMO_SQUAD : VAL_TROOP_SQUAD;
+    }
+    if (a == VAL_NONE || b == VAL_NONE) return VAL_NONE;
+    if (isComparison(op)) return VAL_STATUS;
+    if (a == VAL_TROOP && b == VAL_TROOP) return VAL_TROOP;
+    if (isNumeric(a) && isNumeric(b)) return VAL_AMMO;
+    return VAL_NONE;
+}
+
+// The type of a squad operation from its operands' types, or VAL_NONE
+static ValueType squadOpType(const IrInstr& instr, const vector<int>& state) {
+    switch (instr.opcode) {
+        case IR_SQUAD: {
+            ValueType type = VAL_TROOP_SQUAD;
+            for (int arg : instr.args) {
+                if (state[arg] == VAL_AMMO) type = VAL_AMMO_SQUAD;
+                else if (state[arg] != VAL_TROOP) return VAL_NONE;
+            }
+            return type;
+        }
+        case IR_INDEX:
+            if (state[instr.args[0]] == VAL_TROOP_SQUAD) return VAL_TROOP;
+            if (state[instr.args[0]] == VAL_AMMO_SQUAD) return VAL_AMMO;
+            return VAL_NONE;
+        default:   // IR_BUILTIN
+            switch ((Builtin)instr.index) {
+                case BUILTIN_SIZE:  return VAL_TROOP;
+                case BUILTIN_RANGE: return VAL_TROOP_SQUAD;
+                case BUILTIN_FILL:
+                    if (state[instr.args[1]] == VAL_TROOP) return VAL_TROOP_SQUAD;
+                    if (state[instr.args[1]] == VAL_AMMO) return VAL_AMMO_SQUAD;
+                    return VAL_NONE;
+                default:
+                    if (state[instr.args[0]] == VAL_TROOP_SQUAD) return VAL_TROOP;
+                    if (state[instr.args[0]] == VAL_AMMO_SQUAD) return VAL_AMMO;
+                    return VAL_NONE;
+            }
+    }
+}
+
+// Optimistic fixpoint over the derived types; 'unset' means no operand
+// has been seen yet, which lets a loop phi take its entry value's type.
+void inferIrTypes(IrFunction& fn) {
+    const int UNSET = -1;
+    vector<int> state(fn.values.size(), UNSET);
+    for (const IrBlock& block : fn.blocks) {
+        for (int id : block.code) {
+            const IrInstr& instr = fn.values[id];
+            bool derived = instr.opcode == IR_PHI || instr.opcode == IR_BINARY ||
+                           (instr.opcode == IR_UNARY && instr.op == TOK_MINUS) || instr.opcode == IR_SQUAD ||
+                           instr.opcode == IR_INDEX || instr.opcode == IR_BUILTIN;
+            if (!derived) state[id] = instr.type;
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const IrBlock& block : fn.blocks) {
+            for (int id : block.code) {
+                const IrInstr& instr = fn.values[id];
+                int type = state[id];
+                if (instr.opcode == IR_PHI) {
+                    for (int arg : instr.args) {
+                        if (state[arg] == UNSET) continue;
+                        if (type == UNSET) type = state[arg];
+                        else if (type != state[arg]) type = VAL_NONE;
+                    }
+                } else if (instr.opcode == IR_BINARY) {
+                    int a = state[instr.args[0]];
+                    int b = state[instr.args[1]];
+                    if (a != UNSET && b != UNSET) {
+                        type = binaryType(instr.op, (ValueType)a, (ValueType)b);
+                    }
+                } else if (instr.opcode == IR_UNARY && instr.op == TOK_MINUS) {
+                    int a = state[instr.args[0]];
+                    if (a != UNSET) type = isNumeric((ValueType)a) || isSquad((ValueType)a) ? a : VAL_NONE;
+                } else if (instr.opcode == IR_SQUAD || instr.opcode == IR_INDEX || instr.opcode == IR_BUILTIN) {
+                    bool ready = true;
+                    for (int arg : instr.args) ready = ready && state[arg] != UNSET;
+                    if (ready) type = squadOpType(instr, state);
+                }
+                if (type != state[id]) {
+                    state[id] = type;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (const IrBlock& block : fn.blocks) {
+        for (int id : block.code) {
+            fn.values[id].type = state[id] == UNSET ? VAL_NONE : (ValueType)state[id];
+        }
+    }
+}
+
+// =============================================================================
+// 2. ANALYSES
+// =============================================================================
+
+static bool isConstant(const IrFunction& fn, int id, ValueType type) {
+    const IrInstr& instr = fn.values[id];
+    return instr.opcode == IR_CONST && instr.type == type;
+}
+
+// Whether evaluating a side-effect-free instruction can raise a RuntimeError.
+// Such instructions are neither moved nor deleted, so errors stay put.
+static bool mayThrow(const IrFunction& fn, const IrInstr& instr) {
+    switch (instr.opcode) {
+        case IR_CONST:
+        case IR_PARAM:
+        case IR_UNDEF:
+        case IR_PHI:
+        case IR_ROTATE:
+            return false;
+
+        case IR_SQUAD:
+            for (int arg : instr.args) {
+                if (!isNumeric(fn.values[arg].type)) return true;
+            }
+            return false;
+
+        case IR_CONVERT: {
+            ValueType from = fn.values[instr.args[0]].type;
+            if (from == instr.type) return false;
+            if (instr.type == VAL_STATUS) return !isNumeric(from);
+            if (instr.type == VAL_TROOP) return from != VAL_STATUS;   // An ammo may not fit
+            if (instr.type == VAL_AMMO) return !(from == VAL_TROOP || from == VAL_STATUS);
+            return true;
+        }
+
+        case IR_TEST:
+        case IR_UNARY: {
+            ValueType type = fn.values[instr.args[0]].type;
+            if (instr.opcode == IR_UNARY && instr.op == TOK_MINUS) return !isNumeric(type);
+            return !(isNumeric(type) || type == VAL_STATUS);
+        }
+
+        case IR_BINARY: {
+            ValueType a = fn.values[instr.args[0]].type;
+            ValueType b = fn.values[instr.args[1]].type;
+            if (a == VAL_NONE || b == VAL_NONE) return true;
+            if (a == VAL_TROOP && b == VAL_TROOP && (instr.op == TOK_DIVIDE || instr.op == TOK_MODULO)) {
+                const IrInstr& divisor = fn.values[instr.args[1]];
+                return !(divisor.opcode == IR_CONST && divisor.constant.troop != 0);
+            }
+            if (instr.op == TOK_PLUS && (a == VAL_CODENAME || b == VAL_CODENAME)) return false;
+            if (isNumeric(a) && isNumeric(b)) return false;
+            if (a == VAL_CODENAME && b == VAL_CODENAME) return !isComparison(instr.op);
+            if (a == VAL_STATUS && b == VAL_STATUS) return instr.op != TOK_EQUAL && instr.op != TOK_NOT_EQUAL;
+            return true;
+        }
+
+        default:
+            return true;
+    }
+}
+
+static bool isPure(IrOp opcode) {
+    switch (opcode) {
+        case IR_CONST:
+        case IR_PARAM:
+        case IR_UNDEF:
+        case IR_PHI:
+        case IR_CONVERT:
+        case IR_UNARY:
+        case IR_TEST:
+        case IR_BINARY:
+        case IR_ROTATE:
+        case IR_SQUAD:        // Squads are values here; STORE_INDEX makes a new one
+        case IR_INDEX:
+        case IR_STORE_INDEX:
+        case IR_BUILTIN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Immediate dominators by the iterative algorithm of Cooper, Harvey and
+// Kennedy. Every block is reachable, since the builder drops the rest.
+struct Dominators {
+    vector<int> idom;
+    vector<int> rpo;     // Blocks in reverse postorder
+    vector<int> order;   // Block -> position in rpo
+
+    explicit Dominators(const IrFunction& fn);
+    bool dominates(int a, int b) const;
+};
+
+Dominators::Dominators(const IrFunction& fn) {
+    size_t count = fn.blocks.size();
+    vector<int> postorder;
+    vector<bool> visited(count, false);
+    vector<pair<int, size_t>> stack(1, make_pair(0, (size_t)0));
+    visited[0] = true;
+    while (!stack.empty()) {
+        int block = stack.back().first;
+        size_t& next = stack.back().second;
+        if (next < fn.blocks[block].succs.size()) {
+            int succ = fn.blocks[block].succs[next++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back(make_pair(succ, (size_t)0));
+            }
+        } else {
+            postorder.push_back(block);
+            stack.pop_back();
+        }
+    }
+    rpo.assign(postorder.rbegin(), postorder.rend());
+    order.assign(count, -1);
+    for (size_t i = 0; i < rpo.size(); i++) order[rpo[i]] = (int)i;
+
+    idom.assign(count, -1);
+    idom[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); i++) {
+            int block = rpo[i];
+            int chosen = -1;
+            for (int pred : fn.blocks[block].preds) {
+                if (idom[pred] < 0) continue;
+                if (chosen < 0) {
+                    chosen = pred;
+                    continue;
+                }
+                int a = pred;
+                int b = chosen;
+                while (a != b) {
+                    while (order[a] > order[b]) a = idom[a];
+                    while (order[b] > order[a]) b = idom[b];
+                }
+                chosen = a;
+            }
+            if (idom[block] != chosen) {
+                idom[block] = chosen;
+                changed = true;
+            }
+        }
+    }
+}
+
+bool Dominators::dominates(int a, int b) const {
+    while (b != a && b != 0) b = idom[b];
+    return b == a;
+}
+
+// A natural loop: the header, its body, and where hoisted code can go
+struct Loop {
+    int header;
+    int preheader = -1;       // Sole outside predecessor ending in a jump, or -1
+    vector<int> latches;      // Sources of back edges
+    vector<bool> contains;    // Block -> in the loop
+    size_t size = 0;
+};
+
+// Loops innermost first, so code hoisted out of an inner loop can keep
+// moving out of the enclosing one
+static vector<Loop> findLoops(const IrFunction& fn, const Dominators& dom) {
+    vector<Loop> loops;
+    for (int header : dom.rpo) {
+        Loop loop;
+        loop.header = header;
+        loop.contains.assign(fn.blocks.size(), false);
+        for (int pred : fn.blocks[header].preds) {
+            if (dom.dominates(header, pred)) loop.latches.push_back(pred);
+        }
+        if (loop.latches.empty()) continue;
+
+        loop.contains[header] = true;
+        vector<int> work(loop.latches);
+        while (!work.empty()) {
+            int block = work.back();
+            work.pop_back();
+            if (loop.contains[block]) continue;
+            loop.contains[block] = true;
+            work.insert(work.end(), fn.blocks[block].preds.begin(), fn.blocks[block].preds.end());
+        }
+        for (bool in : loop.contains) loop.size += in;
+
+        int outside = -1;
+        int outsideCount = 0;
+        for (int pred : fn.blocks[header].preds) {
+            if (loop.contains[pred]) continue;
+            outside = pred;
+            outsideCount++;
+        }
+        if (outsideCount == 1 && fn.blocks[outside].succs.size() == 1) loop.preheader = outside;
+        loops.push_back(move(loop));
+    }
+    stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) { return a.size < b.size; });
+    return loops;
+}
+
+// =============================================================================
+// 3. REWRITING HELPERS
+// =============================================================================
+
+static int resolve(const vector<int>& forward, int id) {
+    while (forward[id] >= 0) id = forward[id];
+    return id;
+}
+
+// Points every use of a forwarded value at its replacement, then drops
+// the forwarded instructions
+static void applyForwarding(IrFunction& fn, const vector<int>& forward) {
+    for (IrBlock& block : fn.blocks) {
+        vector<int> kept;
+        kept.reserve(block.code.size());
+        for (int id : block.code) {
+            if (forward[id] >= 0) {
+                fn.values[id].dead = true;
+                continue;
+            }
+            for (int& arg : fn.values[id].args) arg = resolve(forward, arg);
+            kept.push_back(id);
+        }
+        block.code.swap(kept);
+    }
+}
+
+static int addInstr(IrFunction& fn, IrInstr instr) {
+    fn.values.push_back(move(instr));
+    return (int)fn.values.size() - 1;
+}
+
+// New constants go to the top of the entry block, which dominates every use
+static int addConstant(IrFunction& fn, const Value& value) {
+    IrInstr instr(IR_CONST, value.type, 0);
+    instr.constant = value;
+    instr.block = 0;
+    int id = addInstr(fn, move(instr));
+    fn.blocks[0].code.insert(fn.blocks[0].code.begin(), id);
+    return id;
+}
+
+static void insertAfter(IrFunction& fn, int anchor, int id) {
+    vector<int>& code = fn.blocks[fn.values[anchor].block].code;
+    code.insert(find(code.begin(), code.end(), anchor) + 1, id);
+    fn.values[id].block = fn.values[anchor].block;
+}
+
+// =============================================================================
+// 4. PASSES
+// =============================================================================
+
+// --- Copy Propagation ---
+// A conversion to the type its operand already has is a copy, and so is a
+// phi whose operands are all one value. Uses of either read the source.
+static void copyPropagation(IrFunction& fn) {
+    inferIrTypes(fn);
+    vector<int> forward(fn.values.size(), -1);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const IrBlock& block : fn.blocks) {
+            for (int id : block.code) {
+                if (forward[id] >= 0) continue;
+                const IrInstr& instr = fn.values[id];
+                int source = -1;
+                if (instr.opcode == IR_CONVERT) {
+                    int operand = resolve(forward, instr.args[0]);
+                    if (fn.values[operand].type == instr.type) source = operand;
+                } else if (instr.opcode == IR_PHI) {
+                    for (int arg : instr.args) {
+                        arg = resolve(forward, arg);
+                        if (arg == id || arg == source) continue;
+                        if (source >= 0) {
+                            source = -1;
+                            break;
+                        }
+                        source = arg;
+                    }
+                }
+                if (source >= 0) {
+                    forward[id] = source;
+                    changed = true;
+                }
+            }
+        }
+    }
+    applyForwarding(fn, forward);
+}
+
+// --- Common Subexpression Elimination ---
+// Dominator-scoped value numbering: a pure instruction equal to one in a
+// dominating block reuses that value. Throwing instructions qualify too,
+// since the dominating copy would have thrown first.
+static string valueKey(const IrInstr& instr, const vector<int>& forward) {
+    string key = to_string(instr.opcode) + ":" + to_string(instr.type) + ":" + to_string(instr.op) +
+                 ":#" + to_string(instr.index);
+    if (instr.opcode == IR_PHI) key += ":b" + to_string(instr.block);
+    for (int arg : instr.args) key += ":" + to_string(resolve(forward, arg));
+    if (instr.opcode == IR_CONST) {
+        const Value& value = instr.constant;
+        switch (value.type) {
+            case VAL_TROOP:    key += "=" + to_string(value.troop); break;
+            case VAL_STATUS:   key += value.status ? "=true" : "=false"; break;
+            case VAL_CODENAME: key += "=\"" + value.codename(); break;
+            case VAL_AMMO: {
+                uint64_t bits;
+                memcpy(&bits, &value.ammo, sizeof bits);
+                key += "=" + to_string(bits);
+                break;
+            }
+            default: break;
+        }
+    }
+    return key;
+}
+
+static void commonSubexpressions(IrFunction& fn) {
+    Dominators dom(fn);
+    vector<vector<int>> children(fn.blocks.size());
+    for (int block : dom.rpo) {
+        if (block != 0) children[dom.idom[block]].push_back(block);
+    }
+
+    vector<int> forward(fn.values.size(), -1);
+    unordered_map<string, int> available;
+    vector<string> scope;                  // Keys added, unwound on leaving a subtree
+    vector<pair<int, size_t>> stack(1, make_pair(0, (size_t)0));
+    vector<size_t> scopeMarks(1, 0);
+
+    bool entering = true;
+    while (!stack.empty()) {
+        int block = stack.back().first;
+        if (entering) {
+            for (int id : fn.blocks[block].code) {
+                const IrInstr& instr = fn.values[id];
+                if (!isPure(instr.opcode) || instr.opcode == IR_PARAM || instr.opcode == IR_UNDEF) continue;
+                string key = valueKey(instr, forward);
+                unordered_map<string, int>::const_iterator found = available.find(key);
+                if (found != available.end()) {
+                    forward[id] = found->second;
+                } else {
+                    available.insert(make_pair(key, id));
+                    scope.push_back(key);
+                }
+            }
+        }
+        size_t& next = stack.back().second;
+        if (next < children[block].size()) {
+            int child = children[block][next++];
+            stack.push_back(make_pair(child, (size_t)0));
+            scopeMarks.push_back(scope.size());
+            entering = true;
+        } else {
+            while (scope.size() > scopeMarks.back()) {
+                available.erase(scope.back());
+                scope.pop_back();
+            }
+            scopeMarks.pop_back();
+            stack.pop_back();
+            entering = false;
+        }
+    }
+    applyForwarding(fn, forward);
+}
+
+// --- Loop-Invariant Code Motion ---
+// Moves pure instructions whose operands all come from outside a loop into
+// its preheader. Only instructions that cannot throw move: the loop might
+// run zero times, and hoisting must not invent an error.
+static void hoistLoopInvariants(IrFunction& fn) {
+    inferIrTypes(fn);
+    Dominators dom(fn);
+    vector<Loop> loops = findLoops(fn, dom);
+
+    for (const Loop& loop : loops) {
+        if (loop.preheader < 0) continue;
+        vector<int> hoisted;
+        for (int block : dom.rpo) {
+            if (!loop.contains[block]) continue;
+            vector<int> kept;
+            for (int id : fn.blocks[block].code) {
+                IrInstr& instr = fn.values[id];
+                bool invariant = isPure(instr.opcode) && instr.opcode != IR_PHI && !mayThrow(fn, instr);
+                for (size_t i = 0; invariant && i < instr.args.size(); i++) {
+                    invariant = !loop.contains[fn.values[instr.args[i]].block];
+                }
+                if (invariant) {
+                    instr.block = loop.preheader;
+                    hoisted.push_back(id);
+                } else {
+                    kept.push_back(id);
+                }
+            }
+            fn.blocks[block].code.swap(kept);
+        }
+
+        vector<int>& code = fn.blocks[loop.preheader].code;
+        code.insert(code.end() - 1, hoisted.begin(), hoisted.end());
+    }
+}
+
+// --- Induction-Variable Strength Reduction ---
+// For a counting loop
+//   header: i = phi(start, next); branch i < bound ...
+//   latch:  next = i + step
+// with constants start >= 0 and step > 0, 'i % k' (k > 0 constant) is
+// replaced by a second counter that wraps instead of dividing:
+//   header: r = phi(start % k, rnext)
+//   latch:  rnext = rotate(r, step % k, k)
+// The guard keeps i below bound, so i never overflows and stays >= 0,
+// where C's remainder and the rotating counter agree.
+static bool stepCannotOverflow(const IrFunction& fn, int bound, int step) {
+    if (step == 1) return true;
+    const IrInstr& limit = fn.values[bound];
+    return limit.opcode == IR_CONST && limit.constant.troop <= INT_MAX - (step - 1);
+}
+
+static void reduceLoopModulo(IrFunction& fn) {
+    inferIrTypes(fn);
+    Dominators dom(fn);
+    vector<Loop> loops = findLoops(fn, dom);
+    vector<int> forward(fn.values.size(), -1);
+
+    for (const Loop& loop : loops) {
+        const IrBlock& header = fn.blocks[loop.header];
+        if (loop.preheader < 0 || loop.latches.size() != 1 || header.preds.size() != 2) continue;
+        int entryIndex = header.preds[0] == loop.preheader ? 0 : 1;
+
+        // The header must test 'i < bound' and leave the loop when it fails
+        const IrInstr& exit = fn.values[header.code.back()];
+        if (exit.opcode != IR_BRANCH || !loop.contains[exit.target[0]] || loop.contains[exit.target[1]]) continue;
+        const IrInstr& test = fn.values[exit.args[0]];
+        if (test.opcode != IR_BINARY || test.op != TOK_LESS || fn.values[test.args[1]].type != VAL_TROOP) continue;
+
+        int counter = test.args[0];
+        const IrInstr& phi = fn.values[counter];
+        if (phi.opcode != IR_PHI || phi.block != loop.header || phi.type != VAL_TROOP) continue;
+        int start = phi.args[entryIndex];
+        int next = phi.args[1 - entryIndex];
+        if (!isConstant(fn, start, VAL_TROOP) || fn.values[start].constant.troop < 0) continue;
+
+        const IrInstr& increment = fn.values[next];
+        if (increment.opcode != IR_BINARY || increment.op != TOK_PLUS || increment.type != VAL_TROOP) continue;
+        int stepValue = increment.args[0] == counter ? increment.args[1] : increment.args[0];
+        if (increment.args[0] != counter && increment.args[1] != counter) continue;
+        if (!isConstant(fn, stepValue, VAL_TROOP)) continue;
+        int step = fn.values[stepValue].constant.troop;
+        if (step <= 0 || !stepCannotOverflow(fn, test.args[1], step)) continue;
+
+        int initial = fn.values[start].constant.troop;
+        unordered_map<int, int> counters;    // Modulus -> rotating counter
+        for (size_t block = 0; block < fn.blocks.size(); block++) {
+            if (!loop.contains[block]) continue;
+            // New instructions grow fn.values and may land in this very block,
+            // so walk a copy of its code and hold no references across them
+            vector<int> code = fn.blocks[block].code;
+            for (int id : code) {
+                const IrInstr& instr = fn.values[id];
+                if (instr.opcode != IR_BINARY || instr.op != TOK_MODULO || instr.args[0] != counter) continue;
+                if (!isConstant(fn, instr.args[1], VAL_TROOP)) continue;
+                int modulus = fn.values[instr.args[1]].constant.troop;
+                int line = instr.line;
+                if (modulus <= 0) continue;
+
+                unordered_map<int, int>::const_iterator found = counters.find(modulus);
+                if (found != counters.end()) {
+                    forward[id] = found->second;
+                    continue;
+                }
+
+                IrInstr rotating(IR_PHI, VAL_TROOP, line);
+                rotating.block = loop.header;
+                int r = addInstr(fn, move(rotating));
+                fn.blocks[loop.header].code.insert(fn.blocks[loop.header].code.begin(), r);
+
+                IrInstr rotate(IR_ROTATE, VAL_TROOP, line);
+                rotate.args.push_back(r);
+                rotate.args.push_back(addConstant(fn, Value::makeTroop(step % modulus)));
+                rotate.args.push_back(addConstant(fn, Value::makeTroop(modulus)));
+                int rnext = addInstr(fn, move(rotate));
+                insertAfter(fn, next, rnext);
+
+                int rstart = addConstant(fn, Value::makeTroop(initial % modulus));
+                fn.values[r].args.resize(2);
+                fn.values[r].args[entryIndex] = rstart;
+                fn.values[r].args[1 - entryIndex] = rnext;
+
+                forward.resize(fn.values.size(), -1);
+                forward[id] = r;
+                counters.insert(make_pair(modulus, r));
+            }
+        }
+    }
+    forward.resize(fn.values.size(), -1);
+    applyForwarding(fn, forward);
+}
+
+// --- Dead Code Elimination ---
+// Keeps side effects, control flow and anything that may throw, plus
+// whatever they use
+static void eliminateDeadCode(IrFunction& fn) {
+    inferIrTypes(fn);
+    vector<bool> live(fn.values.size(), false);
+    vector<int> work;
+    for (const IrBlock& block : fn.blocks) {
+        for (int id : block.code) {
+            const IrInstr& instr = fn.values[id];
+            if (!isPure(instr.opcode) || mayThrow(fn, instr)) {
+                live[id] = true;
+                work.push_back(id);
+            }
+        }
+    }
+    while (!work.empty()) {
+        int id = work.back();
+        work.pop_back();
+        for (int arg : fn.values[id].args) {
+            if (!live[arg]) {
+                live[arg] = true;
+                work.push_back(arg);
+            }
+        }
+    }
+    for (IrBlock& block : fn.blocks) {
+        vector<int> kept;
+        for (int id : block.code) {
+            if (live[id]) kept.push_back(id);
+            else fn.values[id].dead = true;
+        }
+        block.code.swap(kept);
+    }
+}
+
+// =============================================================================
+// 5. PIPELINE AND REPORT
+// =============================================================================
+
+struct IrPass {
+    const char* name;
+    void (*run)(IrFunction& fn);
+};
+
+static const IrPass pipeline[] = {
+    { "copyprop", copyPropagation },
+    { "cse",      commonSubexpressions },
+    { "licm",     hoistLoopInvariants },
+    { "strength", reduceLoopModulo },
+    { "cse",      commonSubexpressions },
+    { "dce",      eliminateDeadCode },
+};
+
+vector<IrPassReport> optimizeIr(IrModule& module) {
+    vector<IrPassReport> report;
+    for (const IrPass& pass : pipeline) {
+        IrPassReport entry;
+        entry.name = pass.name;
+        entry.opsBefore = module.opCount();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        {
+            PhaseScope phase(string("ir:") + pass.name);
+            pass.run(module.globalInit);
+            for (IrFunction& function : module.functions) {
+                if (!function.empty()) pass.run(function);
+            }
+        }
+        entry.wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        entry.opsAfter = module.opCount();
+        report.push_back(entry);
+    }
+    return report;
+}
+
+void printIrReport(const vector<IrPassReport>& report, ostream& out) {
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << "IR passes" << endl;
+    out << "---------" << endl;
+    out << left << setw(10) << "pass"
+        << right << setw(12) << "ops before"
+        << setw(12) << "ops after"
+        << setw(12) << "wall ms" << endl;
+
+    out << fixed << setprecision(3);
+    for (const IrPassReport& pass : report) {
+        out << left << setw(10) << pass.name
+            << right << setw(12) << pass.opsBefore
+            << setw(12) << pass.opsAfter
+            << setw(12) << pass.wallMs << endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// =============================================================================
+// 6. DUMP
+// =============================================================================
+
+static const char* opcodeName(IrOp opcode) {
+    switch (opcode) {
+        case IR_CONST:        return "const";
+        case IR_PARAM:        return "param";
+        case IR_UNDEF:        return "undef";
+        case IR_PHI:          return "phi";
+        case IR_CONVERT:      return "convert";
+        case IR_UNARY:        return "unary";
+        case IR_TEST:         return "test";
+        case IR_BINARY:       return "binary";
+        case IR_ROTATE:       return "rotate";
+        case IR_LOAD_GLOBAL:  return "load";
+        case IR_STORE_GLOBAL: return "store";
+        case IR_CALL:         return "call";
+        case IR_BRIEF:        return "brief";
+        case IR_INTEL:        return "intel";
+        case IR_SQUAD:        return "squad";
+        case IR_INDEX:        return "index";
+        case IR_STORE_INDEX:  return "store-index";
+        case IR_BUILTIN:      return "builtin";
+        case IR_JUMP:         return "jump";
+        case IR_BRANCH:       return "branch";
+        case IR_RETURN:       return "return";
+    }
+    return "?";
+}
+
+static void dumpFunction(const IrFunction& fn, const string& title, const vector<string>& tactics, ostream& out) {
+    out << title << " (" << fn.opCount() << " ops)\n";
+    for (size_t b = 0; b < fn.blocks.size(); b++) {
+        const IrBlock& block = fn.blocks[b];
+        out << "  b" << b << ":";
+        if (!block.preds.empty()) {
+            out << " <-";
+            for (int pred : block.preds) out << " b" << pred;
+        }
+        out << "\n";
+
+        for (int id : block.code) {
+            const IrInstr& instr = fn.values[id];
+            out << "    ";
+            if (!instr.isTerminator() && instr.opcode != IR_STORE_GLOBAL && instr.opcode != IR_BRIEF) {
+                out << "v" << id << " = ";
+            }
+            if (instr.opcode == IR_UNARY || instr.opcode == IR_BINARY) {
+                out << operatorText(instr.op);
+            } else {
+                out << opcodeName(instr.opcode);
+            }
+
+            switch (instr.opcode) {
+                case IR_CONST:
+                    if (instr.constant.type == VAL_CODENAME) out << " \"" << instr.constant.codename() << "\"";
+                    else out << " " << Interpreter::format(instr.constant, instr.line);
+                    break;
+                case IR_PARAM:
+                case IR_LOAD_GLOBAL:
+                case IR_STORE_GLOBAL:
+                    out << " " << (instr.opcode == IR_PARAM ? "#" : "g") << instr.index;
+                    break;
+                case IR_CALL:
+                    out << " " << tactics[instr.index];
+                    break;
+                case IR_BUILTIN:
+                    out << " " << builtinName((Builtin)instr.index);
+                    break;
+                default:
+                    break;
+            }
+            for (int arg : instr.args) out << " v" << arg;
+            if (instr.target[0] >= 0) out << " b" << instr.target[0];
+            if (instr.target[1] >= 0) out << " b" << instr.target[1];
+            if (!instr.isTerminator() && instr.opcode != IR_STORE_GLOBAL && instr.opcode != IR_BRIEF) {
+                out << " : " << (instr.type == VAL_NONE ? "?" : valueTypeName(instr.type));
+            }
+            out << "\n";
+        }
+    }
+}
+
+void dumpIr(const IrModule& module, ostream& out) {
+    InternerScope scope(module.names.get());
+    vector<string> tactics;
+    for (const IrFunction& function : module.functions) {
+        tactics.push_back(function.name == NO_SYMBOL ? "?" : Interner::current().name(function.name));
+    }
+    dumpFunction(module.globalInit, "globals", tactics, out);
+    for (size_t i = 0; i < module.functions.size(); i++) {
+        if (module.functions[i].empty()) continue;
+        dumpFunction(module.functions[i], "tactic " + tactics[i], tactics, out);
+    }
+}
@@ -0,0 +1,405 @@
+#include "lexgen.h"
+#include <bitset>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+
+// The generator runs the classic pipeline:
+//   patterns -> Thompson NFA -> byte classes -> subset-construction DFA
+//   -> Moore minimization -> flat transition table
+
+// =============================================================================
+// 1. NFA CONSTRUCTION
+// =============================================================================
+
+typedef bitset<256> ByteSet;
+
+struct NfaState {
+    vector<pair<ByteSet, int>> edges;  // Byte-set transitions
+    vector<int> epsilon;               // Epsilon transitions
+    int action = -1;                   // Accepting rule action
+    int rule = -1;                     // Rule index, for priority
+};
+
+// A fragment of the NFA with a single entry and a single exit state
+struct Fragment {
+    int start;
+    int end;
+};
+
+class PatternCompiler {
+private:
+    vector<NfaState>& nfa;
+    const string pattern;
+    size_t pos = 0;
+
+    int newState() {
+        nfa.push_back(NfaState());
+        return (int)nfa.size() - 1;
+    }
+
+    runtime_error error(const string& message) {
+        return runtime_error("Bad token pattern '" + pattern + "' at " + to_string(pos) + ": " + message);
+    }
+
+    bool isAtEnd() { return pos >= pattern.size(); }
+    char peek() { return isAtEnd() ? '\0' : pattern[pos]; }
+
+    unsigned char escaped(char c) {
+        switch (c) {
+            case 'n': return '\n';
+            case 't': return '\t';
+            case 'r': return '\r';
+            default:  return (unsigned char)c;
+        }
+    }
+
+    Fragment byteSet(const ByteSet& set) {
+        Fragment f = { newState(), newState() };
+        nfa[f.start].edges.push_back(make_pair(set, f.end));
+        return f;
+    }
+
+    // Alternation -> Sequence ('|' Sequence)*
+    Fragment alternation() {
+        Fragment left = sequence();
+        while (peek() == '|') {
+            pos++;
+            Fragment right = sequence();
+            Fragment f = { newState(), newState() };
+            nfa[f.start].epsilon.push_back(left.start);
+            nfa[f.start].epsilon.push_back(right.start);
+            nfa[left.end].epsilon.push_back(f.end);
+            nfa[right.end].epsilon.push_back(f.end);
+            left = f;
+        }
+        return left;
+    }
+
+    // Sequence -> Repeat*
+    Fragment sequence() {
+        Fragment f = { newState(), -1 };
+        f.end = f.start;
+        while (!isAtEnd() && peek() != '|' && peek() != ')') {
+            Fragment next = repeat();
+            nfa[f.end].epsilon.push_back(next.start);
+            f.end = next.end;
+        }
+        return f;
+    }
+
+    // Repeat -> Atom ('*' | '+' | '?')*
+    Fragment repeat() {
+        Fragment atom = this->atom();
+        while (peek() == '*' || peek() == '+' || peek() == '?') {
+            char op = pattern[pos++];
+            Fragment f = { newState(), newState() };
+            nfa[f.start].epsilon.push_back(atom.start);
+            nfa[atom.end].epsilon.push_back(f.end);
+            if (op != '+') nfa[f.start].epsilon.push_back(f.end);   // Zero times
+            if (op != '?') nfa[atom.end].epsilon.push_back(atom.start); // Again
+            atom = f;
+        }
+        return atom;
+    }
+
+    // Atom -> '(' Alternation ')' | '[' Class ']' | '\' c | c
+    Fragment atom() {
+        char c = pattern[pos++];
+        if (c == '(') {
+            Fragment inner = alternation();
+            if (peek() != ')') throw error("expected ')'");
+            pos++;
+            return inner;
+        }
+        if (c == '[') {
+            return byteSet(byteClass());
+        }
+        if (c == '*' || c == '+' || c == '?') {
+            throw error("repetition without operand");
+        }
+        ByteSet set;
+        if (c == '\\') {
+            if (isAtEnd()) throw error("dangling '\\'");
+            c = (char)escaped(pattern[pos++]);
+        }
+        set.set((unsigned char)c);
+        return byteSet(set);
+    }
+
+    // Class -> '^'? (c | c '-' c)* ']'
+    ByteSet byteClass() {
+        ByteSet set;
+        bool negate = false;
+        if (peek() == '^') {
+            negate = true;
+            pos++;
+        }
+        while (!isAtEnd() && peek() != ']') {
+            unsigned char low = (unsigned char)pattern[pos++];
+            if (low == '\\' && !isAtEnd()) low = escaped(pattern[pos++]);
+            unsigned char high = low;
+            if (peek() == '-' && pos + 1 < pattern.size() && pattern[pos + 1] != ']') {
+                pos++;
+                high = (unsigned char)pattern[pos++];
+                if (high == '\\' && !isAtEnd()) high = escaped(pattern[pos++]);
+            }
+            for (int b = low; b <= high; b++) set.set(b);
+        }
+        if (isAtEnd()) throw error("unterminated '['");
+        pos++; // Closing ]
+        return negate ? ~set : set;
+    }
+
+public:
+    PatternCompiler(vector<NfaState>& nfa, const string& pattern) : nfa(nfa), pattern(pattern) {}
+
+    Fragment compile() {
+        Fragment f = alternation();
+        if (!isAtEnd()) throw error("unexpected ')'");
+        return f;
+    }
+};
+
+// =============================================================================
+// 2. BYTE CLASSES
+// =============================================================================
+
+// Two bytes belong to the same class when every NFA edge treats them alike,
+// so the DFA only needs one column per class instead of one per byte.
+static int computeByteClasses(const vector<NfaState>& nfa, unsigned char byteClass[256]) {
+    vector<ByteSet> distinct;
+    for (const NfaState& state : nfa) {
+        for (const auto& edge : state.edges) {
+            if (find(distinct.begin(), distinct.end(), edge.first) == distinct.end()) {
+                distinct.push_back(edge.first);
+            }
+        }
+    }
+
+    map<vector<bool>, int> signatures;
+    for (int b = 0; b < 256; b++) {
+        vector<bool> signature(distinct.size());
+        for (size_t i = 0; i < distinct.size(); i++) signature[i] = distinct[i].test(b);
+        auto found = signatures.find(signature);
+        if (found == signatures.end()) {
+            found = signatures.insert(make_pair(signature, (int)signatures.size())).first;
+        }
+        byteClass[b] = (unsigned char)found->second;
+    }
+    return (int)signatures.size();
+}
+
+// =============================================================================
+// 3. SUBSET CONSTRUCTION
+// =============================================================================
+
+static void epsilonClosure(const vector<NfaState>& nfa, vector<int>& states) {
+    vector<bool> seen(nfa.size());
+    vector<int> work(states);
+    for (int s : states) seen[s] = true;
+    while (!work.empty()) {
+        int s = work.back();
+        work.pop_back();
+        for (int t : nfa[s].epsilon) {
+            if (!seen[t]) {
+                seen[t] = true;
+                states.push_back(t);
+                work.push_back(t);
+            }
+        }
+    }
+    sort(states.begin(), states.end());
+}
+
+struct Dfa {
+    vector<vector<int>> next;  // [state][class]
+    vector<int> accept;
+    int start;
+};
+
+static Dfa buildDfa(const vector<NfaState>& nfa, int nfaStart,
+                    const unsigned char byteClass[256], int numClasses) {
+    // One representative byte per class is enough to evaluate edges
+    vector<int> representative(numClasses, -1);
+    for (int b = 0; b < 256; b++) {
+        if (representative[byteClass[b]] < 0) representative[byteClass[b]] = b;
+    }
+
+    Dfa dfa;
+    map<vector<int>, int> ids;
+    vector<vector<int>> sets;
+
+    // State 0 is the dead state (the empty NFA set)
+    ids[vector<int>()] = 0;
+    sets.push_back(vector<int>());
+
+    vector<int> startSet(1, nfaStart);
+    epsilonClosure(nfa, startSet);
+    ids[startSet] = 1;
+    sets.push_back(startSet);
+    dfa.start = 1;
+
+    for (size_t i = 0; i < sets.size(); i++) {
+        vector<int> row(numClasses, 0);
+        for (int cls = 0; cls < numClasses; cls++) {
+            vector<int> target;
+            for (int s : sets[i]) {
+                for (const auto& edge : nfa[s].edges) {
+                    if (edge.first.test(representative[cls])) target.push_back(edge.second);
+                }
+            }
+            if (target.empty()) continue;
+            epsilonClosure(nfa, target);
+            target.erase(unique(target.begin(), target.end()), target.end());
+            auto found = ids.find(target);
+            if (found == ids.end()) {
+                found = ids.insert(make_pair(target, (int)sets.size())).first;
+                sets.push_back(target);
+            }
+            row[cls] = found->second;
+        }
+        dfa.next.push_back(row);
+
+        // Lowest rule index wins among the accepting NFA states
+        int bestRule = -1;
+        int action = -1;
+        for (int s : sets[i]) {
+            if (nfa[s].rule >= 0 && (bestRule < 0 || nfa[s].rule < bestRule)) {
+                bestRule = nfa[s].rule;
+                action = nfa[s].action;
+            }
+        }
+        dfa.accept.push_back(action);
+    }
+    return dfa;
+}
+
+// =============================================================================
+// 4. MINIMIZATION
+// =============================================================================
+
+// Moore partition refinement: start from blocks of equal actions, then split
+// blocks until every state in a block moves to the same blocks on every class.
+static Dfa minimize(const Dfa& dfa, int numClasses) {
+    size_t n = dfa.next.size();
+    vector<int> block(n);
+
+    // Initial partition by action; the dead state keeps its own block 0
+    map<int, int> byAction;
+    block[0] = 0;
+    int numBlocks = 1;
+    for (size_t s = 1; s < n; s++) {
+        auto found = byAction.find(dfa.accept[s]);
+        if (found == byAction.end()) {
+            found = byAction.insert(make_pair(dfa.accept[s], numBlocks++)).first;
+        }
+        block[s] = found->second;
+    }
+
+    while (true) {
+        map<vector<int>, int> signatures;
+        vector<int> refined(n);
+        for (size_t s = 0; s < n; s++) {
+            vector<int> signature;
+            signature.reserve(numClasses + 1);
+            signature.push_back(block[s]);
+            for (int cls = 0; cls < numClasses; cls++) signature.push_back(block[dfa.next[s][cls]]);
+            auto found = signatures.find(signature);
+            if (found == signatures.end()) {
+                found = signatures.insert(make_pair(signature, (int)signatures.size())).first;
+            }
+            refined[s] = found->second;
+        }
+        bool stable = (int)signatures.size() == numBlocks;
+        numBlocks = (int)signatures.size();
+        block = refined;
+        if (stable) break;
+    }
+
+    // Renumber so the dead state's block is 0
+    vector<int> renumber(numBlocks, -1);
+    int nextId = 0;
+    renumber[block[0]] = nextId++;
+    for (size_t s = 1; s < n; s++) {
+        if (renumber[block[s]] < 0) renumber[block[s]] = nextId++;
+    }
+
+    Dfa result;
+    result.next.assign(numBlocks, vector<int>(numClasses, 0));
+    result.accept.assign(numBlocks, -1);
+    for (size_t s = 0; s < n; s++) {
+        int b = renumber[block[s]];
+        for (int cls = 0; cls < numClasses; cls++) result.next[b][cls] = renumber[block[dfa.next[s][cls]]];
+        result.accept[b] = dfa.accept[s];
+    }
+    result.start = renumber[block[dfa.start]];
+    return result;
+}
+
+// =============================================================================
+// 5. PUBLIC ENTRY POINT
+// =============================================================================
+
+LexTables buildLexTables(const vector<LexRule>& rules) {
+    vector<NfaState> nfa;
+    nfa.push_back(NfaState()); // Shared start state
+    for (size_t i = 0; i < rules.size(); i++) {
+        Fragment f = PatternCompiler(nfa, rules[i].pattern).compile();
+        nfa[0].epsilon.push_back(f.start);
+        nfa[f.end].action = rules[i].action;
+        nfa[f.end].rule = (int)i;
+    }
+
+    LexTables tables;
+    tables.numClasses = computeByteClasses(nfa, tables.byteClass);
+    Dfa dfa = minimize(buildDfa(nfa, 0, tables.byteClass, tables.numClasses), tables.numClasses);
+    if (dfa.next.size() > 0xFFFF) throw runtime_error("Token specification produces too many DFA states.");
+
+    tables.numStates = (int)dfa.next.size();
+    tables.startState = dfa.start;
+    tables.accept = dfa.accept;
+    tables.next.resize((size_t)tables.numStates * tables.numClasses);
+    for (int s = 0; s < tables.numStates; s++) {
+        for (int cls = 0; cls < tables.numClasses; cls++) {
+            tables.next[(size_t)s * tables.numClasses + cls] = (unsigned short)dfa.next[s][cls];
+        }
+    }
+    return tables;
+}
+
+// =============================================================================
+// 6. SOURCE OUTPUT
+// =============================================================================
+
+// Comma-separated values, 'perLine' to a line, indented for an initializer
+template <typename T>
+static void writeArray(ostream& out, const T* values, size_t count, size_t perLine) {
+    for (size_t i = 0; i < count; i++) {
+        out << (i % perLine == 0 ? "    " : " ") << (long long)values[i] << ",";
+        if (i % perLine == perLine - 1 || i + 1 == count) out << "\n";
+    }
+}
+
+void writeLexTables(const LexTables& tables, const string& name, const string& origin, ostream& out) {
+    out << "// Generated by lexgen from " << origin << ". Do not edit.\n"
+        << "// " << tables.numStates << " states over " << tables.numClasses << " byte classes.\n"
+        << "#include \"lexgen.h\"\n\n";
+
+    out << "static const unsigned char lexByteClass[256] = {\n";
+    writeArray(out, tables.byteClass, 256, 16);
+    out << "};\n\n";
+
+    out << "static const unsigned short lexNext[" << tables.next.size() << "] = {\n";
+    writeArray(out, tables.next.data(), tables.next.size(), (size_t)tables.numClasses);
+    out << "};\n\n";
+
+    out << "static const int lexAccept[" << tables.accept.size() << "] = {\n";
+    writeArray(out, tables.accept.data(), tables.accept.size(), 16);
+    out << "};\n\n";
+
+    out << "extern const StaticLexTables " << name << " = {\n"
+        << "    " << tables.numClasses << ", " << tables.numStates << ", " << tables.startState
+        << ", lexByteClass, lexNext, lexAccept\n"
+        << "};\n";
+}
@@ -0,0 +1,65 @@
+#ifndef LEXGEN_H
+#define LEXGEN_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+// =============================================================================
+// 1. TOKEN SPECIFICATION
+// =============================================================================
+
+// One rule of a declarative token specification.
+//
+// Patterns use a small regular-expression syntax:
+//   c        literal byte          \c      escaped byte (\n, \t, \r, or c itself)
+//   [a-z_]   byte class            [^"\n]  negated byte class
+//   (...)    grouping              a|b     alternation
+//   x* x+ x? repetition
+//
+// When two rules match the same longest lexeme, the one listed first wins.
+struct LexRule {
+    const char* pattern;
+    int action;
+};
+
+// =============================================================================
+// 2. GENERATED TABLES
+// =============================================================================
+
+// A minimized DFA over compressed byte classes.
+//
+// State 0 is always the dead state, so the lexing loop can stop on a single
+// comparison. Transitions are stored row-major: next[state * numClasses + cls].
+struct LexTables {
+    int numClasses = 0;
+    int numStates = 0;
+    int startState = 0;
+    unsigned char byteClass[256];
+    vector<unsigned short> next;
+    vector<int> accept;  // Action of the accepting rule, or -1
+
+    static const int DEAD = 0;
+};
+
+// The same tables as constant arrays, so a scanner can be compiled with
+// them instead of building them when it starts.
+struct StaticLexTables {
+    int numClasses;
+    int numStates;
+    int startState;
+    const unsigned char* byteClass;
+    const unsigned short* next;
+    const int* accept;
+};
+
+// Builds the tables for a specification. Throws runtime_error on a bad pattern.
+LexTables buildLexTables(const vector<LexRule>& rules);
+
+// Writes 'tables' as a C++ source file defining 'const StaticLexTables <name>'.
+// 'origin' names the specification in the file's header comment.
+void writeLexTables(const LexTables& tables, const string& name, const string& origin, ostream& out);
+
+#endif // LEXGEN_H
@@ -0,0 +1,367 @@
+#include "linker.h"
+#include <algorithm>
+
+// =============================================================================
+// 1. AST WALKS
+// =============================================================================
+
+static void collectCalls(const Expr& expr, vector<int>& calls);
+
+static void collectCalls(const Stmt& stmt, vector<int>& calls) {
+    if (stmt.expr) collectCalls(*stmt.expr, calls);
+    if (stmt.init) collectCalls(*stmt.init, calls);
+    if (stmt.update) collectCalls(*stmt.update, calls);
+    if (stmt.body) collectCalls(*stmt.body, calls);
+    if (stmt.elseBranch) collectCalls(*stmt.elseBranch, calls);
+    for (const unique_ptr<Stmt>& inner : stmt.statements) collectCalls(*inner, calls);
+}
+
+static void collectCalls(const Expr& expr, vector<int>& calls) {
+    if (expr.kind == EXPR_CALL) calls.push_back(expr.function);
+    if (expr.left) collectCalls(*expr.left, calls);
+    if (expr.right) collectCalls(*expr.right, calls);
+    for (const unique_ptr<Expr>& arg : expr.args) collectCalls(*arg, calls);
+}
+
+static int countNodes(const Expr& expr) {
+    int count = 1;
+    if (expr.left) count += countNodes(*expr.left);
+    if (expr.right) count += countNodes(*expr.right);
+    for (const unique_ptr<Expr>& arg : expr.args) count += countNodes(*arg);
+    return count;
+}
+
+static int countNodes(const Stmt& stmt) {
+    int count = 1;
+    if (stmt.expr) count += countNodes(*stmt.expr);
+    if (stmt.init) count += countNodes(*stmt.init);
+    if (stmt.update) count += countNodes(*stmt.update);
+    if (stmt.body) count += countNodes(*stmt.body);
+    if (stmt.elseBranch) count += countNodes(*stmt.elseBranch);
+    for (const unique_ptr<Stmt>& inner : stmt.statements) count += countNodes(*inner);
+    return count;
+}
+
+static bool hasRetreat(const Stmt& stmt) {
+    if (stmt.kind == STMT_RETREAT) return true;
+    if (stmt.init && hasRetreat(*stmt.init)) return true;
+    if (stmt.body && hasRetreat(*stmt.body)) return true;
+    if (stmt.elseBranch && hasRetreat(*stmt.elseBranch)) return true;
+    for (const unique_ptr<Stmt>& inner : stmt.statements) {
+        if (hasRetreat(*inner)) return true;
+    }
+    return false;
+}
+
+static void renumberCalls(Expr& expr, const vector<int>& renumber) {
+    if (expr.kind == EXPR_CALL) expr.function = renumber[expr.function];
+    if (expr.left) renumberCalls(*expr.left, renumber);
+    if (expr.right) renumberCalls(*expr.right, renumber);
+    for (unique_ptr<Expr>& arg : expr.args) renumberCalls(*arg, renumber);
+}
+
+static void renumberCalls(Stmt& stmt, const vector<int>& renumber) {
+    if (stmt.expr) renumberCalls(*stmt.expr, renumber);
+    if (stmt.init) renumberCalls(*stmt.init, renumber);
+    if (stmt.update) renumberCalls(*stmt.update, renumber);
+    if (stmt.body) renumberCalls(*stmt.body, renumber);
+    if (stmt.elseBranch) renumberCalls(*stmt.elseBranch, renumber);
+    for (unique_ptr<Stmt>& inner : stmt.statements) renumberCalls(*inner, renumber);
+}
+
+// --- Cloning ---
+// A copy of a callee's code for its caller's frame: local slots move up
+// by 'offset', globals stay where they are.
+static unique_ptr<Expr> cloneExpr(const Expr& expr, int offset) {
+    unique_ptr<Expr> copy(new Expr(expr.kind, expr.line));
+    copy->literal = expr.literal;
+    copy->op = expr.op;
+    copy->name = expr.name;
+    copy->slot = expr.slot;
+    copy->global = expr.global;
+    copy->function = expr.function;
+    copy->paramTypes = expr.paramTypes;
+    bool local = expr.kind == EXPR_VARIABLE || expr.kind == EXPR_ASSIGN || expr.kind == EXPR_SET_INDEX ||
+                 expr.kind == EXPR_INLINE;
+    if (local && !expr.global) copy->slot += offset;
+    if (expr.left) copy->left = cloneExpr(*expr.left, offset);
+    if (expr.right) copy->right = cloneExpr(*expr.right, offset);
+    for (const unique_ptr<Expr>& arg : expr.args) copy->args.push_back(cloneExpr(*arg, offset));
+    return copy;
+}
+
+static unique_ptr<Stmt> cloneStmt(const Stmt& stmt, int offset) {
+    unique_ptr<Stmt> copy(new Stmt(stmt.kind, stmt.line));
+    copy->varType = stmt.varType;
+    copy->name = stmt.name;
+    copy->slot = stmt.slot;
+    copy->global = stmt.global;
+    copy->tailCall = stmt.tailCall;
+    copy->parallel = stmt.parallel;
+    copy->reductions = stmt.reductions;
+    for (Reduction& reduction : copy->reductions) reduction.slot += offset;
+    if ((stmt.kind == STMT_VAR || stmt.kind == STMT_INTEL) && !stmt.global) copy->slot += offset;
+    if (stmt.expr) copy->expr = cloneExpr(*stmt.expr, offset);
+    if (stmt.init) copy->init = cloneStmt(*stmt.init, offset);
+    if (stmt.update) copy->update = cloneExpr(*stmt.update, offset);
+    if (stmt.body) copy->body = cloneStmt(*stmt.body, offset);
+    if (stmt.elseBranch) copy->elseBranch = cloneStmt(*stmt.elseBranch, offset);
+    for (const unique_ptr<Stmt>& inner : stmt.statements) copy->statements.push_back(cloneStmt(*inner, offset));
+    return copy;
+}
+
+// =============================================================================
+// 2. LINKER CLASS
+// =============================================================================
+
+class Linker {
+private:
+    // How a tactic can be inlined
+    enum Shape {
+        SHAPE_NONE,
+        SHAPE_EXPRESSION,  // Body is 'retreat expr;'
+        SHAPE_PROCEDURE    // Body never retreats; inlined where the call is a statement
+    };
+
+    Program& program;
+    const LinkOptions& options;
+    LinkStats stats;
+
+    vector<vector<int>> callees;
+    vector<Shape> shapes;
+    vector<int> sizes;            // AST nodes in each body
+    Function* caller = nullptr;   // Tactic being rewritten
+    int growth = 0;               // Nodes inlined into it so far
+
+    // Tarjan's strongly connected components, emitted callees first
+    vector<int> sccIndex, sccLow, sccStack;
+    vector<bool> onStack;
+    vector<int> bottomUp;
+    vector<bool> recursive;
+    int nextIndex = 0;
+
+    void buildCallGraph();
+    void strongConnect(int function);
+    void classify(int function);
+    bool canInline(int function, Shape shape) const;
+
+    void rewrite(unique_ptr<Stmt>& stmt);
+    void rewrite(unique_ptr<Expr>& expr);
+    int reserveFrame(const Function& callee);
+
+    vector<bool> reachable() const;
+    void dropUnreachable();
+
+public:
+    Linker(Program& program, const LinkOptions& options) : program(program), options(options) {}
+    LinkStats link();
+};
+
+// =============================================================================
+// 3. CALL GRAPH
+// =============================================================================
+
+void Linker::buildCallGraph() {
+    callees.assign(program.functions.size(), vector<int>());
+    for (size_t i = 0; i < program.functions.size(); i++) {
+        const Function& function = program.functions[i];
+        if (function.body) collectCalls(*function.body, callees[i]);
+    }
+}
+
+void Linker::strongConnect(int function) {
+    sccIndex[function] = sccLow[function] = nextIndex++;
+    sccStack.push_back(function);
+    onStack[function] = true;
+    for (int callee : callees[function]) {
+        if (sccIndex[callee] < 0) {
+            strongConnect(callee);
+            sccLow[function] = min(sccLow[function], sccLow[callee]);
+        } else if (onStack[callee]) {
+            sccLow[function] = min(sccLow[function], sccIndex[callee]);
+        }
+    }
+    if (sccLow[function] != sccIndex[function]) return;
+
+    // 'function' roots a component; every member of a multi-tactic
+    // component, and any tactic that calls itself, is recursive
+    size_t start = sccStack.size();
+    while (sccStack[start - 1] != function) start--;
+    start--;
+    bool cycle = sccStack.size() - start > 1 ||
+                 find(callees[function].begin(), callees[function].end(), function) != callees[function].end();
+    for (size_t i = start; i < sccStack.size(); i++) {
+        onStack[sccStack[i]] = false;
+        recursive[sccStack[i]] = cycle;
+        bottomUp.push_back(sccStack[i]);
+    }
+    sccStack.resize(start);
+}
+
+void Linker::classify(int function) {
+    const Function& tactic = program.functions[function];
+    shapes[function] = SHAPE_NONE;
+    if (!tactic.body || recursive[function]) return;
+
+    sizes[function] = countNodes(*tactic.body);
+    const vector<unique_ptr<Stmt>>& statements = tactic.body->statements;
+    if (statements.size() == 1 && statements[0]->kind == STMT_RETREAT && statements[0]->expr) {
+        shapes[function] = SHAPE_EXPRESSION;
+    } else if (!hasRetreat(*tactic.body)) {
+        shapes[function] = SHAPE_PROCEDURE;
+    }
+}
+
+bool Linker::canInline(int function, Shape shape) const {
+    if (shapes[function] != shape || sizes[function] > options.maxInlineSize) return false;
+    return growth + sizes[function] <= options.maxGrowth;
+}
+
+// =============================================================================
+// 4. INLINING
+// =============================================================================
+
+// The callee's whole frame moves above the caller's, so its parameters,
+// its locals and anything already inlined into it keep distinct slots
+int Linker::reserveFrame(const Function& callee) {
+    int base = caller->frameSize;
+    caller->frameSize += callee.frameSize;
+    return base;
+}
+
+void Linker::rewrite(unique_ptr<Expr>& expr) {
+    if (expr->left) rewrite(expr->left);
+    if (expr->right) rewrite(expr->right);
+    for (unique_ptr<Expr>& arg : expr->args) rewrite(arg);
+
+    if (expr->kind != EXPR_CALL || !canInline(expr->function, SHAPE_EXPRESSION)) return;
+    const Function& callee = program.functions[expr->function];
+    growth += sizes[expr->function];
+    stats.inlinedCalls++;
+
+    unique_ptr<Expr> inlined(new Expr(EXPR_INLINE, expr->line));
+    inlined->name = callee.name;
+    inlined->slot = reserveFrame(callee);
+    for (const Param& param : callee.params) inlined->paramTypes.push_back(param.type);
+    inlined->args = move(expr->args);
+    inlined->left = cloneExpr(*callee.body->statements[0]->expr, inlined->slot);
+    expr = move(inlined);
+}
+
+void Linker::rewrite(unique_ptr<Stmt>& stmt) {
+    if (stmt->expr) rewrite(stmt->expr);
+    if (stmt->init) rewrite(stmt->init);
+    if (stmt->update) rewrite(stmt->update);
+    if (stmt->body) rewrite(stmt->body);
+    if (stmt->elseBranch) rewrite(stmt->elseBranch);
+    for (unique_ptr<Stmt>& inner : stmt->statements) rewrite(inner);
+
+    // A tail call that was inlined is an ordinary value now
+    if (stmt->kind == STMT_RETREAT) {
+        stmt->tailCall = stmt->expr && stmt->expr->kind == EXPR_CALL;
+        return;
+    }
+
+    // 'f(args);'  ->  { type param = arg; ... f's statements }
+    if (stmt->kind != STMT_EXPR || stmt->expr->kind != EXPR_CALL) return;
+    Expr& call = *stmt->expr;
+    if (!canInline(call.function, SHAPE_PROCEDURE)) return;
+    const Function& callee = program.functions[call.function];
+    growth += sizes[call.function];
+    stats.inlinedCalls++;
+
+    int base = reserveFrame(callee);
+    unique_ptr<Stmt> block(new Stmt(STMT_BLOCK, stmt->line));
+    for (size_t i = 0; i < call.args.size(); i++) {
+        unique_ptr<Stmt> bind(new Stmt(STMT_VAR, call.args[i]->line));
+        bind->varType = callee.params[i].type;
+        bind->name = callee.params[i].name;
+        bind->slot = base + (int)i;
+        bind->expr = move(call.args[i]);
+        block->statements.push_back(move(bind));
+    }
+    for (const unique_ptr<Stmt>& inner : callee.body->statements) {
+        block->statements.push_back(cloneStmt(*inner, base));
+    }
+    stmt = move(block);
+}
+
+// =============================================================================
+// 5. REACHABILITY
+// =============================================================================
+
+vector<bool> Linker::reachable() const {
+    vector<bool> seen(program.functions.size(), false);
+    vector<int> work;
+    if (program.campaign >= 0) work.push_back(program.campaign);
+    for (const unique_ptr<Stmt>& global : program.globals) {
+        collectCalls(*global, work);
+    }
+    while (!work.empty()) {
+        int function = work.back();
+        work.pop_back();
+        if (seen[function]) continue;
+        seen[function] = true;
+        work.insert(work.end(), callees[function].begin(), callees[function].end());
+    }
+    return seen;
+}
+
+void Linker::dropUnreachable() {
+    vector<bool> keep = reachable();
+    vector<int> renumber(program.functions.size(), -1);
+    vector<Function> kept;
+    for (size_t i = 0; i < program.functions.size(); i++) {
+        if (!keep[i]) continue;
+        renumber[i] = (int)kept.size();
+        kept.push_back(move(program.functions[i]));
+    }
+    program.functions.swap(kept);
+    program.campaign = renumber[program.campaign];
+
+    for (Function& function : program.functions) {
+        renumberCalls(*function.body, renumber);
+    }
+    for (unique_ptr<Stmt>& global : program.globals) {
+        renumberCalls(*global, renumber);
+    }
+}
+
+LinkStats Linker::link() {
+    size_t count = program.functions.size();
+    stats.tacticsBefore = count;
+
+    if (options.inlineCalls) {
+        buildCallGraph();
+        sccIndex.assign(count, -1);
+        sccLow.assign(count, 0);
+        onStack.assign(count, false);
+        recursive.assign(count, false);
+        shapes.assign(count, SHAPE_NONE);
+        sizes.assign(count, 0);
+        for (size_t i = 0; i < count; i++) {
+            if (sccIndex[i] < 0) strongConnect((int)i);
+        }
+
+        // Callees first, so what is inlined has already been inlined into
+        for (int function : bottomUp) {
+            Function& tactic = program.functions[function];
+            if (tactic.body) {
+                caller = &tactic;
+                growth = 0;
+                rewrite(tactic.body);
+            }
+            classify(function);
+        }
+    }
+
+    buildCallGraph();
+    if (program.campaign >= 0) dropUnreachable();
+    stats.tacticsKept = program.functions.size();
+    return stats;
+}
+
+LinkStats linkProgram(Program& program, const LinkOptions& options) {
+    Linker linker(program, options);
+    return linker.link();
+}
@@ -0,0 +1,43 @@
+#ifndef LINKER_H
+#define LINKER_H
+
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. LINK OPTIONS AND RESULTS
+// =============================================================================
+
+struct LinkOptions {
+    bool inlineCalls = true;
+    int maxInlineSize = 24;   // AST nodes a tactic body may have to be inlined
+    int maxGrowth = 400;      // AST nodes inlining may add to one tactic
+};
+
+struct LinkStats {
+    size_t tacticsBefore = 0;
+    size_t tacticsKept = 0;
+    int inlinedCalls = 0;
+};
+
+// =============================================================================
+// 2. WHOLE-PROGRAM PASS
+// =============================================================================
+
+// Runs on a resolved program once every supplied module is merged into it.
+//   1. Builds the call graph. 'campaign' and the global initializers are the roots.
+//   2. Inlines small non-recursive tactics, callees before callers:
+//        - a 'retreat expr;' tactic at any call site (EXPR_INLINE)
+//        - a tactic with no 'retreat' where its call is a statement (a block)
+//      Arguments are bound to fresh slots in the caller's frame, so they are
+//      evaluated and converted exactly once, in order, as a call would.
+//      Inlined nodes keep the callee's line numbers, so a runtime error
+//      names the same line with or without inlining. Messages give a line
+//      and no file: for a supplied module's tactic, a line of that module.
+//      Global initializers have no frame and keep their calls.
+//   3. Drops tactics no longer reachable from the roots and renumbers calls.
+// Without a campaign, nothing is dropped.
+LinkStats linkProgram(Program& program, const LinkOptions& options);
+
+#endif // LINKER_H
@@ -0,0 +1,329 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include "compiler.h"
+#include "scanner.h"
+#include "interpreter.h"
+#include "astdump.h"
+#include "telemetry.h"
+#include "ir.h"
+#include "image.h"
+
+using namespace std;
+
+// The command-line compiler. The front end and the interpreter are the
+// TacticLang library (see tacticlang.h); the phase timings, AST dump, IR
+// and image writer are only here.
+
+// =============================================================================
+// 1. COMPILER PIPELINE
+// =============================================================================
+
+struct CompileOptions {
+    bool run = false;       // Execute 'campaign' after a successful compile
+    bool validate = false;  // Parse and check every tactic body, even when running
+    bool dumpAst = false;   // Print the parse tree after resolution
+    bool irReport = false;  // Print op counts before and after each IR pass
+    bool dumpIr = false;    // Print the optimized IR
+    bool runIr = false;     // Execute from the optimized IR instead of the AST
+    string imagePath;       // Write the linked program here as an image (--emit-image)
+    LinkOptions linkOptions;
+    RunOptions runOptions;
+};
+
+// The phases after linking, shared by source files and images: dumps,
+// the IR, and execution. Returns the process exit status.
+int finish(Program& program, const CompileOptions& options) {
+    if (options.dumpAst) {
+        cout << endl;
+        dumpProgram(program, cout);
+    }
+
+    // --- 8. Mid-level IR ---
+    IrModule module;
+    if (options.irReport || options.dumpIr || options.runIr) {
+        {
+            PhaseScope phase("ir-build");
+            module = buildIr(program);
+        }
+        vector<IrPassReport> report = optimizeIr(module);
+        if (options.irReport) {
+            cout << endl;
+            printIrReport(report, cout);
+        }
+        if (options.dumpIr) {
+            cout << endl;
+            dumpIr(module, cout);
+        }
+    }
+
+    cout << endl << "Compiler run finished." << endl;
+
+    // --- 9. Execution ---
+    if (options.run || options.runIr) {
+        cout << endl;
+        PhaseScope phase("run");
+        StreamIO io(cin, cout);
+        try {
+            if (options.runIr) {
+                runIr(module, options.runOptions, io);
+            } else {
+                Interpreter interpreter(program, options.runOptions, io);
+                interpreter.run();
+            }
+            cout.flush();
+        } catch (RuntimeError& e) {
+            cout.flush();
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Runs every phase on one file, recording each into Telemetry.
+// Returns the process exit status.
+int compile(const string& filepath, const CompileOptions& options) {
+    // --- 1. Reading ---
+    string sourceCode;
+    {
+        PhaseScope phase("read");
+        sourceCode = readFile(filepath);
+        phase.setBytes(sourceCode.size());
+    }
+    if (sourceCode.empty()) {
+        cerr << "Error: Source file is empty or could not be read." << endl;
+        return 1;
+    }
+
+    // --- 2. Scanning ---
+    // A run only needs the tactics it reaches, so it skims bodies unless
+    // --validate asks for the full check. An image is always fully checked.
+    bool running = options.run || options.runIr;
+    bool lazy = running && !options.validate && options.imagePath.empty();
+    Compilation compilation(filepath, lazy, cerr, cout);
+
+    cout << "File read successfully. Scanning..." << endl;
+    bool scanned;
+    {
+        PhaseScope phase("scan");
+        scanned = compilation.scan(sourceCode);
+        phase.setBytes(sourceCode.size());
+        phase.setTokens(compilation.getTokenCount());
+    }
+    if (!scanned) return 1;
+
+    cout << "Scanning complete. " << compilation.getTokenCount() << " tokens found." << endl << endl;
+
+    // --- 3. Parsing ---
+    cout << "Parsing..." << endl;
+    bool parsed;
+    {
+        PhaseScope phase("parse");
+        parsed = compilation.parse(); // This will print "Parsing complete" or any errors.
+        phase.setBytes(sourceCode.size());
+        phase.setTokens(compilation.getTokenCount());
+    }
+    if (!parsed) return 1;
+
+    // --- 4. Supplied Modules ---
+    bool supplied;
+    {
+        PhaseScope phase("supply");
+        supplied = compilation.supply();
+        phase.setBytes(compilation.moduleBytes);
+        phase.setTokens(compilation.moduleTokens);
+    }
+    if (!supplied) return 1;
+
+    // --- 5. Name Resolution ---
+    bool resolved;
+    {
+        PhaseScope phase("resolve");
+        resolved = compilation.resolve();
+    }
+    if (!resolved) {
+        cerr << "Semantic analysis failed." << endl;
+        return 1;
+    }
+
+    // --- 6. Whole-Program Linking ---
+    Program& program = compilation.program;
+    {
+        PhaseScope phase("link");
+        LinkStats stats = compilation.link(options.linkOptions);
+        cout << "Linked " << compilation.getFileCount() << " file(s): kept " << stats.tacticsKept << " of "
+             << stats.tacticsBefore << " tactics, inlined " << stats.inlinedCalls << " call site(s)." << endl;
+    }
+
+    // --- 7. Program Image ---
+    if (!options.imagePath.empty()) {
+        PhaseScope phase("emit");
+        try {
+            size_t bytes = writeImage(program, options.imagePath);
+            phase.setBytes(bytes);
+            cout << "Wrote image " << options.imagePath << " (" << bytes << " bytes, "
+                 << program.functions.size() << " tactic(s))." << endl;
+        } catch (ImageError& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    return finish(program, options);
+}
+
+// Loads a program image written by --emit-image and continues from
+// finish(): nothing is scanned, parsed, resolved or linked.
+int runImage(const string& filepath, const CompileOptions& options) {
+    Program program;
+    {
+        PhaseScope phase("load-image");
+        try {
+            loadImage(filepath, program);
+        } catch (ImageError& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+    cout << "Loaded image: " << program.functions.size() << " tactic(s), "
+         << program.globals.size() << " global(s)." << endl;
+    return finish(program, options);
+}
+
+// =============================================================================
+// 2. MAIN FUNCTION
+// =============================================================================
+
+int main(int argc, char* argv[]) {
+    // File path from your original code
+    string filepath = "D:\\Faculty\\Y4\\S1\\Compiler\\TacticLang\\soldier.tac";
+
+    // --- Command line ---
+    // Usage: Project1 [file.tac | file.tlimg] [--run] [--validate] [--dump-ast]
+    //                 [--ir-report] [--dump-ir] [--run-ir] [--no-inline]
+    //                 [--emit-image <file.tlimg>]
+    //                 [--max-depth N] [--max-stack KB] [--workers N]
+    //                 [--max-steps N] [--max-memory KB]
+    //                 [--stats] [--stats-json <file|->]
+    //        Project1 --emit-lexer <scantables.cpp>
+    bool showStats = false;
+    string jsonPath;
+    string lexerPath;
+    CompileOptions options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--run") {
+            options.run = true;
+        } else if (arg == "--validate") {
+            options.validate = true;
+        } else if (arg == "--dump-ast") {
+            options.dumpAst = true;
+        } else if (arg == "--ir-report") {
+            options.irReport = true;
+        } else if (arg == "--dump-ir") {
+            options.dumpIr = true;
+        } else if (arg == "--run-ir") {
+            options.runIr = true;
+        } else if (arg == "--emit-image") {
+            if (i + 1 >= argc) {
+                cerr << "Error: --emit-image needs an output file." << endl;
+                return 1;
+            }
+            options.imagePath = argv[++i];
+        } else if (arg == "--no-inline") {
+            options.linkOptions.inlineCalls = false;
+        } else if (arg == "--max-depth") {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                cerr << "Error: --max-depth needs a positive call depth." << endl;
+                return 1;
+            }
+            options.runOptions.maxCallDepth = atoi(argv[++i]);
+        } else if (arg == "--max-stack") {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                cerr << "Error: --max-stack needs a positive size in KB." << endl;
+                return 1;
+            }
+            options.runOptions.maxNativeStack = (size_t)atoi(argv[++i]) * 1024;
+        } else if (arg == "--workers") {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                cerr << "Error: --workers needs a positive thread count." << endl;
+                return 1;
+            }
+            options.runOptions.workers = atoi(argv[++i]);
+        } else if (arg == "--max-steps") {
+            if (i + 1 >= argc || atoll(argv[i + 1]) <= 0) {
+                cerr << "Error: --max-steps needs a positive statement count." << endl;
+                return 1;
+            }
+            options.runOptions.maxSteps = atoll(argv[++i]);
+        } else if (arg == "--max-memory") {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                cerr << "Error: --max-memory needs a positive size in KB." << endl;
+                return 1;
+            }
+            options.runOptions.maxMemory = (size_t)atoi(argv[++i]) * 1024;
+        } else if (arg == "--stats-json") {
+            if (i + 1 >= argc) {
+                cerr << "Error: --stats-json needs an output file (or '-' for stdout)." << endl;
+                return 1;
+            }
+            jsonPath = argv[++i];
+        } else if (arg == "--emit-lexer") {
+            if (i + 1 >= argc) {
+                cerr << "Error: --emit-lexer needs an output file." << endl;
+                return 1;
+            }
+            lexerPath = argv[++i];
+        } else {
+            filepath = arg;
+        }
+    }
+
+    // Regenerates the scanner's checked-in tables; nothing is compiled
+    if (!lexerPath.empty()) {
+        ofstream lexerFile(lexerPath);
+        if (!lexerFile.is_open()) {
+            cerr << "Error: Could not write the scanner tables to '" << lexerPath << "'" << endl;
+            return 1;
+        }
+        writeLexTables(buildLexTables(Scanner::tokenSpec()), "scannerTables", "Scanner::tokenSpec() in scanner.cpp", lexerFile);
+        return 0;
+    }
+
+    // With the statistics on stdout, everything else the compile writes
+    // there, the program's output included, goes to stderr instead
+    streambuf* stdoutBuffer = cout.rdbuf();
+    if (jsonPath == "-") cout.rdbuf(cerr.rdbuf());
+
+    cout << "TacticLang Compiler" << endl;
+    cout << "===================" << endl;
+    cout << "Reading file: " << filepath << endl;
+
+    // A program image runs as is; anything else is source
+    int status = isImageFile(filepath) ? runImage(filepath, options) : compile(filepath, options);
+
+    if (showStats) {
+        cout << endl;
+        Telemetry::instance().printText(cout);
+    }
+    cout.rdbuf(stdoutBuffer);
+    if (!jsonPath.empty()) {
+        if (jsonPath == "-") {
+            Telemetry::instance().printJson(cout);
+        } else {
+            ofstream jsonFile(jsonPath);
+            if (!jsonFile.is_open()) {
+                cerr << "Error: Could not write stats to '" << jsonPath << "'" << endl;
+                return 1;
+            }
+            Telemetry::instance().printJson(jsonFile);
+        }
+    }
+
+    return status;
+}
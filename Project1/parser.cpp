@@ -1,525 +1,628 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <stdexcept> // For parser errors
-#include <fstream>   // For readFile
-#include <sstream>   // For readFile
-
-// This file *requires* you to have "scanner.h" in the same folder.
-// "scanner.h" must define:
-// 1. enum TokenType { ... };
-// 2. struct Token { ... };
-// 3. class Scanner { ... };
-#include "scanner.h"
-
-using namespace std;
+#include "parser.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 
 // =============================================================================
-// 1. PARSER CLASS
+// 1. TOKEN HELPERS AND ERROR HANDLING
 // =============================================================================
 
-class Parser {
-private:
-    vector<Token> tokens;
-    int current = 0;
+// Peek at the current token without consuming it
+Token Parser::peek() {
+    return tokens[current];
+}
 
-    // --- Parser Error Class ---
-    // A custom exception to throw on a syntax error
-    class ParseError : public runtime_error {
-    public:
-        ParseError(const string& message) : runtime_error(message) {}
-    };
+// Return the previous token
+Token Parser::previous() {
+    return tokens[current - 1];
+}
 
-    // --- Helper Functions ---
-    
-    // Peek at the current token without consuming it
-    Token peek() {
-        return tokens[current];
-    }
+// Check if we're at the end of the token list
+bool Parser::isAtEnd() {
+    return peek().type == TOK_EOF;
+}
 
-    // Return the previous token
-    Token previous() {
-        return tokens[current - 1];
-    }
+// Consume the current token and return it
+Token Parser::advance() {
+    if (!isAtEnd()) current++;
+    return previous();
+}
+
+// Check if the current token is of a specific type
+bool Parser::check(TokenType type) {
+    if (isAtEnd()) return false;
+    return peek().type == type;
+}
 
-    // Check if we're at the end of the token list
-    bool isAtEnd() {
-        return peek().type == TOK_EOF;
+// Check if the current token is one of several types
+bool Parser::check(const vector<TokenType>& types) {
+    for (TokenType type : types) {
+        if (check(type)) {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Consume the current token and return it
-    Token advance() {
-        if (!isAtEnd()) current++;
-        return previous();
+// If the current token matches one of the types, consume it and return true
+bool Parser::match(const vector<TokenType>& types) {
+    for (TokenType type : types) {
+        if (check(type)) {
+            advance();
+            return true;
+        }
     }
+    return false;
+}
 
-    // Check if the current token is of a specific type
-    bool check(TokenType type) {
-        if (isAtEnd()) return false;
-        return peek().type == type;
+// Consume a specific token type, or throw an error
+Token Parser::consume(TokenType type, const string& message) {
+    if (check(type)) return advance();
+    throw error(peek(), message);
+}
+
+// Create and return a ParseError
+Parser::ParseError Parser::error(const Token& token, const string& message) {
+    string errorMsg = "[Line " + to_string(token.line) + ", Col " + to_string(token.column) +
+                      "] Error";
+    if (token.type == TOK_EOF) {
+        errorMsg += " at end: " + message;
+    } else {
+        errorMsg += " at '" + token.text() + "': " + message;
     }
+    return ParseError(errorMsg);
+}
 
-    // Check if the current token is one of several types
-    bool check(const vector<TokenType>& types) {
-        for (TokenType type : types) {
-            if (check(type)) {
-                return true;
-            }
+// Error recovery: advance until we find a statement boundary
+void Parser::synchronize() {
+    advance();
+    while (!isAtEnd()) {
+        if (previous().type == TOK_SEMICOLON) return;
+        switch (peek().type) {
+            case TOK_TACTIC:
+            case TOK_SQUAD:
+            case TOK_TROOP:
+            case TOK_AMMO:
+            case TOK_CODENAME:
+            case TOK_STATUS:
+            case TOK_BRIEF:
+            case TOK_INTEL:
+            case TOK_EVALUATE:
+            case TOK_DEPLOY:
+            case TOK_MAINTAIN:
+            case TOK_RETREAT:
+                return;
+            default:
+                // Do nothing, just advance
+                break;
         }
-        return false;
+        advance();
     }
+}
 
-    // If the current token matches one of the types, consume it and return true
-    bool match(const vector<TokenType>& types) {
-        for (TokenType type : types) {
-            if (check(type)) {
-                advance();
-                return true;
-            }
+// =============================================================================
+// 2. DECLARATIONS AND STATEMENTS
+// =============================================================================
+
+// Program -> DeclarationList EOF
+// (parse() calls declaration() in a loop)
+
+// Declaration -> IncludeStatement | FunctionDefinition | VariableDeclaration
+void Parser::declaration() {
+    try {
+        if (check(TOK_SUPPLY)) {
+            includeStatement();
+        } else if (check(TOK_TACTIC)) {
+            functionDefinition();
+        } else if (checkType()) {
+            program.globals.push_back(variableDeclaration());
+        } else {
+            // If it's none of the above, it's an error.
+            throw error(peek(), "Expected a declaration (#supply, tactic, or variable type).");
         }
-        return false;
+    } catch (ParseError& e) {
+        errors << e.what() << endl;
+        hadError = true;
+        synchronize(); // Recover to the next statement
     }
+}
 
-    // Consume a specific token type, or throw an error
-    Token consume(TokenType type, const string& message) {
-        if (check(type)) return advance();
-        throw error(peek(), message);
-    }
+// IncludeStatement -> SUPPLY IDENTIFIER
+void Parser::includeStatement() {
+    consume(TOK_SUPPLY, "Expected '#supply'.");
+    Token module = consume(TOK_IDENTIFIER, "Expected identifier after '#supply'.");
+    program.supplies.push_back(module.symbol);
+    // Note: No semicolon in our grammar for #supply (based on tokens)
+    // If it needs one, add: consume(TOK_SEMICOLON, "Expected ';'.");
+}
 
-    // --- Error Handling ---
+// Whether a Type starts here
+bool Parser::checkType() {
+    return check({TOK_SQUAD, TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS});
+}
 
-    // Create and return a ParseError
-    ParseError error(const Token& token, const string& message) {
-        string errorMsg = "[Line " + to_string(token.line) + ", Col " + to_string(token.column) +
-                          "] Error";
-        if (token.type == TOK_EOF) {
-            errorMsg += " at end: " + message;
-        } else {
-            errorMsg += " at '" + token.lexeme + "': " + message;
-        }
-        return ParseError(errorMsg);
+// Type -> SQUAD? (TROOP | AMMO | CODENAME | STATUS)
+ValueType Parser::type() {
+    bool squad = match({TOK_SQUAD});
+    if (!match({TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS})) {
+        throw error(peek(), "Expected a type.");
+    }
+    switch (previous().type) {
+        case TOK_TROOP:    return squad ? VAL_TROOP_SQUAD : VAL_TROOP;
+        case TOK_AMMO:     return squad ? VAL_AMMO_SQUAD : VAL_AMMO;
+        default:
+            if (squad) throw error(previous(), "A squad holds troop or ammo.");
+            return previous().type == TOK_CODENAME ? VAL_CODENAME : VAL_STATUS;
     }
+}
 
-    // Error recovery: advance until we find a statement boundary
-    void synchronize() {
-        advance();
-        while (!isAtEnd()) {
-            if (previous().type == TOK_SEMICOLON) return;
-            switch (peek().type) {
-                case TOK_TACTIC:
-                case TOK_TROOP:
-                case TOK_AMMO:
-                case TOK_CODENAME:
-                case TOK_STATUS:
-                case TOK_BRIEF:
-                case TOK_INTEL:
-                case TOK_EVALUATE:
-                case TOK_DEPLOY:
-                case TOK_MAINTAIN:
-                case TOK_RETREAT:
-                    return;
-                default:
-                    // Do nothing, just advance
-                    break;
-            }
-            advance();
-        }
+// VariableDeclaration -> Type IDENTIFIER (ASSIGN Expr)? SEMICOLON
+unique_ptr<Stmt> Parser::variableDeclaration() {
+    int line = peek().line;
+    ValueType varType = type();
+    
+    Token name = consume(TOK_IDENTIFIER, "Expected variable name.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_VAR, line));
+    stmt->varType = varType;
+    stmt->name = name.symbol;
+
+    if (match({TOK_ASSIGN})) {
+        stmt->expr = expr(); // Parse the initializer expression
     }
+    
+    consume(TOK_SEMICOLON, "Expected ';' after variable declaration.");
+    return stmt;
+}
 
-    // --- Grammar Rule Functions (Top-Down) ---
-    // These functions match your grammar, rule by rule.
-
-    // Program -> DeclarationList EOF
-    // (We'll call declaration() in a loop in the public parse() function)
-
-    // Declaration -> IncludeStatement | FunctionDefinition | VariableDeclaration
-    void declaration() {
-        try {
-            if (check(TOK_SUPPLY)) {
-                includeStatement();
-            } else if (check(TOK_TACTIC)) {
-                functionDefinition();
-            } else if (check({TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS})) {
-                variableDeclaration();
-            } else {
-                // If it's none of the above, it's an error.
-                throw error(peek(), "Expected a declaration (#supply, tactic, or variable type).");
+// FunctionDefinition -> TACTIC (IDENTIFIER | CAMPAIGN) LPAREN ParamList? RPAREN BlockStatement
+void Parser::functionDefinition() {
+    Token tactic = consume(TOK_TACTIC, "Expected 'tactic'.");
+    Function function;
+    function.line = tactic.line;
+    
+    // Handle 'campaign' as a special IDENTIFIER
+    if (!match({TOK_IDENTIFIER, TOK_CAMPAIGN})) {
+       throw error(peek(), "Expected function name or 'campaign'.");
+    }
+    function.name = previous().type == TOK_CAMPAIGN ? Interner::current().intern("campaign") : previous().symbol;
+    
+    consume(TOK_LPAREN, "Expected '(' after function name.");
+    
+    // ParamList? -> Param (COMMA Param)*
+    if (!check(TOK_RPAREN)) {
+        do {
+            // Param -> Type IDENTIFIER
+            if (!checkType()) {
+                throw error(peek(), "Expected parameter type.");
             }
-        } catch (ParseError& e) {
-            cerr << e.what() << endl;
-            synchronize(); // Recover to the next statement
-        }
+            Param param;
+            param.type = type();
+            param.name = consume(TOK_IDENTIFIER, "Expected parameter name.").symbol;
+            function.params.push_back(param);
+        } while (match({TOK_COMMA}));
     }
+    
+    consume(TOK_RPAREN, "Expected ')' after parameters.");
 
-    // IncludeStatement -> SUPPLY IDENTIFIER
-    void includeStatement() {
-        consume(TOK_SUPPLY, "Expected '#supply'.");
-        consume(TOK_IDENTIFIER, "Expected identifier after '#supply'.");
-        // Note: No semicolon in our grammar for #supply (based on tokens)
-        // If it needs one, add: consume(TOK_SEMICOLON, "Expected ';'.");
+    if (skimBodies) {
+        skipBody(function); // Parsed later by parseBody(), if needed
+    } else {
+        function.body = block(); // Parse function body
     }
+    program.functions.push_back(move(function));
+}
 
-    // VariableDeclaration -> Type IDENTIFIER (ASSIGN Expr)? SEMICOLON
-    void variableDeclaration() {
-        // The 'Type' token (TROOP, AMMO, etc.) was already checked.
-        advance(); // Consume the type token
-        
-        consume(TOK_IDENTIFIER, "Expected variable name.");
+// Skim pass: record the body's token range by brace matching
+void Parser::skipBody(Function& function) {
+    if (!check(TOK_LBRACE)) throw error(peek(), "Expected '{' to begin block.");
+    function.bodyBegin = current;
+    int depth = 0;
+    do {
+        if (isAtEnd()) throw error(peek(), "Expected '}' to end block.");
+        if (peek().type == TOK_LBRACE) depth++;
+        else if (peek().type == TOK_RBRACE) depth--;
+        advance();
+    } while (depth > 0);
+    function.bodyEnd = current - 1;
+}
 
-        if (match({TOK_ASSIGN})) {
-            expr(); // Parse the initializer expression
-        }
-        
-        consume(TOK_SEMICOLON, "Expected ';' after variable declaration.");
-    }
+// StatementList -> (Statement)*
+// (This is handled by the block() function)
 
-    // FunctionDefinition -> TACTIC (IDENTIFIER | CAMPAIGN) LPAREN ParamList? RPAREN BlockStatement
-    void functionDefinition() {
-        consume(TOK_TACTIC, "Expected 'tactic'.");
-        
-        // Handle 'campaign' as a special IDENTIFIER
-        if (!match({TOK_IDENTIFIER, TOK_CAMPAIGN})) {
-           throw error(peek(), "Expected function name or 'campaign'.");
-        }
-        
-        consume(TOK_LPAREN, "Expected '(' after function name.");
-        
-        // ParamList? -> Param (COMMA Param)*
-        if (!check(TOK_RPAREN)) {
-            do {
-                // Param -> Type IDENTIFIER
-                if (!match({TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS})) {
-                    throw error(peek(), "Expected parameter type.");
-                }
-                consume(TOK_IDENTIFIER, "Expected parameter name.");
-            } while (match({TOK_COMMA}));
-        }
-        
-        consume(TOK_RPAREN, "Expected ')' after parameters.");
-        block(); // Parse function body
+// BlockStatement -> LBRACE StatementList RBRACE
+unique_ptr<Stmt> Parser::block() {
+    Token brace = consume(TOK_LBRACE, "Expected '{' to begin block.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_BLOCK, brace.line));
+    // StatementList
+    while (!check(TOK_RBRACE) && !isAtEnd()) {
+        stmt->statements.push_back(statement());
     }
+    consume(TOK_RBRACE, "Expected '}' to end block.");
+    return stmt;
+}
 
-    // StatementList -> (Statement)*
-    // (This is handled by the block() function)
+// Statement -> (all statement types)
+unique_ptr<Stmt> Parser::statement() {
+    if (check(TOK_LBRACE)) {
+        return block();
+    } else if (checkType()) {
+        return variableDeclaration();
+    } else if (check(TOK_EVALUATE)) {
+        return ifStatement();
+    } else if (check(TOK_MAINTAIN)) {
+        return whileStatement();
+    } else if (check(TOK_DEPLOY)) {
+        return forStatement();
+    } else if (check(TOK_BRIEF)) {
+        return outputStatement();
+    } else if (check(TOK_INTEL)) {
+        return inputStatement();
+    } else if (check(TOK_RETREAT)) {
+        return returnStatement();
+    } else if (check(TOK_ABORT)) {
+        return breakStatement();
+    } else {
+        // Default to an expression statement (e.g., assignment or function call)
+        return expressionStatement();
+    }
+}
 
-    // BlockStatement -> LBRACE StatementList RBRACE
-    void block() {
-        consume(TOK_LBRACE, "Expected '{' to begin block.");
-        // StatementList
-        while (!check(TOK_RBRACE) && !isAtEnd()) {
-            statement();
-        }
-        consume(TOK_RBRACE, "Expected '}' to end block.");
-    }
-
-    // Statement -> (all statement types)
-    void statement() {
-        if (check(TOK_LBRACE)) {
-            block();
-        } else if (check({TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS})) {
-            variableDeclaration();
-        } else if (check(TOK_EVALUATE)) {
-            ifStatement();
-        } else if (check(TOK_MAINTAIN)) {
-            whileStatement();
-        } else if (check(TOK_DEPLOY)) {
-            forStatement();
-        } else if (check(TOK_BRIEF)) {
-            outputStatement();
-        } else if (check(TOK_INTEL)) {
-            inputStatement();
-        } else if (check(TOK_RETREAT)) {
-            returnStatement();
-        } else if (check(TOK_ABORT)) {
-            breakStatement();
+// IfStatement -> EVALUATE LPAREN Expr RPAREN BlockStatement ElsePart?
+unique_ptr<Stmt> Parser::ifStatement() {
+    Token keyword = consume(TOK_EVALUATE, "Expected 'evaluate'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_IF, keyword.line));
+    consume(TOK_LPAREN, "Expected '(' after 'evaluate'.");
+    stmt->expr = expr();
+    consume(TOK_RPAREN, "Expected ')' after condition.");
+    stmt->body = block();
+
+    // ElsePart? -> ADJUST IfStatement | ADJUST BlockStatement
+    if (match({TOK_ADJUST})) {
+        if (check(TOK_EVALUATE)) {
+            stmt->elseBranch = ifStatement(); // Handle 'adjust evaluate' (else if)
         } else {
-            // Default to an expression statement (e.g., assignment or function call)
-            expressionStatement();
+            stmt->elseBranch = block(); // Handle 'adjust' (else)
         }
     }
+    return stmt;
+}
 
-    // IfStatement -> EVALUATE LPAREN Expr RPAREN BlockStatement ElsePart?
-    void ifStatement() {
-        consume(TOK_EVALUATE, "Expected 'evaluate'.");
-        consume(TOK_LPAREN, "Expected '(' after 'evaluate'.");
-        expr();
-        consume(TOK_RPAREN, "Expected ')' after condition.");
-        block();
-
-        // ElsePart? -> ADJUST IfStatement | ADJUST BlockStatement
-        if (match({TOK_ADJUST})) {
-            if (check(TOK_EVALUATE)) {
-                ifStatement(); // Handle 'adjust evaluate' (else if)
-            } else {
-                block(); // Handle 'adjust' (else)
-            }
-        }
+// WhileStatement -> MAINTAIN LPAREN Expr RPAREN BlockStatement
+unique_ptr<Stmt> Parser::whileStatement() {
+    Token keyword = consume(TOK_MAINTAIN, "Expected 'maintain'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_WHILE, keyword.line));
+    consume(TOK_LPAREN, "Expected '(' after 'maintain'.");
+    stmt->expr = expr();
+    consume(TOK_RPAREN, "Expected ')' after condition.");
+    stmt->body = block();
+    return stmt;
+}
+
+// ForStatement -> DEPLOY PARALLEL? LPAREN ForInit ForCond ForUpdate RPAREN BlockStatement
+// (The Resolver checks that a parallel loop has the counting form)
+unique_ptr<Stmt> Parser::forStatement() {
+    Token keyword = consume(TOK_DEPLOY, "Expected 'deploy'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_FOR, keyword.line));
+    stmt->parallel = match({TOK_PARALLEL});
+    consume(TOK_LPAREN, "Expected '(' after 'deploy'.");
+
+    // ForInit -> VariableDeclaration | ExpressionStatement | SEMICOLON
+    if (match({TOK_SEMICOLON})) {
+        // No initializer
+    } else if (checkType()) {
+        stmt->init = variableDeclaration();
+    } else {
+        stmt->init = expressionStatement();
     }
 
-    // WhileStatement -> MAINTAIN LPAREN Expr RPAREN BlockStatement
-    void whileStatement() {
-        consume(TOK_MAINTAIN, "Expected 'maintain'.");
-        consume(TOK_LPAREN, "Expected '(' after 'maintain'.");
-        expr();
-        consume(TOK_RPAREN, "Expected ')' after condition.");
-        block();
+    // ForCond -> Expr? SEMICOLON
+    if (!check(TOK_SEMICOLON)) {
+        stmt->expr = expr();
     }
+    consume(TOK_SEMICOLON, "Expected ';' after loop condition.");
 
-    // ForStatement -> DEPLOY LPAREN ForInit ForCond ForUpdate RPAREN BlockStatement
-    void forStatement() {
-        consume(TOK_DEPLOY, "Expected 'deploy'.");
-        consume(TOK_LPAREN, "Expected '(' after 'deploy'.");
+    // ForUpdate -> Expr?
+    if (!check(TOK_RPAREN)) {
+        stmt->update = expr();
+    }
+    consume(TOK_RPAREN, "Expected ')' after for clauses.");
 
-        // ForInit -> VariableDeclaration | ExpressionStatement | SEMICOLON
-        if (match({TOK_SEMICOLON})) {
-            // No initializer
-        } else if (check({TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS})) {
-            variableDeclaration();
-        } else {
-            expressionStatement();
-        }
+    stmt->body = block();
+    return stmt;
+}
 
-        // ForCond -> Expr? SEMICOLON
-        if (!check(TOK_SEMICOLON)) {
-            expr();
-        }
-        consume(TOK_SEMICOLON, "Expected ';' after loop condition.");
+// OutputStatement -> BRIEF Expr SEMICOLON
+unique_ptr<Stmt> Parser::outputStatement() {
+    Token keyword = consume(TOK_BRIEF, "Expected 'brief'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_BRIEF, keyword.line));
+    stmt->expr = expr();
+    consume(TOK_SEMICOLON, "Expected ';' after 'brief' statement.");
+    return stmt;
+}
 
-        // ForUpdate -> Expr?
-        if (!check(TOK_RPAREN)) {
-            expr();
-        }
-        consume(TOK_RPAREN, "Expected ')' after for clauses.");
+// InputStatement -> INTEL IDENTIFIER SEMICOLON
+unique_ptr<Stmt> Parser::inputStatement() {
+    Token keyword = consume(TOK_INTEL, "Expected 'intel'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_INTEL, keyword.line));
+    stmt->name = consume(TOK_IDENTIFIER, "Expected identifier after 'intel'.").symbol;
+    consume(TOK_SEMICOLON, "Expected ';' after 'intel' statement.");
+    return stmt;
+}
 
-        block();
+// ReturnStatement -> RETREAT Expr? SEMICOLON
+unique_ptr<Stmt> Parser::returnStatement() {
+    Token keyword = consume(TOK_RETREAT, "Expected 'retreat'.");
+    unique_ptr<Stmt> stmt(new Stmt(STMT_RETREAT, keyword.line));
+    if (!check(TOK_SEMICOLON)) {
+        stmt->expr = expr();
     }
+    consume(TOK_SEMICOLON, "Expected ';' after 'retreat' statement.");
+    return stmt;
+}
 
-    // OutputStatement -> BRIEF Expr SEMICOLON
-    void outputStatement() {
-        consume(TOK_BRIEF, "Expected 'brief'.");
-        expr();
-        consume(TOK_SEMICOLON, "Expected ';' after 'brief' statement.");
-    }
+// BreakStatement -> ABORT SEMICOLON
+unique_ptr<Stmt> Parser::breakStatement() {
+    Token keyword = consume(TOK_ABORT, "Expected 'abort'.");
+    consume(TOK_SEMICOLON, "Expected ';' after 'abort'.");
+    return unique_ptr<Stmt>(new Stmt(STMT_ABORT, keyword.line));
+}
 
-    // InputStatement -> INTEL IDENTIFIER SEMICOLON
-    void inputStatement() {
-        consume(TOK_INTEL, "Expected 'intel'.");
-        consume(TOK_IDENTIFIER, "Expected identifier after 'intel'.");
-        consume(TOK_SEMICOLON, "Expected ';' after 'intel' statement.");
-    }
+// ExpressionStatement -> Expr SEMICOLON
+unique_ptr<Stmt> Parser::expressionStatement() {
+    unique_ptr<Stmt> stmt(new Stmt(STMT_EXPR, peek().line));
+    stmt->expr = expr();
+    consume(TOK_SEMICOLON, "Expected ';' after expression.");
+    return stmt;
+}
 
-    // ReturnStatement -> RETREAT Expr? SEMICOLON
-    void returnStatement() {
-        consume(TOK_RETREAT, "Expected 'retreat'.");
-        if (!check(TOK_SEMICOLON)) {
-            expr();
-        }
-        consume(TOK_SEMICOLON, "Expected ';' after 'retreat' statement.");
-    }
+// =============================================================================
+// 3. EXPRESSIONS (BY PRECEDENCE)
+// =============================================================================
 
-    // BreakStatement -> ABORT SEMICOLON
-    void breakStatement() {
-        consume(TOK_ABORT, "Expected 'abort'.");
-        consume(TOK_SEMICOLON, "Expected ';' after 'abort'.");
-    }
-    
-    // ExpressionStatement -> Expr SEMICOLON
-    void expressionStatement() {
-        expr();
-        consume(TOK_SEMICOLON, "Expected ';' after expression.");
-    }
+// See TacticLang.grammar for the precedence table
 
-    // --- Expression Parsing (by precedence) ---
-    // See TacticLang.grammar for the precedence table
+// Builds a BINARY node from the operator just consumed
+unique_ptr<Expr> Parser::binary(unique_ptr<Expr> left, unique_ptr<Expr> right, const Token& op) {
+    unique_ptr<Expr> node(new Expr(EXPR_BINARY, op.line));
+    node->op = op.type;
+    node->left = move(left);
+    node->right = move(right);
+    return node;
+}
+
+// Expr -> LogicalOr
+unique_ptr<Expr> Parser::expr() {
+    return logicalOr();
+}
 
-    // Expr -> LogicalOr
-    void expr() {
-        logicalOr();
+// LogicalOr -> LogicalAnd (OR LogicalAnd)*//a*5+2||2*3&&5>2<2
+unique_ptr<Expr> Parser::logicalOr() {
+    unique_ptr<Expr> left = logicalAnd();
+    while (match({TOK_OR})) {
+        Token op = previous();
+        left = binary(move(left), logicalAnd(), op);
     }
+    return left;
+}
 
-    // LogicalOr -> LogicalAnd (OR LogicalAnd)*//a*5+2||2*3&&5>2<2
-    void logicalOr() {
-        logicalAnd();
-        while (match({TOK_OR})) {
-            logicalAnd();
-        }
+// LogicalAnd -> Equality (AND Equality)*
+unique_ptr<Expr> Parser::logicalAnd() {
+    unique_ptr<Expr> left = equality();
+    while (match({TOK_AND})) {
+        Token op = previous();
+        left = binary(move(left), equality(), op);
     }
+    return left;
+}
 
-    // LogicalAnd -> Equality (AND Equality)*
-    void logicalAnd() {
-        equality();
-        while (match({TOK_AND})) {
-            equality();
-        }
+// Equality -> Relational ( (EQUAL | NOT_EQUAL) Relational )*
+unique_ptr<Expr> Parser::equality() {
+    unique_ptr<Expr> left = relational();
+    while (match({TOK_EQUAL, TOK_NOT_EQUAL})) {
+        Token op = previous();
+        left = binary(move(left), relational(), op);
     }
+    return left;
+}
 
-    // Equality -> Relational ( (EQUAL | NOT_EQUAL) Relational )*
-    void equality() {
-        relational();
-        while (match({TOK_EQUAL, TOK_NOT_EQUAL})) {
-            relational();
-        }
+// Relational -> Additive ( (LESS | GREATER | LESS_EQUAL | GREATER_EQUAL) Additive )*
+unique_ptr<Expr> Parser::relational() {
+    unique_ptr<Expr> left = additive();
+    while (match({TOK_LESS, TOK_GREATER, TOK_LESS_EQUAL, TOK_GREATER_EQUAL})) {
+        Token op = previous();
+        left = binary(move(left), additive(), op);
     }
+    return left;
+}
 
-    // Relational -> Additive ( (LESS | GREATER | LESS_EQUAL | GREATER_EQUAL) Additive )*
-    void relational() {
-        additive();
-        while (match({TOK_LESS, TOK_GREATER, TOK_LESS_EQUAL, TOK_GREATER_EQUAL})) {
-            additive();
-        }
+// Additive -> Multiplicative ( (PLUS | MINUS) Multiplicative )*
+unique_ptr<Expr> Parser::additive() {
+    unique_ptr<Expr> left = multiplicative();
+    while (match({TOK_PLUS, TOK_MINUS})) {
+        Token op = previous();
+        left = binary(move(left), multiplicative(), op);
     }
+    return left;
+}
 
-    // Additive -> Multiplicative ( (PLUS | MINUS) Multiplicative )*
-    void additive() {
-        multiplicative();
-        while (match({TOK_PLUS, TOK_MINUS})) {
-            multiplicative();
-        }
+// Multiplicative -> Unary ( (MULTIPLY | DIVIDE | MODULO) Unary )*
+unique_ptr<Expr> Parser::multiplicative() {
+    unique_ptr<Expr> left = unary();
+    while (match({TOK_MULTIPLY, TOK_DIVIDE, TOK_MODULO})) {
+        Token op = previous();
+        left = binary(move(left), unary(), op);
     }
+    return left;
+}
 
-    // Multiplicative -> Unary ( (MULTIPLY | DIVIDE | MODULO) Unary )*
-    void multiplicative() {
-        unary();
-        while (match({TOK_MULTIPLY, TOK_DIVIDE, TOK_MODULO})) {
-            unary();
-        }
+// Unary -> (NOT | MINUS) Unary | Postfix
+unique_ptr<Expr> Parser::unary() {
+    if (match({TOK_NOT, TOK_MINUS})) {
+        Token op = previous();
+        unique_ptr<Expr> node(new Expr(EXPR_UNARY, op.line));
+        node->op = op.type;
+        node->left = unary(); // Recursive call for stacked unary ops (e.g., !!true)
+        return node;
     }
+    return postfix(primary());
+}
 
-    // Unary -> (NOT | MINUS) Unary | Primary
-    void unary() {
-        if (match({TOK_NOT, TOK_MINUS})) {
-            unary(); // Recursive call for stacked unary ops (e.g., !!true)
-        } else {
-            primary();
-        }
+// Postfix -> Primary (LBRACKET Expr RBRACKET)*
+unique_ptr<Expr> Parser::postfix(unique_ptr<Expr> squad) {
+    while (match({TOK_LBRACKET})) {
+        unique_ptr<Expr> node(new Expr(EXPR_INDEX, previous().line));
+        node->left = move(squad);
+        node->right = expr();
+        consume(TOK_RBRACKET, "Expected ']' after index.");
+        squad = move(node);
     }
+    return squad;
+}
 
-    // Primary -> ...
-    void primary() {
-        if (match({TOK_INTEGER, TOK_DOUBLE, TOK_STRING, TOK_TRUE, TOK_FALSE})) {
-            return; // Literal value, we're done
-        }
+// Primary -> ...
+unique_ptr<Expr> Parser::primary() {
+    if (match({TOK_INTEGER, TOK_DOUBLE, TOK_STRING, TOK_TRUE, TOK_FALSE})) {
+        return literal(previous()); // Literal value, we're done
+    }
 
-        // Check for function call: IDENTIFIER LPAREN ...
-        if (check(TOK_IDENTIFIER) && tokens[current + 1].type == TOK_LPAREN) {
-            advance(); // consume IDENTIFIER
-            advance(); // consume LPAREN
-            // ArgList? -> Expr (COMMA Expr)*
-            if (!check(TOK_RPAREN)) {
-                do {
-                    expr();
-                } while (match({TOK_COMMA}));
-            }
-            consume(TOK_RPAREN, "Expected ')' after function call arguments.");
-            return;
-        }
-        
-        // Check for assignment: IDENTIFIER ASSIGN ...
-        if (check(TOK_IDENTIFIER) && tokens[current + 1].type == TOK_ASSIGN) {
-            advance(); // consume IDENTIFIER
-            advance(); // consume ASSIGN
-            expr(); // Parse the right-hand side
-            return;
+    // Check for function call: IDENTIFIER LPAREN ...
+    if (check(TOK_IDENTIFIER) && tokens[current + 1].type == TOK_LPAREN) {
+        Token name = advance(); // consume IDENTIFIER
+        advance(); // consume LPAREN
+        unique_ptr<Expr> call(new Expr(EXPR_CALL, name.line));
+        call->name = name.symbol;
+        // ArgList? -> Expr (COMMA Expr)*
+        if (!check(TOK_RPAREN)) {
+            do {
+                call->args.push_back(expr());
+            } while (match({TOK_COMMA}));
         }
-
-        // Must be a simple variable
-        if (match({TOK_IDENTIFIER})) {
-            return; 
+        consume(TOK_RPAREN, "Expected ')' after function call arguments.");
+        return call;
+    }
+    
+    // Check for assignment: IDENTIFIER ASSIGN ...
+    if (check(TOK_IDENTIFIER) && tokens[current + 1].type == TOK_ASSIGN) {
+        Token name = advance(); // consume IDENTIFIER
+        advance(); // consume ASSIGN
+        unique_ptr<Expr> assign(new Expr(EXPR_ASSIGN, name.line));
+        assign->name = name.symbol;
+        assign->right = expr(); // Parse the right-hand side
+        return assign;
+    }
+
+    // Must be a simple variable
+    if (match({TOK_IDENTIFIER})) {
+        unique_ptr<Expr> variable(new Expr(EXPR_VARIABLE, previous().line));
+        variable->name = previous().symbol;
+
+        // Element assignment: IDENTIFIER LBRACKET Expr RBRACKET ASSIGN Expr
+        // (a plain index is left for postfix())
+        if (!match({TOK_LBRACKET})) return variable;
+        unique_ptr<Expr> index = expr();
+        consume(TOK_RBRACKET, "Expected ']' after index.");
+        if (match({TOK_ASSIGN})) {
+            unique_ptr<Expr> assign(new Expr(EXPR_SET_INDEX, variable->line));
+            assign->name = variable->name;
+            assign->left = move(index);
+            assign->right = expr();
+            return assign;
         }
+        unique_ptr<Expr> element(new Expr(EXPR_INDEX, variable->line));
+        element->left = move(variable);
+        element->right = move(index);
+        return element;
+    }
 
-        // Grouping: ( Expr )
-        if (match({TOK_LPAREN})) {
-            expr(); // Parse the expression inside the parentheses
-            consume(TOK_RPAREN, "Expected ')' after expression.");
-            return;
+    // Squad literal: LBRACKET ArgList? RBRACKET
+    if (match({TOK_LBRACKET})) {
+        unique_ptr<Expr> squad(new Expr(EXPR_SQUAD, previous().line));
+        if (!check(TOK_RBRACKET)) {
+            do {
+                squad->args.push_back(expr());
+            } while (match({TOK_COMMA}));
         }
+        consume(TOK_RBRACKET, "Expected ']' after squad elements.");
+        return squad;
+    }
 
-        // If we get here, no rule matched.
-        throw error(peek(), "Expected expression (literal, variable, grouping).");
+    // Grouping: ( Expr )
+    if (match({TOK_LPAREN})) {
+        unique_ptr<Expr> inner = expr(); // Parse the expression inside the parentheses
+        consume(TOK_RPAREN, "Expected ')' after expression.");
+        return inner;
     }
 
-public:
-    // --- Public Interface ---
-    
-    Parser(const vector<Token>& tokens) : tokens(tokens) {}
-
-    // Public entry point to start parsing
-    void parse() {
-        try {
-            // Program -> DeclarationList EOF
-            while (!isAtEnd()) {
-                declaration();
+    // If we get here, no rule matched.
+    throw error(peek(), "Expected expression (literal, variable, grouping).");
+}
+
+// Converts a literal token into its runtime value
+unique_ptr<Expr> Parser::literal(const Token& token) {
+    unique_ptr<Expr> node(new Expr(EXPR_LITERAL, token.line));
+    switch (token.type) {
+        case TOK_INTEGER: {
+            const string& digits = Interner::current().name(token.symbol);
+            if (digits.size() > 10 || stoll(digits) > 2147483647LL) {
+                throw error(token, "Integer literal is too large for troop.");
             }
-            cout << "Parsing complete. Syntax is valid." << endl;
-        } catch (ParseError& e) {
-            // Error was already printed by synchronize() or declaration()
-            // We just stop the parse.
-            cerr << "Parsing failed." << endl;
+            node->literal = Value::makeTroop(stoi(digits));
+            break;
         }
+        case TOK_DOUBLE: {
+            // strtod reports a literal past the range of a double with ERANGE,
+            // where stod would throw past the parser. Subnormals are kept.
+            errno = 0;
+            double ammo = strtod(Interner::current().name(token.symbol).c_str(), nullptr);
+            if (errno == ERANGE && ammo == HUGE_VAL) throw error(token, "Decimal literal is too large for ammo.");
+            if (errno == ERANGE && ammo == 0.0) throw error(token, "Decimal literal is too small for ammo; it would be 0.");
+            node->literal = Value::makeAmmo(ammo);
+            break;
+        }
+        case TOK_STRING:  node->literal = Value::makeCodename(Interner::current().name(token.symbol)); break;
+        case TOK_TRUE:    node->literal = Value::makeStatus(true); break;
+        default:          node->literal = Value::makeStatus(false); break;
     }
-};
+    return node;
+}
 
 // =============================================================================
-// 2. UTILITY FUNCTIONS
+// 4. PUBLIC INTERFACE
 // =============================================================================
 
-string readFile(const string& filepath) {
-    ifstream file(filepath);
-    if (!file.is_open()) {
-        cerr << "Error: Could not open file '" << filepath << "'" << endl;
-        return "";
-    }
-    stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
-    return buffer.str();
+// Parses a body the skim pass deferred. Returns false on a syntax error.
+bool Parser::parseBody(Function& function) {
+    if (function.body) return true;
+    int resume = current;
+    current = function.bodyBegin;
+    try {
+        function.body = block();
+        if (current != function.bodyEnd + 1) throw error(tokens[function.bodyEnd], "Expected '}' to end block.");
+    } catch (ParseError& e) {
+        errors << e.what() << endl;
+        hadError = true;
+        function.body.reset();
+    }
+    current = resume;
+    return function.body != nullptr;
 }
 
-// =============================================================================
-// 3. MAIN FUNCTION
-// =============================================================================
-
-int main() {
-    // File path from your original code
-    string filepath = "D:\\Faculty\\Y4\\S1\\Compiler\\TacticLang\\soldier.tac";
-    
-    cout << "TacticLang Compiler" << endl;
-    cout << "===================" << endl;
-    cout << "Reading file: " << filepath << endl;
-
-    // --- 1. Scanning ---
-    string sourceCode = readFile(filepath);
-    if (sourceCode.empty()) {
-        cerr << "Error: Source file is empty or could not be read." << endl;
-        return 1;
-    }
-
-    cout << "File read successfully. Scanning..." << endl;
-    Scanner scanner(sourceCode);
-    vector<Token> tokens = scanner.scanTokens();
-
-    // Check for scanner errors
-    int errorCount = 0;
-    for (const Token& token : tokens) {
-        if (token.type == TOK_ERROR) {
-            cerr << "Scanner Error: " << token.lexeme << " at line " << token.line << endl;
-            errorCount++;
+// Public entry point to start parsing.
+// Returns true when the whole file parsed without syntax errors.
+bool Parser::parse() {
+    try {
+        // Program -> DeclarationList EOF
+        while (!isAtEnd()) {
+            declaration();
         }
+    } catch (ParseError& e) {
+        // Error was already printed by synchronize() or declaration()
+        // We just stop the parse.
+        hadError = true;
     }
-
-    if (errorCount > 0) {
-        cerr << "Scanning failed with " << errorCount << " errors." << endl;
-        return 1;
+    if (hadError) {
+        errors << "Parsing failed." << endl;
+        return false;
     }
-    
-    cout << "Scanning complete. " << tokens.size() << " tokens found." << endl << endl;
-
-    // --- 2. Parsing ---
-    cout << "Parsing..." << endl;
-    Parser parser(tokens);
-    parser.parse(); // This will print "Parsing complete" or any errors.
-
-    cout << endl << "Compiler run finished." << endl;
-
-    return 0;
-}
\ No newline at end of file
+    return true;
+}
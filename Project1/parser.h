@@ -0,0 +1,102 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "scanner.h"
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. PARSER CLASS DECLARATION
+// =============================================================================
+
+// Recursive-descent parser for one file's tokens, building its AST.
+// Syntax errors are written to 'errors'; parsing then resumes at the next
+// declaration so one run reports as many as it can.
+class Parser {
+private:
+    vector<Token> tokens;
+    int current = 0;
+    bool hadError = false;
+    bool skimBodies;
+    Program program;
+    ostream& errors;
+
+    // --- Parser Error Class ---
+    // A custom exception to throw on a syntax error
+    class ParseError : public runtime_error {
+    public:
+        ParseError(const string& message) : runtime_error(message) {}
+    };
+
+    // --- Helper Functions ---
+    Token peek();
+    Token previous();
+    bool isAtEnd();
+    Token advance();
+    bool check(TokenType type);
+    bool check(const vector<TokenType>& types);
+    bool match(const vector<TokenType>& types);
+    Token consume(TokenType type, const string& message);
+
+    // --- Error Handling ---
+    ParseError error(const Token& token, const string& message);
+    void synchronize();
+
+    // --- Grammar Rule Functions (Top-Down) ---
+    void declaration();
+    void includeStatement();
+    bool checkType();
+    ValueType type();
+    unique_ptr<Stmt> variableDeclaration();
+    void functionDefinition();
+    void skipBody(Function& function);
+    unique_ptr<Stmt> block();
+    unique_ptr<Stmt> statement();
+    unique_ptr<Stmt> ifStatement();
+    unique_ptr<Stmt> whileStatement();
+    unique_ptr<Stmt> forStatement();
+    unique_ptr<Stmt> outputStatement();
+    unique_ptr<Stmt> inputStatement();
+    unique_ptr<Stmt> returnStatement();
+    unique_ptr<Stmt> breakStatement();
+    unique_ptr<Stmt> expressionStatement();
+
+    // --- Expression Parsing (by precedence) ---
+    unique_ptr<Expr> binary(unique_ptr<Expr> left, unique_ptr<Expr> right, const Token& op);
+    unique_ptr<Expr> expr();
+    unique_ptr<Expr> logicalOr();
+    unique_ptr<Expr> logicalAnd();
+    unique_ptr<Expr> equality();
+    unique_ptr<Expr> relational();
+    unique_ptr<Expr> additive();
+    unique_ptr<Expr> multiplicative();
+    unique_ptr<Expr> unary();
+    unique_ptr<Expr> postfix(unique_ptr<Expr> squad);
+    unique_ptr<Expr> primary();
+    unique_ptr<Expr> literal(const Token& token);
+
+public:
+    // --- Public Interface ---
+
+    // With skimBodies set, parse() only records each tactic's signature and
+    // body token range; bodies are parsed on demand by parseBody().
+    Parser(vector<Token> tokens, ostream& errors, bool skimBodies = false)
+        : tokens(move(tokens)), skimBodies(skimBodies), errors(errors) {}
+
+    // Parses a body the skim pass deferred. Returns false on a syntax error.
+    bool parseBody(Function& function);
+
+    // Returns true when the whole file parsed without syntax errors
+    bool parse();
+
+    // The AST built by parse()
+    Program& getProgram() { return program; }
+};
+
+#endif // PARSER_H
@@ -0,0 +1,638 @@
+#include "resolver.h"
+#include "squad.h"
+#include <iostream>
+#include <algorithm>
+
+// --- Error Reporting ---
+void Resolver::error(int line, const string& message) {
+    errors << "[Line " << line << "] Error: " << message << endl;
+    hadError = true;
+}
+
+static string nameOf(Symbol symbol) {
+    return Interner::current().name(symbol);
+}
+
+// --- Scopes ---
+void Resolver::beginScope() {
+    scopeDepth++;
+}
+
+// Slots of a finished block are reused by the next one
+void Resolver::endScope() {
+    while (!locals.empty() && locals.back().depth == scopeDepth) {
+        locals.pop_back();
+        nextSlot--;
+    }
+    scopeDepth--;
+}
+
+int Resolver::declareLocal(Symbol name, ValueType type, int line) {
+    for (int i = (int)locals.size() - 1; i >= 0 && locals[i].depth == scopeDepth; i--) {
+        if (locals[i].name == name) {
+            error(line, "Variable '" + nameOf(name) + "' is already declared in this scope.");
+            break;
+        }
+    }
+    Local local = { name, nextSlot++, type, scopeDepth };
+    locals.push_back(local);
+    if (nextSlot > maxSlot) maxSlot = nextSlot;
+    return local.slot;
+}
+
+bool Resolver::lookup(Symbol name, int& slot, bool& global, ValueType& type) {
+    for (int i = (int)locals.size() - 1; i >= 0; i--) {
+        if (locals[i].name == name) {
+            slot = locals[i].slot;
+            global = false;
+            type = locals[i].type;
+            return true;
+        }
+    }
+    unordered_map<Symbol, int>::const_iterator found = globalIndex.find(name);
+    if (found == globalIndex.end()) return false;
+    slot = found->second;
+    global = true;
+    type = globalTypes[slot];
+    return true;
+}
+
+// --- Entry Points ---
+bool Resolver::resolve() {
+    declare();
+    for (Function& function : program.functions) {
+        if (function.body) resolveFunction(function);
+    }
+    checkParallelCalls();
+    return !hadError;
+}
+
+bool Resolver::declare() {
+    calls.clear();
+    effects.resize(program.functions.size());
+
+    // Tactics and globals are visible everywhere, regardless of order
+    for (size_t i = 0; i < program.functions.size(); i++) {
+        Function& function = program.functions[i];
+        if (!functionIndex.insert(make_pair(function.name, (int)i)).second) {
+            error(function.line, "Tactic '" + nameOf(function.name) + "' is already defined.");
+        }
+    }
+    for (size_t i = 0; i < program.globals.size(); i++) {
+        Stmt& global = *program.globals[i];
+        if (!globalIndex.insert(make_pair(global.name, (int)i)).second) {
+            error(global.line, "Global variable '" + nameOf(global.name) + "' is already declared.");
+        }
+        global.slot = (int)i;
+        global.global = true;
+        globalTypes.push_back(global.varType);
+    }
+
+    for (unique_ptr<Stmt>& global : program.globals) {
+        if (global->expr) expression(*global->expr);
+    }
+
+    unordered_map<Symbol, int>::const_iterator campaign = functionIndex.find(Interner::current().intern("campaign"));
+    program.campaign = campaign == functionIndex.end() ? -1 : campaign->second;
+    return !hadError;
+}
+
+// --- Tactics ---
+bool Resolver::resolveFunction(Function& function) {
+    bool hadErrorBefore = hadError;
+    hadError = false;
+    calls.clear();
+    if (!function.resolved) {
+        currentFunction = (int)(&function - &program.functions[0]);
+        this->function(function);
+        function.resolved = true;
+    }
+    bool ok = !hadError;
+    hadError = hadError || hadErrorBefore;
+    return ok;
+}
+
+void Resolver::function(Function& function) {
+    locals.clear();
+    scopeDepth = 0;
+    nextSlot = 0;
+    maxSlot = 0;
+    loopDepth = 0;
+    inFunction = true;
+
+    beginScope();
+    for (const Param& param : function.params) {
+        declareLocal(param.name, param.type, function.line);
+    }
+    // The body block shares the parameters' scope
+    for (unique_ptr<Stmt>& stmt : function.body->statements) {
+        statement(*stmt);
+    }
+    endScope();
+
+    function.frameSize = maxSlot;
+    inFunction = false;
+}
+
+// --- Statements ---
+void Resolver::statement(Stmt& stmt) {
+    switch (stmt.kind) {
+        case STMT_BLOCK:
+            beginScope();
+            for (unique_ptr<Stmt>& inner : stmt.statements) statement(*inner);
+            endScope();
+            break;
+
+        case STMT_VAR:
+            // The initializer cannot see the variable it initializes
+            if (stmt.expr) expression(*stmt.expr);
+            stmt.slot = declareLocal(stmt.name, stmt.varType, stmt.line);
+            stmt.global = false;
+            break;
+
+        case STMT_IF:
+            expression(*stmt.expr);
+            statement(*stmt.body);
+            if (stmt.elseBranch) statement(*stmt.elseBranch);
+            break;
+
+        case STMT_WHILE:
+            expression(*stmt.expr);
+            loopDepth++;
+            statement(*stmt.body);
+            loopDepth--;
+            break;
+
+        case STMT_FOR: {
+            bool counting = !stmt.parallel || countingLoop(stmt);
+            // The loop variable lives in its own scope around the loop
+            beginScope();
+            if (stmt.init) statement(*stmt.init);
+            if (stmt.expr) expression(*stmt.expr);
+            if (stmt.update) expression(*stmt.update);
+            loopDepth++;
+            statement(*stmt.body);
+            loopDepth--;
+            if (stmt.parallel && counting) parallelLoop(stmt);
+            endScope();
+            break;
+        }
+
+        case STMT_BRIEF:
+        case STMT_EXPR:
+            expression(*stmt.expr);
+            break;
+
+        case STMT_INTEL:
+            if (!lookup(stmt.name, stmt.slot, stmt.global, stmt.varType)) {
+                error(stmt.line, "Undefined variable '" + nameOf(stmt.name) + "'.");
+            }
+            noteEffect(stmt.line);
+            break;
+
+        case STMT_RETREAT:
+            if (!inFunction) {
+                error(stmt.line, "'retreat' outside of a tactic.");
+            }
+            if (stmt.expr) {
+                expression(*stmt.expr);
+                stmt.tailCall = stmt.expr->kind == EXPR_CALL;
+            }
+            break;
+
+        case STMT_ABORT:
+            if (loopDepth == 0) {
+                error(stmt.line, "'abort' outside of a loop.");
+            }
+            break;
+    }
+}
+
+// --- Expressions ---
+void Resolver::expression(Expr& expr) {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            break;
+
+        case EXPR_VARIABLE: {
+            ValueType type;
+            if (!lookup(expr.name, expr.slot, expr.global, type)) {
+                error(expr.line, "Undefined variable '" + nameOf(expr.name) + "'.");
+            }
+            break;
+        }
+
+        case EXPR_ASSIGN: {
+            expression(*expr.right);
+            ValueType type;
+            if (!lookup(expr.name, expr.slot, expr.global, type)) {
+                error(expr.line, "Undefined variable '" + nameOf(expr.name) + "'.");
+            }
+            if (expr.global) noteEffect(expr.line);
+            break;
+        }
+
+        case EXPR_CALL: {
+            for (unique_ptr<Expr>& arg : expr.args) expression(*arg);
+            unordered_map<Symbol, int>::const_iterator found = functionIndex.find(expr.name);
+            if (found == functionIndex.end()) {
+                builtin(expr);
+                break;
+            }
+            expr.function = found->second;
+            calls.push_back(expr.function);
+            if (inFunction) effects[currentFunction].callees.push_back(expr.function);
+            size_t arity = program.functions[expr.function].params.size();
+            if (expr.args.size() != arity) {
+                error(expr.line, "Tactic '" + nameOf(expr.name) + "' expects " + to_string(arity) +
+                                 " argument(s) but got " + to_string(expr.args.size()) + ".");
+            }
+            break;
+        }
+
+        case EXPR_UNARY:
+            expression(*expr.left);
+            break;
+
+        case EXPR_BINARY:
+            expression(*expr.left);
+            expression(*expr.right);
+            break;
+
+        case EXPR_INLINE:
+            // Only the linker creates these, after resolution
+            break;
+
+        case EXPR_SQUAD:
+            for (unique_ptr<Expr>& element : expr.args) expression(*element);
+            break;
+
+        case EXPR_INDEX:
+            expression(*expr.left);
+            expression(*expr.right);
+            break;
+
+        case EXPR_SET_INDEX: {
+            expression(*expr.left);
+            expression(*expr.right);
+            ValueType type;
+            if (!lookup(expr.name, expr.slot, expr.global, type)) {
+                error(expr.line, "Undefined variable '" + nameOf(expr.name) + "'.");
+            } else if (type != VAL_TROOP_SQUAD && type != VAL_AMMO_SQUAD) {
+                error(expr.line, "'" + nameOf(expr.name) + "' is not a squad.");
+            }
+            if (expr.global) noteEffect(expr.line);
+            break;
+        }
+
+        case EXPR_BUILTIN:
+            // Only builtin() creates these
+            break;
+    }
+}
+
+// A call to no tactic may name a built-in. Its arguments are resolved.
+void Resolver::builtin(Expr& call) {
+    Builtin found;
+    if (!findBuiltin(nameOf(call.name), found)) {
+        error(call.line, "Undefined tactic '" + nameOf(call.name) + "'.");
+        return;
+    }
+    call.kind = EXPR_BUILTIN;
+    call.function = found;
+    size_t arity = builtinArity(found);
+    if (call.args.size() != arity) {
+        error(call.line, "Built-in '" + nameOf(call.name) + "' expects " + to_string(arity) +
+                         " argument(s) but got " + to_string(call.args.size()) + ".");
+    }
+}
+
+// --- Parallel Loops ---
+
+// Records a global assignment or 'intel' in the tactic being resolved
+void Resolver::noteEffect(int line) {
+    if (inFunction && effects[currentFunction].line == 0) effects[currentFunction].line = line;
+}
+
+// deploy parallel (troop i = a; i < b; i = i + step)   with '<=' also allowed
+bool Resolver::countingLoop(const Stmt& stmt) {
+    const Stmt* init = stmt.init.get();
+    const Expr* cond = stmt.expr.get();
+    const Expr* update = stmt.update.get();
+    bool ok = init && init->kind == STMT_VAR && init->varType == VAL_TROOP && init->expr &&
+              cond && cond->kind == EXPR_BINARY && (cond->op == TOK_LESS || cond->op == TOK_LESS_EQUAL) &&
+              cond->left->kind == EXPR_VARIABLE && cond->left->name == init->name &&
+              update && update->kind == EXPR_ASSIGN && update->name == init->name &&
+              update->right->kind == EXPR_BINARY && update->right->op == TOK_PLUS &&
+              update->right->left->kind == EXPR_VARIABLE && update->right->left->name == init->name &&
+              update->right->right->kind == EXPR_LITERAL && update->right->right->literal.type == VAL_TROOP &&
+              update->right->right->literal.troop > 0;
+    if (!ok) {
+        error(stmt.line, "A parallel 'deploy' must count up: 'troop i = a; i < b; i = i + step' with a positive step.");
+    }
+    return ok;
+}
+
+// Runs after the loop is resolved, while its outer locals are still in scope.
+// Iterations may run in any order on any thread, so the body may only
+// write its own locals and the reductions recorded here.
+void Resolver::parallelLoop(Stmt& stmt) {
+    ParallelScan scan;
+    scan.loopSlot = stmt.init->slot;
+    scan.slotTypes.assign(maxSlot, VAL_NONE);
+    for (const Local& local : locals) scan.slotTypes[local.slot] = local.type;
+    parallelStatement(*stmt.body, scan);
+
+    for (Reduction& reduction : scan.reductions) {
+        for (const Local& local : locals) {
+            if (local.slot == reduction.slot) reduction.type = local.type;
+        }
+        if (reduction.type == VAL_TROOP_SQUAD || reduction.type == VAL_AMMO_SQUAD) {
+            error(stmt.line, "A squad cannot be a reduction variable of a parallel 'deploy'.");
+        }
+        for (int read : scan.reads) {
+            if (read == reduction.slot) {
+                error(stmt.line, "A reduction variable of a parallel 'deploy' cannot be read in its body.");
+                break;
+            }
+        }
+    }
+
+    // The bound is evaluated once, before any iteration runs
+    ParallelScan bound;
+    bound.loopSlot = scan.loopSlot + 1;
+    size_t callsBefore = parallelCalls.size();
+    parallelExpression(*stmt.expr->right, bound);
+    bool invariant = parallelCalls.size() == callsBefore;
+    parallelCalls.resize(callsBefore);
+    for (int read : bound.reads) {
+        if (read == scan.loopSlot) invariant = false;
+        for (const Reduction& reduction : scan.reductions) {
+            if (read == reduction.slot) invariant = false;
+        }
+    }
+    if (!invariant) {
+        error(stmt.line, "The bound of a parallel 'deploy' cannot call tactics or use variables the loop changes.");
+    }
+    stmt.reductions = scan.reductions;
+}
+
+void Resolver::parallelStatement(const Stmt& stmt, ParallelScan& scan) {
+    switch (stmt.kind) {
+        case STMT_BLOCK:
+            for (const unique_ptr<Stmt>& inner : stmt.statements) parallelStatement(*inner, scan);
+            break;
+
+        case STMT_VAR:
+            if (stmt.expr) parallelExpression(*stmt.expr, scan);
+            if (stmt.slot >= 0 && stmt.slot < (int)scan.slotTypes.size()) scan.slotTypes[stmt.slot] = stmt.varType;
+            break;
+
+        case STMT_BRIEF:
+            if (stmt.expr) parallelExpression(*stmt.expr, scan);
+            break;
+
+        case STMT_IF:
+            parallelExpression(*stmt.expr, scan);
+            parallelStatement(*stmt.body, scan);
+            if (stmt.elseBranch) parallelStatement(*stmt.elseBranch, scan);
+            break;
+
+        case STMT_WHILE:
+        case STMT_FOR:
+            if (stmt.init) parallelStatement(*stmt.init, scan);
+            if (stmt.expr) parallelExpression(*stmt.expr, scan);
+            if (stmt.update) parallelExpression(*stmt.update, scan);
+            scan.loopDepth++;
+            parallelStatement(*stmt.body, scan);
+            scan.loopDepth--;
+            break;
+
+        case STMT_INTEL:
+            error(stmt.line, "'intel' cannot be used inside a parallel 'deploy'.");
+            break;
+
+        case STMT_RETREAT:
+            error(stmt.line, "'retreat' cannot be used inside a parallel 'deploy'.");
+            break;
+
+        case STMT_ABORT:
+            if (scan.loopDepth == 0) error(stmt.line, "'abort' cannot leave a parallel 'deploy'.");
+            break;
+
+        case STMT_EXPR: {
+            const Expr& expr = *stmt.expr;
+            if (expr.kind == EXPR_ASSIGN && !expr.global && expr.slot >= 0 && expr.slot < scan.loopSlot) {
+                reduction(expr, scan);
+            } else {
+                parallelExpression(expr, scan);
+            }
+            break;
+        }
+    }
+}
+
+void Resolver::parallelExpression(const Expr& expr, ParallelScan& scan) {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+        case EXPR_INLINE:
+            break;
+
+        case EXPR_VARIABLE:
+            if (!expr.global && expr.slot < scan.loopSlot) scan.reads.push_back(expr.slot);
+            break;
+
+        case EXPR_ASSIGN:
+            parallelExpression(*expr.right, scan);
+            if (expr.global) {
+                error(expr.line, "Global '" + nameOf(expr.name) + "' cannot be assigned inside a parallel 'deploy'.");
+            } else if (expr.slot == scan.loopSlot) {
+                error(expr.line, "The loop variable '" + nameOf(expr.name) + "' cannot be assigned inside a parallel 'deploy'.");
+            } else if (expr.slot < scan.loopSlot) {
+                error(expr.line, "'" + nameOf(expr.name) + "' is assigned inside a parallel 'deploy' but is not a reduction ('" +
+                                 nameOf(expr.name) + " = " + nameOf(expr.name) + " op ...;' with op one of + * && ||).");
+            }
+            break;
+
+        case EXPR_CALL:
+            for (const unique_ptr<Expr>& arg : expr.args) parallelExpression(*arg, scan);
+            if (expr.function >= 0) parallelCalls.push_back(make_pair(expr.function, expr.line));
+            break;
+
+        case EXPR_SQUAD:
+        case EXPR_BUILTIN:
+            for (const unique_ptr<Expr>& arg : expr.args) parallelExpression(*arg, scan);
+            break;
+
+        case EXPR_INDEX:
+            parallelExpression(*expr.left, scan);
+            parallelExpression(*expr.right, scan);
+            break;
+
+        // Iterations would each write their own copy of a shared squad
+        case EXPR_SET_INDEX:
+            parallelExpression(*expr.left, scan);
+            parallelExpression(*expr.right, scan);
+            if (expr.global || expr.slot < scan.loopSlot) {
+                error(expr.line, "Squad '" + nameOf(expr.name) + "' is declared outside a parallel 'deploy' and cannot be changed inside it.");
+            }
+            break;
+
+        case EXPR_UNARY:
+            parallelExpression(*expr.left, scan);
+            break;
+
+        case EXPR_BINARY:
+            parallelExpression(*expr.left, scan);
+            parallelExpression(*expr.right, scan);
+            break;
+    }
+}
+
+// 'x = x op e;' or 'x = e op x;' as a statement, where e does not read x.
+// The first form may chain, 'x = x op a op b;', since the parser nests
+// that as '(x op a) op b'.
+void Resolver::reduction(const Expr& assign, ParallelScan& scan) {
+    const Expr& value = *assign.right;
+    bool reducible = value.kind == EXPR_BINARY &&
+                     (value.op == TOK_PLUS || value.op == TOK_MULTIPLY || value.op == TOK_AND || value.op == TOK_OR);
+    const Expr* innermost = &value;
+    while (reducible && innermost->left->kind == EXPR_BINARY && innermost->left->op == value.op) {
+        innermost = innermost->left.get();
+    }
+    const Expr* accumulator = reducible ? innermost->left.get() : nullptr;
+    bool first = reducible && accumulator->kind == EXPR_VARIABLE && !accumulator->global && accumulator->slot == assign.slot;
+    bool second = reducible && !first && value.right->kind == EXPR_VARIABLE && !value.right->global &&
+                  value.right->slot == assign.slot;
+    if (!first && !second) {
+        parallelExpression(assign, scan);   // Reports the assignment
+        return;
+    }
+    // An operand of another type converts back on every step, which makes
+    // 'x = x + 0.5' on a troop truncate per iteration: no longer associative,
+    // so the chunks could not be combined into the sequential loop's result
+    ValueType type = scan.slotTypes[assign.slot];
+    vector<const Expr*> operands;
+    if (first) {
+        for (const Expr* link = &value; link != accumulator; link = link->left.get()) operands.push_back(link->right.get());
+    } else {
+        operands.push_back(value.left.get());
+    }
+    for (const Expr* operand : operands) {
+        parallelExpression(*operand, scan);
+        ValueType operandType = staticType(*operand, scan);
+        if (operandType == type || type == VAL_TROOP_SQUAD || type == VAL_AMMO_SQUAD) continue;   // Squads: parallelLoop
+        if (operandType == VAL_NONE) {
+            error(assign.line, "The type of what reduction '" + nameOf(assign.name) + "' combines is only known at run time; "
+                               "assign it to a " + valueTypeName(type) + " variable first.");
+        } else {
+            error(assign.line, "Reduction '" + nameOf(assign.name) + "' has type " + valueTypeName(type) +
+                               " but combines a value of type " + valueTypeName(operandType) +
+                               "; both must have the same type.");
+        }
+    }
+
+    Reduction found = { assign.slot, VAL_NONE, value.op, first };
+    for (const Reduction& reduction : scan.reductions) {
+        if (reduction.slot != assign.slot) continue;
+        if (reduction.op != found.op || reduction.accumulatorFirst != found.accumulatorFirst) {
+            error(assign.line, "'" + nameOf(assign.name) + "' must be reduced the same way throughout a parallel 'deploy'.");
+        }
+        return;
+    }
+    scan.reductions.push_back(found);
+}
+
+// The type an expression in a parallel loop body always has, or VAL_NONE
+// when only running it can tell (a tactic's result)
+ValueType Resolver::staticType(const Expr& expr, const ParallelScan& scan) const {
+    switch (expr.kind) {
+        case EXPR_LITERAL:
+            return expr.literal.type;
+
+        case EXPR_VARIABLE:
+            if (expr.global) return expr.slot >= 0 && expr.slot < (int)globalTypes.size() ? globalTypes[expr.slot] : VAL_NONE;
+            return expr.slot >= 0 && expr.slot < (int)scan.slotTypes.size() ? scan.slotTypes[expr.slot] : VAL_NONE;
+
+        case EXPR_UNARY: {
+            if (expr.op == TOK_NOT) return VAL_STATUS;
+            ValueType operand = staticType(*expr.left, scan);
+            return operand == VAL_TROOP || operand == VAL_AMMO || operand == VAL_TROOP_SQUAD || operand == VAL_AMMO_SQUAD
+                       ? operand : VAL_NONE;
+        }
+
+        case EXPR_BINARY: {
+            if (expr.op == TOK_AND || expr.op == TOK_OR) return VAL_STATUS;
+            ValueType a = staticType(*expr.left, scan);
+            ValueType b = staticType(*expr.right, scan);
+            bool comparison = expr.op == TOK_EQUAL || expr.op == TOK_NOT_EQUAL || expr.op == TOK_LESS ||
+                              expr.op == TOK_LESS_EQUAL || expr.op == TOK_GREATER || expr.op == TOK_GREATER_EQUAL;
+            if (a == VAL_NONE || b == VAL_NONE) return VAL_NONE;
+            if (expr.op == TOK_PLUS && (a == VAL_CODENAME || b == VAL_CODENAME)) return VAL_CODENAME;
+            bool squad = a == VAL_TROOP_SQUAD || a == VAL_AMMO_SQUAD || b == VAL_TROOP_SQUAD || b == VAL_AMMO_SQUAD;
+            bool ammo = a == VAL_AMMO || a == VAL_AMMO_SQUAD || b == VAL_AMMO || b == VAL_AMMO_SQUAD;
+            if (squad) return comparison || !ammo ? VAL_TROOP_SQUAD : VAL_AMMO_SQUAD;
+            if (comparison) return VAL_STATUS;
+            if (a == VAL_TROOP && b == VAL_TROOP) return VAL_TROOP;
+            return (a == VAL_TROOP || a == VAL_AMMO) && (b == VAL_TROOP || b == VAL_AMMO) ? VAL_AMMO : VAL_NONE;
+        }
+
+        case EXPR_SQUAD: {
+            ValueType type = VAL_TROOP_SQUAD;
+            for (const unique_ptr<Expr>& element : expr.args) {
+                ValueType elementType = staticType(*element, scan);
+                if (elementType == VAL_AMMO) type = VAL_AMMO_SQUAD;
+                else if (elementType != VAL_TROOP) return VAL_NONE;
+            }
+            return type;
+        }
+
+        case EXPR_INDEX: {
+            ValueType squad = staticType(*expr.left, scan);
+            return squad == VAL_TROOP_SQUAD ? VAL_TROOP : squad == VAL_AMMO_SQUAD ? VAL_AMMO : VAL_NONE;
+        }
+
+        case EXPR_BUILTIN: {
+            if (expr.function == BUILTIN_SIZE) return VAL_TROOP;
+            if (expr.function == BUILTIN_RANGE) return VAL_TROOP_SQUAD;
+            if (expr.args.empty()) return VAL_NONE;
+            ValueType argument = staticType(*expr.args.back(), scan);
+            if (expr.function == BUILTIN_FILL) {
+                return argument == VAL_TROOP ? VAL_TROOP_SQUAD : argument == VAL_AMMO ? VAL_AMMO_SQUAD : VAL_NONE;
+            }
+            return argument == VAL_TROOP_SQUAD ? VAL_TROOP : argument == VAL_AMMO_SQUAD ? VAL_AMMO : VAL_NONE;
+        }
+
+        default:   // Calls, and assignments nested in the operand
+            return VAL_NONE;
+    }
+}
+
+bool Resolver::checkParallelCalls() {
+    bool ok = true;
+    // A nested parallel loop's calls are also seen by the loops around it
+    sort(parallelCalls.begin(), parallelCalls.end());
+    parallelCalls.erase(unique(parallelCalls.begin(), parallelCalls.end()), parallelCalls.end());
+    for (const pair<int, int>& call : parallelCalls) {
+        // Depth-first over everything the called tactic can reach
+        vector<bool> seen(program.functions.size(), false);
+        vector<int> pending(1, call.first);
+        int effectLine = 0;
+        while (!pending.empty() && effectLine == 0) {
+            int index = pending.back();
+            pending.pop_back();
+            if (seen[index]) continue;
+            seen[index] = true;
+            effectLine = effects[index].line;
+            pending.insert(pending.end(), effects[index].callees.begin(), effects[index].callees.end());
+        }
+        if (effectLine != 0) {
+            error(call.second, "Tactic '" + nameOf(program.functions[call.first].name) +
+                               "' cannot be called from a parallel 'deploy': it assigns a global or reads 'intel' (line " +
+                               to_string(effectLine) + ").");
+            ok = false;
+        }
+    }
+    parallelCalls.clear();
+    return ok;
+}
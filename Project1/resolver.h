@@ -0,0 +1,106 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <iostream>
+#include <unordered_map>
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. RESOLVER CLASS DECLARATION
+// =============================================================================
+
+// Semantic pass run after parsing. It binds every name in the AST to a
+// storage location so the interpreter never looks names up at runtime:
+//   - variables get a frame slot (locals, params) or a global index
+//   - calls get the index of the called tactic, with an arity check
+//   - 'retreat f(...)' is marked as a tail call
+//   - each tactic gets the frame size it needs
+//   - 'deploy parallel' loops are checked to be free of cross-iteration
+//     dependencies other than reductions, which are recorded on the loop
+// Tactics whose bodies have not been parsed yet are skipped by resolve().
+// Errors are written to 'errors' in the parser's "[Line N] Error: ..." format.
+class Resolver {
+private:
+    struct Local {
+        Symbol name;
+        int slot;
+        ValueType type;
+        int depth;
+    };
+
+    Program& program;
+    ostream& errors;
+    unordered_map<Symbol, int> functionIndex;
+    unordered_map<Symbol, int> globalIndex;
+    vector<ValueType> globalTypes;
+
+    vector<Local> locals;
+    int scopeDepth = 0;
+    int nextSlot = 0;
+    int maxSlot = 0;
+    int loopDepth = 0;
+    bool inFunction = false;
+    bool hadError = false;
+    vector<int> calls;   // Tactics called by the code resolved last
+
+    // What a tactic's own body does that a parallel loop cannot allow
+    struct Effects {
+        int line = 0;              // First global assignment or 'intel', or 0
+        vector<int> callees;
+    };
+    vector<Effects> effects;       // Per tactic, filled in as bodies resolve
+    int currentFunction = -1;
+    vector<pair<int, int>> parallelCalls;   // (tactic, line) called in parallel loop bodies
+
+    // State of the scan over one parallel loop body
+    struct ParallelScan {
+        int loopSlot;              // Slots below this are outer locals
+        int loopDepth = 0;         // Loops nested inside the body
+        vector<Reduction> reductions;
+        vector<int> reads;         // Outer locals read by the body
+        vector<ValueType> slotTypes;   // Declared type of each local slot, as of the code scanned so far
+    };
+
+    void error(int line, const string& message);
+
+    void beginScope();
+    void endScope();
+    int declareLocal(Symbol name, ValueType type, int line);
+    bool lookup(Symbol name, int& slot, bool& global, ValueType& type);
+
+    void function(Function& function);
+    void statement(Stmt& stmt);
+    void expression(Expr& expr);
+    void builtin(Expr& call);
+
+    bool countingLoop(const Stmt& stmt);
+    void parallelLoop(Stmt& stmt);
+    void parallelStatement(const Stmt& stmt, ParallelScan& scan);
+    void parallelExpression(const Expr& expr, ParallelScan& scan);
+    void reduction(const Expr& assign, ParallelScan& scan);
+    ValueType staticType(const Expr& expr, const ParallelScan& scan) const;
+    void noteEffect(int line);
+
+public:
+    // --- Public Interface ---
+    Resolver(Program& program, ostream& errors) : program(program), errors(errors) {}
+
+    // Resolves the whole program. Returns true when every name resolved.
+    bool resolve();
+
+    // For deferred bodies: declare() binds tactics, globals and global
+    // initializers; resolveFunction() then handles one parsed body at a time.
+    // After either call, getCalls() lists the tactics that code calls.
+    bool declare();
+    bool resolveFunction(Function& function);
+    const vector<int>& getCalls() const { return calls; }
+
+    // Once every reachable body is resolved: rejects calls from parallel
+    // loops to tactics that, directly or not, assign globals or read 'intel'.
+    // resolve() runs this itself.
+    bool checkParallelCalls();
+};
+
+#endif // RESOLVER_H
@@ -1,4 +1,5 @@
 #include "scanner.h"  // <-- 1. THE MOST IMPORTANT FIX: Include the header.
+#include "lexgen.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -11,44 +12,70 @@
 //    to show they "implement" the class from the header.
 
 // --- Constructor Implementation ---
-Scanner::Scanner(const string& src) : source(src), start(0), current(0), line(1), column(0) {
-    initKeywords();
-}
-
-// --- Keyword Map Implementation ---
-void Scanner::initKeywords() {
-    keywords["campaign"] = TOK_CAMPAIGN;
-    keywords["tactic"] = TOK_TACTIC;
-    keywords["troop"] = TOK_TROOP;
-    keywords["ammo"] = TOK_AMMO;
-    keywords["codename"] = TOK_CODENAME;
-    keywords["status"] = TOK_STATUS;
-    keywords["brief"] = TOK_BRIEF;
-    keywords["intel"] = TOK_INTEL;
-    keywords["evaluate"] = TOK_EVALUATE;
-    keywords["adjust"] = TOK_ADJUST;
-    keywords["maintain"] = TOK_MAINTAIN;
-    keywords["deploy"] = TOK_DEPLOY;
-    keywords["retreat"] = TOK_RETREAT;
-    keywords["abort"] = TOK_ABORT;
-    keywords["true"] = TOK_TRUE;
-    keywords["false"] = TOK_FALSE;
-    keywords["#supply"] = TOK_SUPPLY; // Handle #supply
+Scanner::Scanner(const string& src) : source(src), start(0), current(0), line(1), column(0) {}
+
+// --- Token Specification ---
+// Every token the language knows, as patterns for the DFA generator in
+// lexgen.cpp. Order matters only for ties: the first rule listed wins.
+
+// Actions that do not produce a plain token of their own
+enum ScanAction {
+    ACT_SKIP = TOK_ERROR + 1,  // Whitespace
+    ACT_COMMENT,               // '#' not followed by a letter, to end of line
+    ACT_DIRECTIVE,             // '#' followed by letters other than #supply
+    ACT_UNTERMINATED_STRING    // '"' running into end of file
+};
+
+const vector<LexRule>& Scanner::tokenSpec() {
+    static const vector<LexRule> spec = {
+        // Keywords come before IDENTIFIER so they win ties of equal length
+        { "campaign", TOK_CAMPAIGN }, { "tactic",   TOK_TACTIC },
+        { "troop",    TOK_TROOP },    { "ammo",     TOK_AMMO },
+        { "codename", TOK_CODENAME }, { "status",   TOK_STATUS },
+        { "brief",    TOK_BRIEF },    { "intel",    TOK_INTEL },
+        { "evaluate", TOK_EVALUATE }, { "adjust",   TOK_ADJUST },
+        { "maintain", TOK_MAINTAIN }, { "deploy",   TOK_DEPLOY },
+        { "retreat",  TOK_RETREAT },  { "abort",    TOK_ABORT },
+        { "parallel", TOK_PARALLEL }, { "squad",    TOK_SQUAD },
+        { "true",     TOK_TRUE },     { "false",    TOK_FALSE },
+        { "#supply",  TOK_SUPPLY },
+
+        { "[ \t\r\n]+",                ACT_SKIP },
+        { "#|#[^A-Za-z\n][^\n]*",      ACT_COMMENT },
+        { "#[A-Za-z]+",                ACT_DIRECTIVE },
+        { "\"[^\"]*\"",                TOK_STRING },
+        { "\"[^\"]*",                  ACT_UNTERMINATED_STRING },
+        { "[0-9]+",                    TOK_INTEGER },
+        { "[0-9]+\\.[0-9]+",           TOK_DOUBLE },
+        { "[A-Za-z_][A-Za-z0-9_]*",    TOK_IDENTIFIER },
+
+        { "\\(", TOK_LPAREN },   { "\\)", TOK_RPAREN },
+        { "{",   TOK_LBRACE },   { "}",   TOK_RBRACE },
+        { "\\[", TOK_LBRACKET }, { "\\]", TOK_RBRACKET },
+        { ";",   TOK_SEMICOLON },{ ",",   TOK_COMMA },
+        { "\\+", TOK_PLUS },     { "-",   TOK_MINUS },
+        { "\\*", TOK_MULTIPLY }, { "/",   TOK_DIVIDE },
+        { "%",   TOK_MODULO },
+
+        { "==", TOK_EQUAL },         { "=",  TOK_ASSIGN },
+        { "!=", TOK_NOT_EQUAL },     { "!",  TOK_NOT },
+        { "<=", TOK_LESS_EQUAL },    { "<",  TOK_LESS },
+        { ">=", TOK_GREATER_EQUAL }, { ">",  TOK_GREATER },
+        { "&&", TOK_AND },           { "\\|\\|", TOK_OR },
+    };
+    return spec;
 }
 
 // --- Main Scan Function Implementation ---
 vector<Token> Scanner::scanTokens() {
+    tokens.reserve(source.length() / 4);
     while (!isAtEnd()) {
         start = current;
-        skipWhitespace();
-        if (!isAtEnd()) {
-            start = current;
-            scanToken();
-        }
+        scanToken();
     }
 
-    tokens.push_back(Token(TOK_EOF, "", line, column));
-    return tokens;
+    tokens.push_back(Token(TOK_EOF, NO_SYMBOL, line, column));
+    return move(tokens); // One-shot: hand the list over instead of copying it
 }
 
 // --- ALL OTHER SCANNER HELPER FUNCTIONS ---
@@ -57,190 +84,102 @@ bool Scanner::isAtEnd() {
     return current >= source.length();
 }
 
-char Scanner::advance() {
-    column++;
-    return source[current++];
-}
-
-char Scanner::peek() {
-    if (isAtEnd()) return '\0';
-    return source[current];
-}
-
-char Scanner::peekNext() {
-    if (current + 1 >= source.length()) return '\0';
-    return source[current + 1];
-}
-
-bool Scanner::match(char expected) {
-    if (isAtEnd()) return false;
-    if (source[current] != expected) return false;
-    current++;
-    column++;
-    return true;
-}
-
-void Scanner::addToken(TokenType type) {
-    string text = source.substr(start, current - start);
-    tokens.push_back(Token(type, text, line, column - text.length()));
-}
-
-void Scanner::skipWhitespace() {
-    while (!isAtEnd()) {
-        char c = peek();
-        switch (c) {
-            case ' ':
-            case '\r':
-            case '\t':
-                advance();
-                break;
-            case '\n':
+// Move 'current' to 'end', keeping line and column up to date.
+// Only whitespace and strings can span lines, so other lexemes skip the scan.
+void Scanner::consume(size_t end, bool multiline) {
+    if (multiline) {
+        for (; current < end; current++) {
+            if (source[current] == '\n') {
                 line++;
                 column = 0;
-                advance();
-                break;
-            default:
-                return;
+            }
+            column++;
         }
+    } else {
+        column += (int)(end - current);
+        current = end;
     }
 }
 
-void Scanner::scanComment() {
-    // Skip until end of line
-    while (peek() != '\n' && !isAtEnd()) {
-        advance();
-    }
+// Keywords, operators and delimiters are spelled by their type; numbers
+// are interned like identifiers
+void Scanner::addToken(TokenType type) {
+    int length = (int)(current - start);
+    Symbol symbol = spelling(type) ? NO_SYMBOL : Interner::current().intern(source.data() + start, current - start);
+    tokens.push_back(Token(type, symbol, line, column - length));
 }
 
-void Scanner::scanString() {
-    while (peek() != '"' && !isAtEnd()) {
-        if (peek() == '\n') {
-            line++;
-            column = 0;
-        }
-        advance();
-    }
-
-    if (isAtEnd()) {
-        tokens.push_back(Token(TOK_ERROR, "Unterminated string", line, column));
-        return;
-    }
-
-    advance(); // Closing "
-    addToken(TOK_STRING);
+void Scanner::addError(const string& message) {
+    tokens.push_back(Token(TOK_ERROR, Interner::current().intern(message), line, column));
 }
 
-void Scanner::scanNumber() {
-    while (isdigit(peek())) {
-        advance();
-    }
-
-    // Check for decimal point
-    if (peek() == '.' && isdigit(peekNext())) {
-        advance(); // Consume '.'
-        while (isdigit(peek())) {
-            advance();
+// Runs the DFA from 'start' and keeps the longest accepted lexeme
+void Scanner::scanToken() {
+    const StaticLexTables& tables = scannerTables;
+    const unsigned char* text = (const unsigned char*)source.data();
+    const size_t length = source.length();
+    const unsigned short* next = tables.next;
+    const int* accept = tables.accept;
+    const int numClasses = tables.numClasses;
+
+    int state = tables.startState;
+    int action = -1;
+    size_t end = start;
+    for (size_t pos = start; pos < length; ) {
+        state = next[state * numClasses + tables.byteClass[text[pos++]]];
+        if (state == LexTables::DEAD) break;
+        if (accept[state] >= 0) {
+            action = accept[state];
+            end = pos;
         }
-        addToken(TOK_DOUBLE);
     }
-    else {
-        addToken(TOK_INTEGER);
-    }
-}
 
-void Scanner::scanIdentifier() {
-    while (isalnum(peek()) || peek() == '_') {
-        advance();
-    }
-
-    string text = source.substr(start, current - start);
-    TokenType type = TOK_IDENTIFIER;
-
-    if (keywords.find(text) != keywords.end()) {
-        type = keywords[text];
-    }
-
-    addToken(type);
-}
-
-void Scanner::scanSupply() {
-    // #supply directive
-    while (isalpha(peek())) {
-        advance();
-    }
-
-    string text = source.substr(start, current - start);
-    if (text == "#supply") {
-        addToken(TOK_SUPPLY);
-    }
-    else {
-        tokens.push_back(Token(TOK_ERROR, "Unknown directive: " + text, line, column));
+    if (action < 0) {
+        // No rule matches: report the single offending character
+        char c = source[start];
+        consume(start + 1, c == '\n');
+        addError(string("Unexpected character: ") + c);
+        return;
     }
-}
 
-void Scanner::scanToken() {
-    char c = advance();
-
-    switch (c) {
-        case '(': addToken(TOK_LPAREN); break;
-        case ')': addToken(TOK_RPAREN); break;
-        case '{': addToken(TOK_LBRACE); break;
-        case '}': addToken(TOK_RBRACE); break;
-        case ';': addToken(TOK_SEMICOLON); break;
-        case ',': addToken(TOK_COMMA); break;
-        case '+': addToken(TOK_PLUS); break;
-        case '-': addToken(TOK_MINUS); break;
-        case '*': addToken(TOK_MULTIPLY); break;
-        case '/': addToken(TOK_DIVIDE); break;
-        case '%': addToken(TOK_MODULO); break;
-
-        case '=':
-            addToken(match('=') ? TOK_EQUAL : TOK_ASSIGN);
-            break;
-        case '!':
-            addToken(match('=') ? TOK_NOT_EQUAL : TOK_NOT);
+    switch (action) {
+        case ACT_SKIP:
+            consume(end, true);
             break;
-        case '<':
-            addToken(match('=') ? TOK_LESS_EQUAL : TOK_LESS);
-            break;
-        case '>':
-            addToken(match('=') ? TOK_GREATER_EQUAL : TOK_GREATER);
+
+        case ACT_COMMENT:
+            consume(end, false);
             break;
-        case '&':
-            if (match('&')) {
-                addToken(TOK_AND);
-            } else {
-                tokens.push_back(Token(TOK_ERROR, "Unexpected character: &", line, column));
-            }
+
+        case ACT_DIRECTIVE:
+            consume(end, false);
+            addError("Unknown directive: " + source.substr(start, current - start));
             break;
-        case '|':
-            if (match('|')) {
-                addToken(TOK_OR);
-            } else {
-                tokens.push_back(Token(TOK_ERROR, "Unexpected character: |", line, column));
-            }
+
+        case TOK_STRING: {
+            consume(end, true);
+            int length = (int)(current - start);
+            Symbol symbol = Interner::current().intern(source.data() + start + 1, current - start - 2);
+            tokens.push_back(Token(TOK_STRING, symbol, line, column - length));
             break;
+        }
 
-        case '#':
-            if (isalpha(peek())) {
-                scanSupply();
-            } else {
-                scanComment();
-            }
+        case TOK_IDENTIFIER: {
+            consume(end, false);
+            int length = (int)(current - start);
+            Symbol symbol = Interner::current().intern(source.data() + start, current - start);
+            tokens.push_back(Token(TOK_IDENTIFIER, symbol, line, column - length));
             break;
+        }
 
-        case '"':
-            scanString();
+        case ACT_UNTERMINATED_STRING:
+            consume(end, true);
+            addError("Unterminated string");
             break;
 
         default:
-            if (isdigit(c)) {
-                scanNumber();
-            } else if (isalpha(c) || c == '_') {
-                scanIdentifier();
-            } else {
-                tokens.push_back(Token(TOK_ERROR, string("Unexpected character: ") + c, line, column));
-            }
+            consume(end, false);
+            addToken((TokenType)action);
             break;
     }
 }
@@ -251,18 +190,42 @@ string Scanner::tokenTypeToString(TokenType type) {
     static const char* names[] = {
         "CAMPAIGN", "TACTIC", "TROOP", "AMMO", "CODENAME", "STATUS",
         "BRIEF", "INTEL", "EVALUATE", "ADJUST", "MAINTAIN", "DEPLOY",
-        "RETREAT", "ABORT", "SUPPLY",
+        "RETREAT", "ABORT", "SUPPLY", "PARALLEL", "SQUAD",
         "INTEGER", "DOUBLE", "STRING", "TRUE", "FALSE",
         "IDENTIFIER",
         "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "MODULO",
         "EQUAL", "NOT_EQUAL", "LESS", "GREATER", "LESS_EQUAL", "GREATER_EQUAL",
         "AND", "OR", "NOT", "ASSIGN",
-        "LPAREN", "RPAREN", "LBRACE", "RBRACE", "SEMICOLON", "COMMA",
+        "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACKET", "RBRACKET", "SEMICOLON", "COMMA",
         "EOF", "ERROR"
         // Note: TOK_COMMENT is removed as we don't store it
     };
     return names[type];
 }
 
+// --- Token Spelling ---
+// The fixed text of a token type, or null if it varies (interned instead)
+const char* Scanner::spelling(TokenType type) {
+    static const char* spellings[] = {
+        "campaign", "tactic", "troop", "ammo", "codename", "status",
+        "brief", "intel", "evaluate", "adjust", "maintain", "deploy",
+        "retreat", "abort", "#supply", "parallel", "squad",
+        nullptr, nullptr, nullptr, "true", "false",
+        nullptr,
+        "+", "-", "*", "/", "%",
+        "==", "!=", "<", ">", "<=", ">=",
+        "&&", "||", "!", "=",
+        "(", ")", "{", "}", "[", "]", ";", ",",
+        "", nullptr
+    };
+    return spellings[type];
+}
+
+string Token::text() const {
+    if (symbol == NO_SYMBOL) return Scanner::spelling(type);
+    const string& name = Interner::current().name(symbol);
+    return type == TOK_STRING ? "\"" + name + "\"" : name;
+}
+
 // 4. ALL OTHER FUNCTIONS like readFile, writeTokensToFile, and main
 //    are REMOVED from this file. They are in parser.cpp.
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <utility>
+#include "interner.h"
+#include "lexgen.h"
 
 using namespace std;
 
@@ -16,7 +18,7 @@ enum TokenType {
     // Keywords
     TOK_CAMPAIGN, TOK_TACTIC, TOK_TROOP, TOK_AMMO, TOK_CODENAME, TOK_STATUS,
     TOK_BRIEF, TOK_INTEL, TOK_EVALUATE, TOK_ADJUST, TOK_MAINTAIN, TOK_DEPLOY,
-    TOK_RETREAT, TOK_ABORT, TOK_SUPPLY,
+    TOK_RETREAT, TOK_ABORT, TOK_SUPPLY, TOK_PARALLEL, TOK_SQUAD,
 
     // Literals
     TOK_INTEGER, TOK_DOUBLE, TOK_STRING, TOK_TRUE, TOK_FALSE,
@@ -30,21 +32,30 @@ enum TokenType {
     TOK_AND, TOK_OR, TOK_NOT, TOK_ASSIGN,
 
     // Delimiters
-    TOK_LPAREN, TOK_RPAREN, TOK_LBRACE, TOK_RBRACE, TOK_SEMICOLON, TOK_COMMA,
+    TOK_LPAREN, TOK_RPAREN, TOK_LBRACE, TOK_RBRACE, TOK_LBRACKET, TOK_RBRACKET,
+    TOK_SEMICOLON, TOK_COMMA,
 
     // Special
     TOK_EOF, TOK_ERROR
 };
 
 // Token structure
+//
+// A token is 16 bytes and owns no memory. Text that varies from token to
+// token (identifiers, string literals without their quotes, numbers and
+// error messages) is interned in Interner::current() and the token carries
+// its 4-byte symbol; keywords, operators and delimiters have NO_SYMBOL and
+// are spelled by their type. Use text() when the spelling is needed.
 struct Token {
     TokenType type;
-    string lexeme;
     int line;
     int column;
+    Symbol symbol;
 
-    Token(TokenType t, string lex, int ln, int col)
-        : type(t), lexeme(lex), line(ln), column(col) {}
+    Token(TokenType t, Symbol sym, int ln, int col)
+        : type(t), line(ln), column(col), symbol(sym) {}
+
+    string text() const;
 };
 
 // =============================================================================
@@ -60,23 +71,11 @@ private:
     int column;
     vector<Token> tokens;
 
-    // Keyword map
-    map<string, TokenType> keywords;
-
     // --- Private Helper Functions ---
-    void initKeywords();
     bool isAtEnd();
-    char advance();
-    char peek();
-    char peekNext();
-    bool match(char expected);
+    void consume(size_t end, bool multiline);
     void addToken(TokenType type);
-    void skipWhitespace();
-    void scanComment();
-    void scanString();
-    void scanNumber();
-    void scanIdentifier();
-    void scanSupply();
+    void addError(const string& message);
     void scanToken();
 
 public:
@@ -84,6 +83,16 @@ public:
     Scanner(const string& src);
     vector<Token> scanTokens();
     static string tokenTypeToString(TokenType type);
+    static const char* spelling(TokenType type);
+
+    // The patterns every token is scanned by, in priority order
+    static const vector<LexRule>& tokenSpec();
 };
 
+// The DFA for tokenSpec(), generated by lexgen into scantables.cpp. After
+// changing the specification, regenerate it with
+//   TacticLang --emit-lexer Project1/scantables.cpp
+// scannertest fails until the two agree again.
+extern const StaticLexTables scannerTables;
+
 #endif // SCANNER_H
\ No newline at end of file
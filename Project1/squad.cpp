@@ -0,0 +1,582 @@
+#include "squad.h"
+#include "interpreter.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+// SSE2 is part of every x86-64 target; 32-bit builds opt in with /arch:SSE2
+// or -msse2. Anything else uses the scalar loops, which give bit-identical
+// results: the floating-point reductions keep the same two-lane order.
+// Every kernel takes 'packed' and runs the scalar loops alone when it is
+// false, so an SSE2 build can check itself against them.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SQUAD_SSE2 1
+#include <emmintrin.h>
+#else
+#define SQUAD_SSE2 0
+#endif
+
+static atomic<bool> packedKernels(SQUAD_SSE2 != 0);
+
+// =============================================================================
+// 1. KERNELS
+// =============================================================================
+
+// One side of an elementwise kernel: packed elements, or a single number
+// broadcast to every lane
+template <class T>
+struct Operand {
+    const T* data;
+    bool broadcast;
+
+    T operator[](size_t i) const { return broadcast ? data[0] : data[i]; }
+};
+
+#if SQUAD_SSE2
+static inline __m128i load(const Operand<int>& x, size_t i) {
+    return x.broadcast ? _mm_set1_epi32(x.data[0]) : _mm_loadu_si128((const __m128i*)(x.data + i));
+}
+
+static inline __m128d load(const Operand<double>& x, size_t i) {
+    return x.broadcast ? _mm_set1_pd(x.data[0]) : _mm_loadu_pd(x.data + i);
+}
+
+static inline void store(int* out, __m128i value) { _mm_storeu_si128((__m128i*)out, value); }
+static inline void store(double* out, __m128d value) { _mm_storeu_pd(out, value); }
+
+// Lanes of all ones become 1, the rest 0
+static inline void storeMask(int* out, __m128i mask) {
+    _mm_storeu_si128((__m128i*)out, _mm_and_si128(mask, _mm_set1_epi32(1)));
+}
+
+static inline void storeMask(int* out, __m128d mask) {
+    int bits = _mm_movemask_pd(mask);
+    out[0] = bits & 1;
+    out[1] = (bits >> 1) & 1;
+}
+
+static inline __m128i notBits(__m128i x) { return _mm_xor_si128(x, _mm_set1_epi32(-1)); }
+
+// SSE2 has no 32-bit low multiply; build it from the two 64-bit products
+static inline __m128i multiplyLow(__m128i x, __m128i y) {
+    __m128i even = _mm_mul_epu32(x, y);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(x, 4), _mm_srli_si128(y, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+// --- Elementwise Operators ---
+// Troop arithmetic wraps, as it does for scalars
+struct AddOp {
+    static int apply(int x, int y) { return (int)((unsigned)x + (unsigned)y); }
+    static double apply(double x, double y) { return x + y; }
+#if SQUAD_SSE2
+    static __m128i apply(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+    static __m128d apply(__m128d x, __m128d y) { return _mm_add_pd(x, y); }
+#endif
+};
+
+struct SubtractOp {
+    static int apply(int x, int y) { return (int)((unsigned)x - (unsigned)y); }
+    static double apply(double x, double y) { return x - y; }
+#if SQUAD_SSE2
+    static __m128i apply(__m128i x, __m128i y) { return _mm_sub_epi32(x, y); }
+    static __m128d apply(__m128d x, __m128d y) { return _mm_sub_pd(x, y); }
+#endif
+};
+
+struct MultiplyOp {
+    static int apply(int x, int y) { return (int)((unsigned)x * (unsigned)y); }
+    static double apply(double x, double y) { return x * y; }
+#if SQUAD_SSE2
+    static __m128i apply(__m128i x, __m128i y) { return multiplyLow(x, y); }
+    static __m128d apply(__m128d x, __m128d y) { return _mm_mul_pd(x, y); }
+#endif
+};
+
+struct DivideOp {   // Ammo only; troop division checks every divisor
+    static double apply(double x, double y) { return x / y; }
+#if SQUAD_SSE2
+    static __m128d apply(__m128d x, __m128d y) { return _mm_div_pd(x, y); }
+#endif
+};
+
+// --- Comparison Operators ---
+struct LessOp {
+    template <class T> static bool test(T x, T y) { return x < y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return _mm_cmplt_epi32(x, y); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmplt_pd(x, y); }
+#endif
+};
+
+struct GreaterOp {
+    template <class T> static bool test(T x, T y) { return x > y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return _mm_cmpgt_epi32(x, y); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmpgt_pd(x, y); }
+#endif
+};
+
+struct LessEqualOp {
+    template <class T> static bool test(T x, T y) { return x <= y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return notBits(_mm_cmpgt_epi32(x, y)); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmple_pd(x, y); }
+#endif
+};
+
+struct GreaterEqualOp {
+    template <class T> static bool test(T x, T y) { return x >= y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return notBits(_mm_cmplt_epi32(x, y)); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmpge_pd(x, y); }
+#endif
+};
+
+struct EqualOp {
+    template <class T> static bool test(T x, T y) { return x == y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return _mm_cmpeq_epi32(x, y); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmpeq_pd(x, y); }
+#endif
+};
+
+struct NotEqualOp {
+    template <class T> static bool test(T x, T y) { return x != y; }
+#if SQUAD_SSE2
+    static __m128i test(__m128i x, __m128i y) { return notBits(_mm_cmpeq_epi32(x, y)); }
+    static __m128d test(__m128d x, __m128d y) { return _mm_cmpneq_pd(x, y); }
+#endif
+};
+
+// --- Kernel Loops ---
+// A 16-byte vector at a time, then the remainder one element at a time
+template <class Op, class T>
+static void elementwise(Operand<T> a, Operand<T> b, T* out, size_t n, bool packed) {
+    size_t i = 0;
+#if SQUAD_SSE2
+    const size_t lanes = 16 / sizeof(T);
+    if (packed) {
+        for (; i + lanes <= n; i += lanes) store(out + i, Op::apply(load(a, i), load(b, i)));
+    }
+#endif
+    for (; i < n; i++) out[i] = Op::apply(a[i], b[i]);
+}
+
+template <class Op, class T>
+static void compare(Operand<T> a, Operand<T> b, int* mask, size_t n, bool packed) {
+    size_t i = 0;
+#if SQUAD_SSE2
+    const size_t lanes = 16 / sizeof(T);
+    if (packed) {
+        for (; i + lanes <= n; i += lanes) storeMask(mask + i, Op::test(load(a, i), load(b, i)));
+    }
+#endif
+    for (; i < n; i++) mask[i] = Op::test(a[i], b[i]) ? 1 : 0;
+}
+
+// Wrapping sum, so the order of the additions does not matter
+static int sumTroops(const int* data, size_t n, bool packed) {
+    size_t i = 0;
+    unsigned total = 0;
+#if SQUAD_SSE2
+    if (packed) {
+        __m128i lanes = _mm_setzero_si128();
+        for (; i + 4 <= n; i += 4) lanes = _mm_add_epi32(lanes, _mm_loadu_si128((const __m128i*)(data + i)));
+        int partial[4];
+        _mm_storeu_si128((__m128i*)partial, lanes);
+        for (int lane = 0; lane < 4; lane++) total += (unsigned)partial[lane];
+    }
+#endif
+    for (; i < n; i++) total += (unsigned)data[i];
+    return (int)total;
+}
+
+// Even and odd elements are summed separately and then added, on every target
+static double sumAmmo(const double* data, size_t n, bool packed) {
+    size_t i = 0;
+    double even = 0.0, odd = 0.0;
+#if SQUAD_SSE2
+    if (packed) {
+        __m128d lanes = _mm_setzero_pd();
+        for (; i + 2 <= n; i += 2) lanes = _mm_add_pd(lanes, _mm_loadu_pd(data + i));
+        double partial[2];
+        _mm_storeu_pd(partial, lanes);
+        even = partial[0];
+        odd = partial[1];
+    }
+#endif
+    for (; i + 2 <= n; i += 2) {
+        even += data[i];
+        odd += data[i + 1];
+    }
+    double total = even + odd;
+    if (i < n) total += data[i];
+    return total;
+}
+
+// Integer extremes are exact in any order. n > 0.
+static int extremeTroop(const int* data, size_t n, bool greatest, bool packed) {
+    size_t i = 0;
+    int best = data[0];
+#if SQUAD_SSE2
+    if (packed && n >= 4) {
+        __m128i lanes = _mm_loadu_si128((const __m128i*)data);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128i next = _mm_loadu_si128((const __m128i*)(data + i));
+            __m128i better = greatest ? _mm_cmpgt_epi32(next, lanes) : _mm_cmplt_epi32(next, lanes);
+            lanes = _mm_or_si128(_mm_and_si128(better, next), _mm_andnot_si128(better, lanes));
+        }
+        int partial[4];
+        _mm_storeu_si128((__m128i*)partial, lanes);
+        for (int lane = 0; lane < 4; lane++) {
+            if (greatest ? partial[lane] > best : partial[lane] < best) best = partial[lane];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (greatest ? data[i] > best : data[i] < best) best = data[i];
+    }
+    return best;
+}
+
+// Two lanes, each keeping 'next < best ? next : best' (or '>'), as MINPD
+// and MAXPD do; NaNs therefore land the same way on every target. n > 0.
+static double extremeAmmo(const double* data, size_t n, bool greatest, bool packed) {
+    double lane0 = data[0], lane1 = data[0];
+    size_t i = 0;
+#if SQUAD_SSE2
+    if (packed) {
+        __m128d lanes = _mm_set1_pd(data[0]);
+        for (; i + 2 <= n; i += 2) {
+            __m128d next = _mm_loadu_pd(data + i);
+            lanes = greatest ? _mm_max_pd(next, lanes) : _mm_min_pd(next, lanes);
+        }
+        double partial[2];
+        _mm_storeu_pd(partial, lanes);
+        lane0 = partial[0];
+        lane1 = partial[1];
+    }
+#endif
+    for (; i + 2 <= n; i += 2) {
+        lane0 = (greatest ? data[i] > lane0 : data[i] < lane0) ? data[i] : lane0;
+        lane1 = (greatest ? data[i + 1] > lane1 : data[i + 1] < lane1) ? data[i + 1] : lane1;
+    }
+    double best = (greatest ? lane1 > lane0 : lane1 < lane0) ? lane1 : lane0;
+    if (i < n) best = (greatest ? data[i] > best : data[i] < best) ? data[i] : best;
+    return best;
+}
+
+// =============================================================================
+// 2. SQUAD OPERATIONS
+// =============================================================================
+
+static bool isComparison(TokenType op) {
+    return op == TOK_EQUAL || op == TOK_NOT_EQUAL || op == TOK_LESS || op == TOK_GREATER ||
+           op == TOK_LESS_EQUAL || op == TOK_GREATER_EQUAL;
+}
+
+[[noreturn]] static void squadOperandError(TokenType op, const Value& a, const Value& b, int line) {
+    throw RuntimeError(line, "Operator '" + Scanner::tokenTypeToString(op) + "' cannot combine " +
+                                 valueTypeName(a.type) + " and " + valueTypeName(b.type) + ".");
+}
+
+static Operand<int> troopOperand(const Value& value) {
+    if (value.isSquad()) return Operand<int>{ value.squad().troops.data(), false };
+    return Operand<int>{ &value.troop, true };
+}
+
+// Troop squads and troops are widened into 'widened' or 'number'
+static Operand<double> ammoOperand(const Value& value, vector<double>& widened, double& number) {
+    if (value.type == VAL_AMMO_SQUAD) return Operand<double>{ value.squad().ammo.data(), false };
+    if (value.type == VAL_TROOP_SQUAD) {
+        widened.assign(value.squad().troops.begin(), value.squad().troops.end());
+        return Operand<double>{ widened.data(), false };
+    }
+    number = value.asDouble();
+    return Operand<double>{ &number, true };
+}
+
+template <class T>
+static void compareAll(TokenType op, Operand<T> a, Operand<T> b, int* mask, size_t n, bool packed) {
+    switch (op) {
+        case TOK_LESS:          compare<LessOp>(a, b, mask, n, packed); break;
+        case TOK_GREATER:       compare<GreaterOp>(a, b, mask, n, packed); break;
+        case TOK_LESS_EQUAL:    compare<LessEqualOp>(a, b, mask, n, packed); break;
+        case TOK_GREATER_EQUAL: compare<GreaterEqualOp>(a, b, mask, n, packed); break;
+        case TOK_EQUAL:         compare<EqualOp>(a, b, mask, n, packed); break;
+        default:                compare<NotEqualOp>(a, b, mask, n, packed); break;
+    }
+}
+
+static void troopArithmetic(TokenType op, Operand<int> a, Operand<int> b, int* out, size_t n, bool packed, int line) {
+    switch (op) {
+        case TOK_PLUS:     elementwise<AddOp>(a, b, out, n, packed); return;
+        case TOK_MINUS:    elementwise<SubtractOp>(a, b, out, n, packed); return;
+        case TOK_MULTIPLY: elementwise<MultiplyOp>(a, b, out, n, packed); return;
+        default: break;
+    }
+    // Division has no SSE2 integer form, and every divisor needs checking
+    for (size_t i = 0; i < n; i++) {
+        int x = a[i];
+        int y = b[i];
+        if (y == 0) throw RuntimeError(line, "Division by zero.");
+        if (x == INT_MIN && y == -1) out[i] = op == TOK_DIVIDE ? INT_MIN : 0;
+        else out[i] = op == TOK_DIVIDE ? x / y : x % y;
+    }
+}
+
+static void ammoArithmetic(TokenType op, Operand<double> a, Operand<double> b, double* out, size_t n, bool packed) {
+    switch (op) {
+        case TOK_PLUS:     elementwise<AddOp>(a, b, out, n, packed); break;
+        case TOK_MINUS:    elementwise<SubtractOp>(a, b, out, n, packed); break;
+        case TOK_MULTIPLY: elementwise<MultiplyOp>(a, b, out, n, packed); break;
+        case TOK_DIVIDE:   elementwise<DivideOp>(a, b, out, n, packed); break;
+        default:
+            for (size_t i = 0; i < n; i++) out[i] = fmod(a[i], b[i]);
+            break;
+    }
+}
+
+// A squad of 'size' zeroed elements, once the run's memory budget allows it
+static Value newSquad(ValueType type, size_t size, int line) {
+    reserveMemory(sizeof(SquadObject) + size * (type == VAL_TROOP_SQUAD ? sizeof(int) : sizeof(double)), line);
+    return Value::makeSquad(type, size);
+}
+
+Value squadBinary(TokenType op, const Value& a, const Value& b, int line) {
+    bool arithmetic = op == TOK_PLUS || op == TOK_MINUS || op == TOK_MULTIPLY || op == TOK_DIVIDE || op == TOK_MODULO;
+    if (!(arithmetic || isComparison(op)) || !(a.isSquad() || a.isNumber()) || !(b.isSquad() || b.isNumber())) {
+        squadOperandError(op, a, b, line);
+    }
+    size_t n = a.isSquad() ? a.squadSize() : b.squadSize();
+    if (a.isSquad() && b.isSquad() && a.squadSize() != b.squadSize()) {
+        throw RuntimeError(line, "Squads of sizes " + to_string(a.squadSize()) + " and " + to_string(b.squadSize()) +
+                                 " cannot be combined.");
+    }
+
+    bool packed = packedKernels.load(memory_order_relaxed);
+    bool ammo = a.type == VAL_AMMO || a.type == VAL_AMMO_SQUAD || b.type == VAL_AMMO || b.type == VAL_AMMO_SQUAD;
+    if (!ammo) {
+        Value result = newSquad(VAL_TROOP_SQUAD, n, line);
+        int* out = result.ownSquad().troops.data();
+        if (arithmetic) troopArithmetic(op, troopOperand(a), troopOperand(b), out, n, packed, line);
+        else compareAll(op, troopOperand(a), troopOperand(b), out, n, packed);
+        return result;
+    }
+
+    vector<double> widenedA, widenedB;
+    double numberA = 0.0, numberB = 0.0;
+    Operand<double> x = ammoOperand(a, widenedA, numberA);
+    Operand<double> y = ammoOperand(b, widenedB, numberB);
+    if (!arithmetic) {
+        Value mask = newSquad(VAL_TROOP_SQUAD, n, line);
+        compareAll(op, x, y, mask.ownSquad().troops.data(), n, packed);
+        return mask;
+    }
+    Value result = newSquad(VAL_AMMO_SQUAD, n, line);
+    ammoArithmetic(op, x, y, result.ownSquad().ammo.data(), n, packed);
+    return result;
+}
+
+Value squadNegate(const Value& squad, int line) {
+    if (!squad.isSquad()) throw RuntimeError(line, "Cannot negate " + valueTypeName(squad.type) + ".");
+    size_t n = squad.squadSize();
+    Value result = newSquad(squad.type, n, line);
+    SquadObject& out = result.ownSquad();
+    if (squad.type == VAL_TROOP_SQUAD) {
+        const int* in = squad.squad().troops.data();
+        for (size_t i = 0; i < n; i++) out.troops[i] = (int)(0u - (unsigned)in[i]);
+    } else {
+        const double* in = squad.squad().ammo.data();
+        for (size_t i = 0; i < n; i++) out.ammo[i] = -in[i];
+    }
+    return result;
+}
+
+Value squadConvert(const Value& squad, ValueType type, int line) {
+    if (squad.type == type) return squad;
+    if (!squad.isSquad() || (type != VAL_TROOP_SQUAD && type != VAL_AMMO_SQUAD)) {
+        throw RuntimeError(line, "Cannot convert " + valueTypeName(squad.type) + " to " + valueTypeName(type) + ".");
+    }
+    size_t n = squad.squadSize();
+    Value result = newSquad(type, n, line);
+    SquadObject& out = result.ownSquad();
+    if (type == VAL_AMMO_SQUAD) {
+        const int* in = squad.squad().troops.data();
+        for (size_t i = 0; i < n; i++) out.ammo[i] = in[i];
+    } else {
+        const double* in = squad.squad().ammo.data();
+        for (size_t i = 0; i < n; i++) out.troops[i] = Interpreter::ammoToTroop(in[i], line);
+    }
+    return result;
+}
+
+// [1, 2, 3], with ammo elements formatted as 'brief' would
+string squadFormat(const Value& squad) {
+    ostringstream text;
+    text << "[";
+    for (size_t i = 0; i < squad.squadSize(); i++) {
+        if (i > 0) text << ", ";
+        if (squad.type == VAL_TROOP_SQUAD) text << squad.squad().troops[i];
+        else text << squad.squad().ammo[i];
+    }
+    text << "]";
+    return text.str();
+}
+
+Value makeSquadLiteral(const vector<Value>& elements, int line) {
+    ValueType type = VAL_TROOP_SQUAD;
+    for (const Value& element : elements) {
+        if (!element.isNumber()) {
+            throw RuntimeError(line, "A squad holds troop or ammo, not " + valueTypeName(element.type) + ".");
+        }
+        if (element.type == VAL_AMMO) type = VAL_AMMO_SQUAD;
+    }
+    Value squad = newSquad(type, elements.size(), line);
+    SquadObject& out = squad.ownSquad();
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (type == VAL_TROOP_SQUAD) out.troops[i] = elements[i].troop;
+        else out.ammo[i] = elements[i].asDouble();
+    }
+    return squad;
+}
+
+// The position 'index' names in 'squad', or a RuntimeError
+static size_t checkIndex(const Value& squad, const Value& index, int line) {
+    if (!squad.isSquad()) {
+        throw RuntimeError(line, "Only a squad can be indexed, not " + valueTypeName(squad.type) + ".");
+    }
+    if (index.type != VAL_TROOP) {
+        throw RuntimeError(line, "A squad index must be a troop, not " + valueTypeName(index.type) + ".");
+    }
+    if (index.troop < 0 || (size_t)index.troop >= squad.squadSize()) {
+        throw RuntimeError(line, "Index " + to_string(index.troop) + " is out of range for a squad of " +
+                                 to_string(squad.squadSize()) + ".");
+    }
+    return (size_t)index.troop;
+}
+
+Value squadElement(const Value& squad, const Value& index, int line) {
+    size_t i = checkIndex(squad, index, line);
+    if (squad.type == VAL_TROOP_SQUAD) return Value::makeTroop(squad.squad().troops[i]);
+    return Value::makeAmmo(squad.squad().ammo[i]);
+}
+
+Value squadStore(Value& squad, const Value& index, const Value& element, int line) {
+    size_t i = checkIndex(squad, index, line);
+    if (squad.squad().refs.load(memory_order_acquire) != 1) {
+        reserveMemory((size_t)squad.squad().bytes(), line);   // ownSquad() will copy it
+    }
+    if (squad.type == VAL_TROOP_SQUAD) {
+        Value value = element.type == VAL_TROOP ? element : Interpreter::convert(element, VAL_TROOP, line);
+        squad.ownSquad().troops[i] = value.troop;
+        return value;
+    }
+    Value value = element.type == VAL_AMMO ? element : Interpreter::convert(element, VAL_AMMO, line);
+    squad.ownSquad().ammo[i] = value.ammo;
+    return value;
+}
+
+// =============================================================================
+// 3. BUILT-INS
+// =============================================================================
+
+struct BuiltinInfo {
+    const char* name;
+    size_t arity;
+};
+
+// In Builtin order
+static const BuiltinInfo builtins[] = {
+    { "size", 1 }, { "sum", 1 }, { "min", 1 }, { "max", 1 }, { "fill", 2 }, { "range", 1 }
+};
+
+bool findBuiltin(const string& name, Builtin& builtin) {
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (name == builtins[i].name) {
+            builtin = (Builtin)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t builtinArity(Builtin builtin) {
+    return builtins[builtin].arity;
+}
+
+const char* builtinName(Builtin builtin) {
+    return builtins[builtin].name;
+}
+
+// A count argument: a troop of at least 0
+static size_t countArgument(Builtin builtin, const Value& count, int line) {
+    if (count.type != VAL_TROOP || count.troop < 0) {
+        throw RuntimeError(line, string(builtinName(builtin)) + "() needs a count of at least 0, not " +
+                                 (count.type == VAL_TROOP ? to_string(count.troop) : valueTypeName(count.type)) + ".");
+    }
+    return (size_t)count.troop;
+}
+
+Value callBuiltin(Builtin builtin, const Value* args, int line) {
+    if (builtin == BUILTIN_FILL) {
+        size_t count = countArgument(builtin, args[0], line);
+        if (!args[1].isNumber()) {
+            throw RuntimeError(line, "fill() needs a troop or ammo value, not " + valueTypeName(args[1].type) + ".");
+        }
+        if (args[1].type == VAL_TROOP) {
+            Value squad = newSquad(VAL_TROOP_SQUAD, count, line);
+            fill(squad.ownSquad().troops.begin(), squad.ownSquad().troops.end(), args[1].troop);
+            return squad;
+        }
+        Value squad = newSquad(VAL_AMMO_SQUAD, count, line);
+        fill(squad.ownSquad().ammo.begin(), squad.ownSquad().ammo.end(), args[1].ammo);
+        return squad;
+    }
+    if (builtin == BUILTIN_RANGE) {
+        size_t count = countArgument(builtin, args[0], line);
+        Value squad = newSquad(VAL_TROOP_SQUAD, count, line);
+        int* out = squad.ownSquad().troops.data();
+        for (size_t i = 0; i < count; i++) out[i] = (int)i;
+        return squad;
+    }
+
+    const Value& squad = args[0];
+    if (!squad.isSquad()) {
+        throw RuntimeError(line, string(builtinName(builtin)) + "() needs a squad, not " + valueTypeName(squad.type) + ".");
+    }
+    size_t n = squad.squadSize();
+    bool troops = squad.type == VAL_TROOP_SQUAD;
+    bool packed = packedKernels.load(memory_order_relaxed);
+    switch (builtin) {
+        case BUILTIN_SIZE:
+            return Value::makeTroop((int)n);
+        case BUILTIN_SUM:
+            if (troops) return Value::makeTroop(sumTroops(squad.squad().troops.data(), n, packed));
+            return Value::makeAmmo(sumAmmo(squad.squad().ammo.data(), n, packed));
+        default: {
+            if (n == 0) throw RuntimeError(line, string(builtinName(builtin)) + "() of an empty squad.");
+            bool greatest = builtin == BUILTIN_MAX;
+            if (troops) return Value::makeTroop(extremeTroop(squad.squad().troops.data(), n, greatest, packed));
+            return Value::makeAmmo(extremeAmmo(squad.squad().ammo.data(), n, greatest, packed));
+        }
+    }
+}
+
+// =============================================================================
+// 4. KERNEL SELECTION
+// =============================================================================
+
+bool squadPackedKernels() {
+    return packedKernels.load(memory_order_relaxed);
+}
+
+bool setSquadPackedKernels(bool packed) {
+    bool previous = packedKernels.load(memory_order_relaxed);
+    packedKernels.store(packed && SQUAD_SSE2, memory_order_relaxed);
+    return previous;
+}
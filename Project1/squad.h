@@ -0,0 +1,61 @@
+#ifndef SQUAD_H
+#define SQUAD_H
+
+#include <string>
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+// =============================================================================
+// 1. SQUAD OPERATIONS
+// =============================================================================
+
+// Shared by the Interpreter and the IR executor. Each works on a whole
+// squad at once through the packed kernels in squad.cpp, and throws
+// RuntimeError with messages in the style of the scalar operators.
+
+// 'a op b' where at least one side is a squad and the other a squad or a
+// number. + - * / % apply elementwise (troop unless either side is ammo);
+// comparisons give a troop squad mask of 0s and 1s.
+Value squadBinary(TokenType op, const Value& a, const Value& b, int line);
+Value squadNegate(const Value& squad, int line);
+
+// Between troop and ammo squads, element by element as for scalars
+Value squadConvert(const Value& squad, ValueType type, int line);
+string squadFormat(const Value& squad);
+
+// [e1, e2, ...]: a troop squad unless some element is ammo
+Value makeSquadLiteral(const vector<Value>& elements, int line);
+
+// squad[index], and 'squad[index] = element', which converts the element
+// to the squad's element type and returns it. Storing copies the elements
+// first only if another Value shares them.
+Value squadElement(const Value& squad, const Value& index, int line);
+Value squadStore(Value& squad, const Value& index, const Value& element, int line);
+
+// =============================================================================
+// 2. BUILT-INS
+// =============================================================================
+
+// Looks up a built-in by name. Returns false if there is none.
+bool findBuiltin(const string& name, Builtin& builtin);
+size_t builtinArity(Builtin builtin);
+const char* builtinName(Builtin builtin);
+
+// 'args' holds builtinArity(builtin) evaluated arguments
+Value callBuiltin(Builtin builtin, const Value* args, int line);
+
+// =============================================================================
+// 3. KERNEL SELECTION
+// =============================================================================
+
+// Whether the operations above run the packed SSE2 kernels, as they do by
+// default where the target has SSE2, or the scalar loops every other target
+// runs. Both give the same bits; tests switch between them to check that.
+// Switch only while no program is running. Returns the previous setting;
+// asking for packed kernels without SSE2 leaves them off.
+bool squadPackedKernels();
+bool setSquadPackedKernels(bool packed);
+
+#endif // SQUAD_H
@@ -0,0 +1,72 @@
+#include "tacticlang.h"
+#include "image.h"
+#include <sstream>
+
+// =============================================================================
+// 1. COMPILED PROGRAMS
+// =============================================================================
+
+ProgramHandle compileProgram(const string& source, const SourceOptions& options, string& errors) {
+    shared_ptr<Interner> names = make_shared<Interner>();
+    InternerScope scope(names.get());
+    ostringstream diagnostics;
+    ostream silent(nullptr);   // Progress notes are for the command line
+    Compilation compilation(options.name, false, diagnostics, silent, options.findModule);
+    bool ok = compilation.scan(source) && compilation.parse() && compilation.supply() && compilation.resolve();
+    errors = diagnostics.str();
+    if (!ok) return nullptr;
+
+    compilation.link(options.linkOptions);
+    compilation.program.names = names;
+    return make_shared<const CompiledProgram>(move(compilation.program));
+}
+
+ProgramHandle loadProgram(const string& imagePath, string& errors) {
+    Program program;
+    program.names = make_shared<Interner>();
+    InternerScope scope(program.names.get());
+    try {
+        loadImage(imagePath, program);
+    } catch (ImageError& e) {
+        errors = e.what();
+        return nullptr;
+    }
+    return make_shared<const CompiledProgram>(move(program));
+}
+
+// =============================================================================
+// 2. EXECUTION CONTEXTS
+// =============================================================================
+
+static RunOptions singleThreaded() {
+    RunOptions options;
+    options.workers = 1;
+    return options;
+}
+
+ExecutionContext::ExecutionContext(ProgramHandle program)
+    : program(move(program)), options(singleThreaded()) {}
+
+ExecutionContext::ExecutionContext(ProgramHandle program, const RunOptions& options)
+    : program(move(program)), options(options) {}
+
+void ExecutionContext::brief(const string& text) {
+    if (briefHandler) briefHandler(text);
+}
+
+bool ExecutionContext::intel(string& line) {
+    return intelHandler && intelHandler(line);
+}
+
+Value ExecutionContext::run() {
+    Interpreter interpreter(program->getProgram(), options, *this);
+    Value result;
+    try {
+        result = interpreter.run();
+    } catch (...) {
+        stepsUsed = interpreter.getStepsUsed();
+        throw;
+    }
+    stepsUsed = interpreter.getStepsUsed();
+    return result;
+}
@@ -0,0 +1,94 @@
+#ifndef TACTICLANG_H
+#define TACTICLANG_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "ast.h"
+#include "compiler.h"
+#include "interpreter.h"
+#include "linker.h"
+
+using namespace std;
+
+// The embedding interface of the TacticLang library: compile a program
+// once, then run it from any number of ExecutionContexts on any threads.
+
+// =============================================================================
+// 1. COMPILED PROGRAMS
+// =============================================================================
+
+// A program that compiled, resolved and linked. Nothing changes it once it
+// is built, so contexts share it through a ProgramHandle and the last
+// handle to go frees it, along with the names it interned (Program::names).
+class CompiledProgram {
+private:
+    Program program;
+
+public:
+    explicit CompiledProgram(Program&& program) : program(move(program)) {}
+
+    const Program& getProgram() const { return program; }
+    size_t getTacticCount() const { return program.functions.size(); }
+};
+
+typedef shared_ptr<const CompiledProgram> ProgramHandle;
+
+struct SourceOptions {
+    string name = "main.tac";   // The source's path, for '#supply' and messages
+    ModuleFinder findModule = findNoModule;   // findModuleFile reads Name.tac beside 'name'
+    LinkOptions linkOptions;
+};
+
+// Compiles source held in memory, checking every tactic body as --validate
+// does. Returns null if it does not compile. Diagnostics, and any warnings
+// of a compile that succeeds, are left in 'errors'.
+ProgramHandle compileProgram(const string& source, const SourceOptions& options, string& errors);
+
+// Loads an image written by --emit-image, or returns null with the reason in 'errors'
+ProgramHandle loadProgram(const string& imagePath, string& errors);
+
+// =============================================================================
+// 2. EXECUTION CONTEXTS
+// =============================================================================
+
+// Runs a shared program with its own I/O handlers and budgets. An idle
+// context holds only its handle, handlers and options. Each run builds
+// fresh globals and a frame stack that starts at 64 slots and grows as the
+// program recurses, and frees both when it ends. One context runs one
+// campaign at a time; separate contexts may run at once on any threads.
+class ExecutionContext : private RunIO {
+public:
+    typedef function<void(const string& text)> BriefHandler;
+    typedef function<bool(string& line)> IntelHandler;   // Returns false when there is no input
+
+private:
+    ProgramHandle program;
+    RunOptions options;
+    BriefHandler briefHandler;
+    IntelHandler intelHandler;
+    long long stepsUsed = 0;
+
+    void brief(const string& text) override;
+    bool intel(string& line) override;
+
+public:
+    // Runs 'deploy parallel' loops on the calling thread
+    explicit ExecutionContext(ProgramHandle program);
+    ExecutionContext(ProgramHandle program, const RunOptions& options);
+
+    // Without handlers, 'brief' text is dropped and 'intel' has no input
+    void setBriefHandler(BriefHandler handler) { briefHandler = move(handler); }
+    void setIntelHandler(IntelHandler handler) { intelHandler = move(handler); }
+
+    // Runs 'campaign' from fresh globals and returns what it retreats with.
+    // Throws RuntimeError, or LimitError once options.maxSteps or
+    // options.maxMemory is used up.
+    Value run();
+
+    // Statements executed by the last run, whether or not it finished
+    long long getStepsUsed() const { return stepsUsed; }
+    const RunOptions& getOptions() const { return options; }
+};
+
+#endif // TACTICLANG_H
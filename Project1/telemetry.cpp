@@ -0,0 +1,185 @@
+#include "telemetry.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// =============================================================================
+// 1. ALLOCATION-COUNTING HOOK
+// =============================================================================
+
+// Replacing the global operator new is the only portable way to see every
+// heap allocation (std::string, std::vector, Token lists, ...). The counters
+// are relaxed atomics, so the cost per allocation is two uncontended adds.
+
+static atomic<uint64_t> g_allocations(0);
+static atomic<uint64_t> g_allocatedBytes(0);
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, memory_order_relaxed);
+    if (size == 0) size = 1;
+    while (true) {
+        void* p = malloc(size);
+        if (p) return p;
+        new_handler handler = get_new_handler();
+        if (!handler) throw bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+uint64_t allocationCount() {
+    return g_allocations.load(memory_order_relaxed);
+}
+
+uint64_t allocatedByteCount() {
+    return g_allocatedBytes.load(memory_order_relaxed);
+}
+
+// --- Peak RSS ---
+size_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;          // Already in bytes
+#else
+    return (size_t)usage.ru_maxrss * 1024;   // Reported in kilobytes
+#endif
+#endif
+}
+
+// =============================================================================
+// 2. PHASE STATISTICS
+// =============================================================================
+
+double PhaseStats::tokensPerSecond() const {
+    if (tokens == 0 || wallMs <= 0.0) return 0.0;
+    return tokens / (wallMs / 1000.0);
+}
+
+// =============================================================================
+// 3. TELEMETRY COLLECTOR
+// =============================================================================
+
+Telemetry& Telemetry::instance() {
+    static Telemetry telemetry;
+    return telemetry;
+}
+
+void Telemetry::record(const PhaseStats& stats) {
+    phases.push_back(stats);
+}
+
+void Telemetry::printText(ostream& out) const {
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << "Phase statistics" << endl;
+    out << "----------------" << endl;
+    out << left << setw(14) << "phase"
+        << right << setw(12) << "wall ms"
+        << setw(14) << "tokens/s"
+        << setw(12) << "bytes"
+        << setw(10) << "allocs"
+        << setw(14) << "alloc bytes"
+        << setw(14) << "peak RSS KB" << endl;
+
+    out << fixed;
+    for (const PhaseStats& p : phases) {
+        out << left << setw(14) << p.name
+            << right << setw(12) << setprecision(3) << p.wallMs
+            << setw(14) << setprecision(0) << p.tokensPerSecond()
+            << setw(12) << p.bytes
+            << setw(10) << p.allocations
+            << setw(14) << p.allocatedBytes
+            << setw(14) << p.peakRss / 1024 << endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// JSON allows no raw control character in a string: each goes out as \u00XX
+static string jsonEscape(const string& text) {
+    static const char hex[] = "0123456789abcdef";
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char)c < 0x20) {
+            escaped += "\\u00";
+            escaped += hex[(unsigned char)c >> 4];
+            escaped += hex[c & 0xf];
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void Telemetry::printJson(ostream& out) const {
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << fixed << setprecision(3);
+    out << "{\"phases\":[";
+    for (size_t i = 0; i < phases.size(); i++) {
+        const PhaseStats& p = phases[i];
+        if (i > 0) out << ",";
+        out << "{\"name\":\"" << jsonEscape(p.name) << "\""
+            << ",\"wall_ms\":" << p.wallMs
+            << ",\"tokens\":" << p.tokens
+            << ",\"tokens_per_sec\":" << p.tokensPerSecond()
+            << ",\"bytes\":" << p.bytes
+            << ",\"allocations\":" << p.allocations
+            << ",\"allocated_bytes\":" << p.allocatedBytes
+            << ",\"peak_rss_bytes\":" << p.peakRss << "}";
+    }
+    out << "]}" << endl;
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// =============================================================================
+// 4. PHASE SCOPE
+// =============================================================================
+
+PhaseScope::PhaseScope(const string& name)
+    : startAllocations(allocationCount()), startBytes(allocatedByteCount()) {
+    stats.name = name;
+    startTime = chrono::steady_clock::now();
+}
+
+PhaseScope::~PhaseScope() {
+    chrono::steady_clock::time_point endTime = chrono::steady_clock::now();
+    stats.wallMs = chrono::duration<double, milli>(endTime - startTime).count();
+    stats.allocations = allocationCount() - startAllocations;
+    stats.allocatedBytes = allocatedByteCount() - startBytes;
+    stats.peakRss = peakResidentBytes();
+    Telemetry::instance().record(stats);
+}
@@ -0,0 +1,84 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+using namespace std;
+
+// =============================================================================
+// 1. PHASE STATISTICS
+// =============================================================================
+
+// Numbers recorded for one compiler phase (read, scan, parse, ...)
+struct PhaseStats {
+    string name;
+    double wallMs = 0.0;          // Wall time spent in the phase
+    size_t bytes = 0;             // Source bytes processed (0 if not applicable)
+    size_t tokens = 0;            // Tokens produced or consumed (0 if not applicable)
+    uint64_t allocations = 0;     // Heap allocations made during the phase
+    uint64_t allocatedBytes = 0;  // Heap bytes requested during the phase
+    size_t peakRss = 0;           // Process peak RSS when the phase ended
+
+    double tokensPerSecond() const;
+};
+
+// =============================================================================
+// 2. TELEMETRY COLLECTOR
+// =============================================================================
+
+class Telemetry {
+private:
+    vector<PhaseStats> phases;
+
+public:
+    // --- Public Interface ---
+    static Telemetry& instance();
+
+    void record(const PhaseStats& stats);
+    const vector<PhaseStats>& getPhases() const { return phases; }
+    void reset() { phases.clear(); }
+
+    void printText(ostream& out) const;  // --stats
+    void printJson(ostream& out) const;  // --stats-json
+};
+
+// =============================================================================
+// 3. PHASE SCOPE
+// =============================================================================
+
+// RAII timer: measures everything between construction and destruction
+// and records it into Telemetry::instance() as one phase.
+class PhaseScope {
+private:
+    PhaseStats stats;
+    chrono::steady_clock::time_point startTime;
+    uint64_t startAllocations;
+    uint64_t startBytes;
+
+public:
+    explicit PhaseScope(const string& name);
+    ~PhaseScope();
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+    void setBytes(size_t bytes) { stats.bytes = bytes; }
+    void setTokens(size_t tokens) { stats.tokens = tokens; }
+};
+
+// =============================================================================
+// 4. PROCESS COUNTERS
+// =============================================================================
+
+// Running totals maintained by the global operator new in telemetry.cpp
+uint64_t allocationCount();
+uint64_t allocatedByteCount();
+
+// Peak resident set size of the process, in bytes (0 if unavailable)
+size_t peakResidentBytes();
+
+#endif // TELEMETRY_H
@@ -0,0 +1,174 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+// =============================================================================
+// 1. RUNTIME VALUES
+// =============================================================================
+
+// The TacticLang types. VAL_NONE is what a tactic produces when it
+// retreats without a value.
+enum ValueType {
+    VAL_TROOP,         // int
+    VAL_AMMO,          // double
+    VAL_CODENAME,      // string
+    VAL_STATUS,        // bool
+    VAL_TROOP_SQUAD,   // packed ints
+    VAL_AMMO_SQUAD,    // packed doubles
+    VAL_NONE
+};
+
+// Adds 'bytes' (or takes them back, if negative) to the memory account of
+// the run on this thread, if there is one. See MemoryAccount in interpreter.h.
+void chargeMemory(long long bytes);
+
+// Immutable, reference-counted text of a codename value.
+// Copying a codename Value only bumps the count.
+struct StringObject {
+    atomic<int> refs;
+    const string text;
+
+    explicit StringObject(const string& text) : refs(1), text(text) {}
+
+    long long bytes() const { return (long long)(sizeof(StringObject) + text.size()); }
+};
+
+// Packed elements of a squad, shared between Values like a StringObject.
+// A squad is copied before an element changes unless one Value owns it.
+struct SquadObject {
+    atomic<int> refs;
+    vector<int> troops;    // VAL_TROOP_SQUAD
+    vector<double> ammo;   // VAL_AMMO_SQUAD
+
+    SquadObject() : refs(1) {}
+
+    long long bytes() const {
+        return (long long)(sizeof(SquadObject) + troops.size() * sizeof(int) + ammo.size() * sizeof(double));
+    }
+};
+
+// Credit a shared object's bytes back and delete it; out of line so that
+// copying and destroying a Value stays small enough to inline
+void freeObject(StringObject* object);
+void freeObject(SquadObject* object);
+
+// A 16-byte tagged value. Numbers and statuses are stored inline, so copying
+// them never touches the heap; codenames and squads share a counted object.
+struct Value {
+    ValueType type;
+    union {
+        int troop;
+        double ammo;
+        bool status;
+        StringObject* string_;  // VAL_CODENAME
+        SquadObject* squad_;    // VAL_TROOP_SQUAD, VAL_AMMO_SQUAD
+    };
+
+    Value() : type(VAL_NONE), ammo(0.0) {}
+
+    Value(const Value& other) : type(other.type), ammo(other.ammo) {
+        retain();
+    }
+
+    Value(Value&& other) noexcept : type(other.type), ammo(other.ammo) {
+        other.type = VAL_NONE;
+    }
+
+    Value& operator=(const Value& other) {
+        other.retain();
+        release();
+        type = other.type;
+        ammo = other.ammo;
+        return *this;
+    }
+
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            type = other.type;
+            ammo = other.ammo;
+            other.type = VAL_NONE;
+        }
+        return *this;
+    }
+
+    ~Value() { release(); }
+
+    static Value makeTroop(int v) { Value r; r.type = VAL_TROOP; r.troop = v; return r; }
+    static Value makeAmmo(double v) { Value r; r.type = VAL_AMMO; r.ammo = v; return r; }
+    static Value makeStatus(bool v) { Value r; r.type = VAL_STATUS; r.status = v; return r; }
+    static Value makeCodename(const string& v) {
+        Value r;
+        r.type = VAL_CODENAME;
+        r.string_ = new StringObject(v);
+        chargeMemory(r.string_->bytes());
+        return r;
+    }
+    // 'size' zeroed elements of a VAL_TROOP_SQUAD or VAL_AMMO_SQUAD
+    static Value makeSquad(ValueType type, size_t size) {
+        Value r;
+        r.type = type;
+        r.squad_ = new SquadObject();
+        if (type == VAL_TROOP_SQUAD) r.squad_->troops.resize(size);
+        else r.squad_->ammo.resize(size);
+        chargeMemory(r.squad_->bytes());
+        return r;
+    }
+
+    // The value a declared-but-uninitialized variable starts with
+    static Value defaultFor(ValueType type) {
+        switch (type) {
+            case VAL_TROOP:    return makeTroop(0);
+            case VAL_AMMO:     return makeAmmo(0.0);
+            case VAL_CODENAME: return makeCodename("");
+            case VAL_STATUS:   return makeStatus(false);
+            case VAL_TROOP_SQUAD:
+            case VAL_AMMO_SQUAD:   return makeSquad(type, 0);
+            default:           return Value();
+        }
+    }
+
+    bool isNumber() const { return type == VAL_TROOP || type == VAL_AMMO; }
+    double asDouble() const { return type == VAL_AMMO ? ammo : (double)troop; }
+    const string& codename() const { return string_->text; }
+
+    bool isSquad() const { return type == VAL_TROOP_SQUAD || type == VAL_AMMO_SQUAD; }
+    const SquadObject& squad() const { return *squad_; }
+    size_t squadSize() const { return type == VAL_TROOP_SQUAD ? squad_->troops.size() : squad_->ammo.size(); }
+
+    // The squad's elements, for writing: copied first if another Value shares them
+    SquadObject& ownSquad() {
+        if (squad_->refs.load(memory_order_acquire) != 1) {
+            SquadObject* copy = new SquadObject();
+            copy->troops = squad_->troops;
+            copy->ammo = squad_->ammo;
+            chargeMemory(copy->bytes());
+            release();
+            squad_ = copy;
+        }
+        return *squad_;
+    }
+
+private:
+    void retain() const {
+        if (type == VAL_CODENAME) string_->refs.fetch_add(1, memory_order_relaxed);
+        else if (isSquad()) squad_->refs.fetch_add(1, memory_order_relaxed);
+    }
+
+    void release() {
+        if (type == VAL_CODENAME && string_->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+            freeObject(string_);
+        } else if (isSquad() && squad_->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+            freeObject(squad_);
+        }
+    }
+};
+
+string valueTypeName(ValueType type);
+
+#endif // VALUE_H
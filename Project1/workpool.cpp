@@ -0,0 +1,101 @@
+#include "workpool.h"
+
+// =============================================================================
+// 1. SETUP
+// =============================================================================
+
+WorkPool::WorkPool(int workers) : remaining(0) {
+    if (workers <= 0) workers = (int)thread::hardware_concurrency();
+    if (workers <= 0) workers = 1;
+    for (int i = 0; i < workers; i++) queues.push_back(unique_ptr<Queue>(new Queue()));
+    for (int i = 1; i < workers; i++) threads.push_back(thread(&WorkPool::threadMain, this, i));
+}
+
+WorkPool::~WorkPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& worker : threads) worker.join();
+}
+
+// =============================================================================
+// 2. BATCHES
+// =============================================================================
+
+void WorkPool::run(size_t taskCount, const TaskBody& body) {
+    if (taskCount == 0) return;
+    {
+        lock_guard<mutex> guard(lock);
+        this->body = &body;
+        remaining = taskCount;
+        size_t workers = queues.size();
+        for (size_t w = 0; w < workers; w++) {
+            lock_guard<mutex> queueGuard(queues[w]->lock);
+            for (size_t task = taskCount * w / workers; task < taskCount * (w + 1) / workers; task++) {
+                queues[w]->tasks.push_back(task);
+            }
+        }
+        batch++;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    // A pool thread may still be finishing its last task
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [this] { return remaining == 0 && active == 0; });
+    this->body = nullptr;
+}
+
+// Own queue from the front, then the other queues from the back
+bool WorkPool::take(int worker, size_t& task) {
+    int workers = (int)queues.size();
+    for (int i = 0; i < workers; i++) {
+        Queue& queue = *queues[(worker + i) % workers];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        } else {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+// Every task is dealt before any worker starts, so once no queue has
+// work left, none will get more in this batch
+void WorkPool::work(int worker) {
+    size_t task;
+    while (take(worker, task)) {
+        (*body)(task, worker);
+        if (remaining.fetch_sub(1) == 1) {
+            lock_guard<mutex> guard(lock);
+            done.notify_all();
+        }
+    }
+}
+
+void WorkPool::threadMain(int worker) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || batch != seen; });
+            if (stopping) return;
+            seen = batch;
+            active++;
+        }
+        work(worker);
+        {
+            lock_guard<mutex> guard(lock);
+            active--;
+            if (remaining == 0 && active == 0) done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// =============================================================================
+// 1. WORK-STEALING POOL
+// =============================================================================
+
+// A fixed set of threads that run batches of numbered tasks.
+// run() deals the tasks out in contiguous runs, one run per worker. Each
+// worker takes tasks from the front of its own queue and, once that is
+// empty, steals from the back of another worker's. The thread that calls
+// run() takes part as worker 0, so a pool of size 1 starts no threads.
+class WorkPool {
+public:
+    // Called once per task, with the index of the worker running it.
+    // It must not throw.
+    typedef function<void(size_t task, int worker)> TaskBody;
+
+    // 'workers' counts the calling thread; 0 means one per hardware thread
+    explicit WorkPool(int workers);
+    ~WorkPool();
+
+    int size() const { return (int)queues.size(); }
+
+    // Runs body(task, worker) for every task in [0, taskCount) and returns
+    // once all of them have finished. Not reentrant.
+    void run(size_t taskCount, const TaskBody& body);
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> threads;
+
+    mutex lock;                  // Guards everything below
+    condition_variable wake;     // A new batch was dealt, or the pool is stopping
+    condition_variable done;     // The last task of a batch finished
+    const TaskBody* body = nullptr;
+    unsigned long long batch = 0;
+    int active = 0;              // Pool threads inside work()
+    bool stopping = false;
+
+    atomic<size_t> remaining;
+
+    bool take(int worker, size_t& task);
+    void work(int worker);
+    void threadMain(int worker);
+};
+
+#endif // WORKPOOL_H
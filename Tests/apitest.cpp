@@ -0,0 +1,226 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+// The embedding interface as a host uses it: where '#supply' may look,
+// the brief and intel handlers, the memory budget, and one compiled
+// program shared by contexts on several threads.
+
+static ProgramHandle compileSource(const string& source, const SourceOptions& options = SourceOptions()) {
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    return program;
+}
+
+static bool contains(const string& text, const string& part) {
+    return text.find(part) != string::npos;
+}
+
+// =============================================================================
+// 1. MODULES
+// =============================================================================
+
+// Without a finder, '#supply' reads nothing, even with the file right there
+TEST_CASE(apiSupplyReadsNoFilesByDefault) {
+    const char* modulePath = "ApiModule.tac";
+    {
+        ofstream module(modulePath);
+        module << "tactic helper() { retreat 7; }\n";
+    }
+    const string source = "#supply ApiModule\ntactic campaign() { retreat helper(); }\n";
+
+    SourceOptions options;   // main.tac, in the directory the module is in
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK(program == nullptr);
+    CHECK(contains(errors, "Warning: Supplied module 'ApiModule' not found"));
+    CHECK(contains(errors, "helper"));
+
+    // The host opts in to files, or hands the source over itself
+    options.findModule = findModuleFile;
+    program = compileSource(source, options);
+    if (program) CHECK_EQ(ExecutionContext(program).run().troop, 7);
+    remove(modulePath);
+
+    options.findModule = [](const string& name, const string&, string& path, string& text) {
+        path = "memory:" + name;
+        text = "tactic helper() { retreat 9; }\n";
+        return name == "ApiModule";
+    };
+    program = compileSource(source, options);
+    if (program) CHECK_EQ(ExecutionContext(program).run().troop, 9);
+}
+
+// =============================================================================
+// 2. BRIEF AND INTEL
+// =============================================================================
+
+static const char* echoSource =
+    "tactic campaign() {\n"
+    "    troop count; ammo scale; codename name; status ready;\n"
+    "    intel count; intel scale; intel name; intel ready;\n"
+    "    brief name;\n"
+    "    deploy (troop i = 0; i < count; i = i + 1) { brief i * scale; }\n"
+    "    brief ready;\n"
+    "    retreat count;\n"
+    "}\n";
+
+// Runs with 'input' as the intel lines; the brief lines, then the error if any
+static string converse(ProgramHandle program, const vector<string>& input, size_t* linesRead = nullptr) {
+    ExecutionContext context(program);
+    string output;
+    size_t next = 0;
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    context.setIntelHandler([&](string& line) {
+        if (next == input.size()) return false;
+        line = input[next++];
+        return true;
+    });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += string(e.what()) + "\n";
+    }
+    if (linesRead) *linesRead = next;
+    return output;
+}
+
+TEST_CASE(apiBriefAndIntelHandlers) {
+    ProgramHandle program = compileSource(echoSource);
+    if (!program) return;
+
+    size_t linesRead = 0;
+    CHECK_EQ(converse(program, { "3", "1.5", "Alpha Team", "true" }, &linesRead), "Alpha Team\n0\n1.5\n3\ntrue\n");
+    CHECK_EQ(linesRead, (size_t)4);
+
+    // Input runs out, or does not parse as the variable's type
+    CHECK_EQ(converse(program, { "3", "1.5" }), "[Line 3] Runtime error: No input left for 'intel'.\n");
+    CHECK_EQ(converse(program, { "three" }), "[Line 3] Runtime error: Invalid troop input 'three'.\n");
+    CHECK_EQ(converse(program, { "2", "1.5", "x", "yes" }), "[Line 3] Runtime error: Invalid status input 'yes'.\n");
+    CHECK_EQ(converse(program, { "2\r", "0.5\r", "x\r", "false\r" }), "x\n0\n0.5\nfalse\n");
+
+    // Without handlers, brief text is dropped and intel has no input
+    ExecutionContext bare(program);
+    try {
+        bare.run();
+        CHECK(false);
+    } catch (RuntimeError& e) {
+        CHECK_EQ(string(e.what()), "[Line 3] Runtime error: No input left for 'intel'.");
+    }
+}
+
+// =============================================================================
+// 3. MEMORY BUDGET
+// =============================================================================
+
+static string runWithMemory(ProgramHandle program, size_t maxMemory) {
+    RunOptions options;
+    options.maxMemory = maxMemory;
+    ExecutionContext context(program, options);
+    try {
+        context.run();
+    } catch (LimitError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST_CASE(apiMemoryLimit) {
+    // A codename that doubles each step, and a squad built all at once
+    ProgramHandle text = compileSource("tactic campaign() {\n"
+                                       "    codename s = \"ab\";\n"
+                                       "    deploy (troop i = 0; i < 20; i = i + 1) { s = s + s; }\n"
+                                       "    brief s;\n"
+                                       "}\n");
+    ProgramHandle squad = compileSource("tactic campaign() {\n"
+                                        "    squad troop s = fill(100000, 1);\n"
+                                        "    retreat sum(s);\n"
+                                        "}\n");
+    if (!text || !squad) return;
+
+    CHECK_EQ(runWithMemory(text, 64 * 1024), "[Line 3] Runtime error: Memory limit exceeded (64 KB).");
+    CHECK_EQ(runWithMemory(text, 0), "");
+    CHECK_EQ(runWithMemory(text, 8 * 1024 * 1024), "");
+    CHECK_EQ(runWithMemory(squad, 256 * 1024), "[Line 2] Runtime error: Memory limit exceeded (256 KB).");
+    CHECK_EQ(runWithMemory(squad, 1024 * 1024), "");
+
+    // Each run starts from nothing, so three 400 KB runs fit in 1 MB
+    RunOptions options;
+    options.maxMemory = 1024 * 1024;
+    ExecutionContext context(squad, options);
+    for (int i = 0; i < 3; i++) CHECK_EQ(context.run().troop, 100000);
+}
+
+// =============================================================================
+// 4. SHARED PROGRAMS
+// =============================================================================
+
+// Contexts on separate threads share one program and nothing else: each
+// gets its own input, output, globals and step count
+TEST_CASE(apiContextsOnManyThreads) {
+    ProgramHandle program = compileSource("troop calls = 0;\n"
+                                          "tactic fib(troop n) {\n"
+                                          "    calls = calls + 1;\n"
+                                          "    evaluate (n < 2) { retreat n; }\n"
+                                          "    retreat fib(n - 1) + fib(n - 2);\n"
+                                          "}\n"
+                                          "tactic campaign() {\n"
+                                          "    troop n; intel n;\n"
+                                          "    troop total = 0;\n"
+                                          "    deploy parallel (troop i = 0; i < 64; i = i + 1) { total = total + i * n; }\n"
+                                          "    brief fib(n);\n"
+                                          "    brief calls;\n"
+                                          "    retreat total;\n"
+                                          "}\n");
+    if (!program) return;
+
+    const int threadCount = 8;
+    const int runsPerThread = 20;
+    struct Outcome {
+        string output;
+        long long steps[2] = { 0, 0 };   // Of the first and the last run
+        bool failed = false;
+    };
+    vector<Outcome> outcomes(threadCount);
+    auto work = [&](int t) {
+        RunOptions options;
+        options.workers = 1 + t % 3;
+        ExecutionContext context(program, options);
+        string input = to_string(10 + t);
+        string output;
+        context.setIntelHandler([&](string& line) {
+            line = input;
+            return true;
+        });
+        context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+        for (int r = 0; r < runsPerThread; r++) {
+            output.clear();
+            Value result = context.run();
+            output += to_string(result.troop) + "\n";
+            if (r == 0) outcomes[t].output = output;
+            if (output != outcomes[t].output) outcomes[t].failed = true;
+            outcomes[t].steps[r == 0 ? 0 : 1] = context.getStepsUsed();
+        }
+    };
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) threads.emplace_back(work, t);
+    for (thread& th : threads) th.join();
+
+    for (int t = 0; t < threadCount; t++) {
+        int n = 10 + t;
+        int a = 0, b = 1, calls = 0;
+        for (int i = 0; i < n; i++) {
+            int c = a + b;
+            a = b;
+            b = c;
+        }
+        // fib(n) makes 2 fib(n + 1) - 1 calls
+        calls = 2 * b - 1;
+        CHECK_EQ(outcomes[t].output, to_string(a) + "\n" + to_string(calls) + "\n" + to_string(2016 * n) + "\n");
+        CHECK(!outcomes[t].failed);
+        CHECK_EQ(outcomes[t].steps[1], outcomes[t].steps[0]);
+    }
+}
@@ -0,0 +1,58 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+// Call overhead of the Interpreter: the same counting loop with 'acc + 1'
+// done in place and done by a one-line tactic. The difference per
+// iteration is the cost of a call. Each program runs many short times and
+// the fastest run counts, which keeps other load on the machine out of it.
+
+static const int iterations = 200000;
+static const int rounds = 150;
+
+static ProgramHandle compileBench(const string& source, bool inlineCalls) {
+    SourceOptions options;
+    options.linkOptions.inlineCalls = inlineCalls;
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    return program;
+}
+
+// Nanoseconds per loop iteration of the fastest run
+static double fastest(ExecutionContext& context) {
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        context.run();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds < best) best = seconds;
+    }
+    return best * 1e9 / iterations;
+}
+
+BENCHMARK(callOverhead) {
+    string loop = "troop acc = 0; troop i = 0; deploy (i = 0; i < " + to_string(iterations) + "; i = i + 1) { ";
+    string inPlace = "tactic campaign() { " + loop + "acc = acc + 1; } }";
+    string called = "tactic step(troop x) { retreat x + 1; }\n"
+                    "tactic campaign() { " + loop + "acc = step(acc); } }";
+
+    ProgramHandle baseProgram = compileBench(inPlace, false);
+    ProgramHandle callProgram = compileBench(called, false);
+    ProgramHandle inlinedProgram = compileBench(called, true);
+    if (!baseProgram || !callProgram || !inlinedProgram) return;
+
+    ExecutionContext base(baseProgram);
+    ExecutionContext call(callProgram);
+    ExecutionContext inlined(inlinedProgram);
+    double baseTime = fastest(base);
+    double callTime = fastest(call);
+    double inlinedTime = fastest(inlined);
+
+    cout << fixed << setprecision(1)
+         << "    loop iteration:          " << baseTime << " ns" << endl
+         << "    tactic call:             " << callTime - baseTime << " ns per call" << endl
+         << "    call inlined by linker:  " << inlinedTime - baseTime << " ns per call" << endl;
+}
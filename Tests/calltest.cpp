@@ -0,0 +1,113 @@
+#include "testing.h"
+#include "tacticlang.h"
+
+// Tactic calls in the Interpreter. 'retreat f(...)' runs f in the frame of
+// the tactic that retreats, so a tail call costs no frame depth and no
+// native stack; any other call counts against --max-depth (maxCallDepth)
+// and --max-stack (maxNativeStack), and running out of either gives the
+// diagnostic that points to 'retreat f(...)'.
+
+static const char* countdownSource =
+    "tactic countdown(troop n, troop acc) {\n"
+    "    evaluate (n == 0) { retreat acc; }\n"
+    "    retreat countdown(n - 1, acc + 2);\n"
+    "}\n"
+    "tactic even(troop n) {\n"
+    "    evaluate (n == 0) { retreat true; }\n"
+    "    retreat odd(n - 1);\n"
+    "}\n"
+    "tactic odd(troop n) {\n"
+    "    evaluate (n == 0) { retreat false; }\n"
+    "    retreat even(n - 1);\n"
+    "}\n"
+    "tactic nested(troop n) {\n"
+    "    evaluate (n == 0) { retreat 0; }\n"
+    "    retreat 1 + nested(n - 1);\n"
+    "}\n";
+
+static ProgramHandle compileCampaign(const string& campaign) {
+    SourceOptions options;
+    string errors;
+    ProgramHandle program = compileProgram(string(countdownSource) + "tactic campaign() {\n" + campaign + "\n}\n",
+                                           options, errors);
+    CHECK_EQ(errors, "");
+    return program;
+}
+
+// The brief lines of one run, then its runtime error if any
+static string runWith(ProgramHandle program, int maxCallDepth, size_t maxNativeStack, size_t stackSlots = 1 << 16) {
+    RunOptions options;
+    options.maxCallDepth = maxCallDepth;
+    options.maxNativeStack = maxNativeStack;
+    options.stackSlots = stackSlots;
+    ExecutionContext context(program, options);
+    string output;
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += string(e.what()) + "\n";
+    }
+    return output;
+}
+
+static bool contains(const string& text, const string& part) {
+    return text.find(part) != string::npos;
+}
+
+// =============================================================================
+// 1. TAIL CALLS
+// =============================================================================
+
+// A million tail calls, self and mutual, in two frames of depth, 32 KB of
+// native stack and 16 frame slots
+TEST_CASE(callTailRecursionRunsInPlace) {
+    ProgramHandle program = compileCampaign("brief countdown(1000000, 0);\n"
+                                            "brief even(1000001);");
+    if (!program) return;
+    CHECK_EQ(runWith(program, 2, 32 * 1024, 16), "2000000\nfalse\n");
+}
+
+// A tail call made at the deepest allowed depth replaces its caller, so
+// it fits exactly where a nested call would not
+TEST_CASE(callTailAtMaxDepth) {
+    ProgramHandle program = compileCampaign("retreat countdown(5, 0);");
+    ProgramHandle fromCampaign = compileCampaign("brief countdown(5, 0);");
+    if (!program || !fromCampaign) return;
+
+    CHECK_EQ(runWith(program, 1, 512 * 1024), "");
+    CHECK_EQ(runWith(fromCampaign, 2, 512 * 1024), "10\n");
+    CHECK_EQ(runWith(fromCampaign, 1, 512 * 1024),
+             "[Line 18] Runtime error: Recursion limit exceeded (1 nested tactic calls). "
+             "Use 'retreat f(...)' for deep recursion.\n");
+
+    // 'nested(n)' needs n + 1 frames above the campaign's
+    ProgramHandle deep = compileCampaign("brief nested(8);");
+    if (!deep) return;
+    CHECK_EQ(runWith(deep, 10, 512 * 1024), "8\n");
+    CHECK_EQ(runWith(deep, 9, 512 * 1024),
+             "[Line 15] Runtime error: Recursion limit exceeded (9 nested tactic calls). "
+             "Use 'retreat f(...)' for deep recursion.\n");
+}
+
+// =============================================================================
+// 2. LIMITS
+// =============================================================================
+
+TEST_CASE(callNestedRecursionLimits) {
+    ProgramHandle program = compileCampaign("brief nested(100000);");
+    if (!program) return;
+
+    CHECK_EQ(runWith(program, 1000, 64 * 1024 * 1024),
+             "[Line 15] Runtime error: Recursion limit exceeded (1000 nested tactic calls). "
+             "Use 'retreat f(...)' for deep recursion.\n");
+
+    // Depth to spare, but not the native stack
+    string output = runWith(program, 1000000, 64 * 1024);
+    CHECK(contains(output, "[Line 15] Runtime error: Recursion too deep for the native stack (64 KB, depth "));
+    CHECK(contains(output, "). Use 'retreat f(...)' for deep recursion.\n"));
+
+    // And enough of both
+    ProgramHandle shallower = compileCampaign("brief nested(2000);");
+    if (shallower) CHECK_EQ(runWith(shallower, 2002, 4 * 1024 * 1024), "2000\n");
+}
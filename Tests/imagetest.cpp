@@ -0,0 +1,218 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include "image.h"
+#include "astdump.h"
+#include "compiler.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Damages a good image in the ways a disk or a careless tool would, and
+// expects loadProgram to refuse each one with the reason it was refused.
+// Damage past the checksum is re-signed, so the structural checks of the
+// ImageReader are what catch it.
+
+static const char* imagePath = "imagetest.tlimg";
+
+static const char* source =
+    "troop base = 4;\n"
+    "tactic scale(troop x) {\n"
+    "    troop doubled = x * 2;\n"
+    "    retreat doubled + base;\n"
+    "}\n"
+    "tactic campaign() {\n"
+    "    troop total = scale(3);\n"
+    "    brief total;\n"
+    "}\n";
+
+// =============================================================================
+// 1. IMAGE BYTES
+// =============================================================================
+
+// The bytes of a freshly written image of 'source'
+static vector<unsigned char> goodImage() {
+    SourceOptions options;
+    options.linkOptions.inlineCalls = false;   // Keep both tactics in the table
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return vector<unsigned char>();
+    writeImage(program->getProgram(), imagePath);
+    ifstream file(imagePath, ios::binary);
+    return vector<unsigned char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// Loads 'bytes' as an image. Returns the error, or "" if it loaded.
+static string loadError(const vector<unsigned char>& bytes) {
+    {
+        ofstream file(imagePath, ios::binary | ios::trunc);
+        file.write((const char*)bytes.data(), (streamsize)bytes.size());
+    }
+    string errors;
+    ProgramHandle program = loadProgram(imagePath, errors);
+    remove(imagePath);
+    CHECK_EQ(program == nullptr, !errors.empty());
+    return errors;
+}
+
+static ImageHeader headerOf(const vector<unsigned char>& bytes) {
+    ImageHeader header;
+    memcpy(&header, bytes.data(), sizeof header);
+    return header;
+}
+
+// Stores the header back and recomputes the checksum as the writer does
+static void resign(vector<unsigned char>& bytes, ImageHeader header) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = sizeof header; i < bytes.size(); i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    header.checksum = h;
+    header.size = bytes.size();
+    memcpy(bytes.data(), &header, sizeof header);
+}
+
+static FunctionRecord functionRecord(const vector<unsigned char>& bytes, uint32_t index) {
+    FunctionRecord record;
+    memcpy(&record, bytes.data() + headerOf(bytes).sections[IMAGE_FUNCTIONS].offset + index * sizeof record, sizeof record);
+    return record;
+}
+
+static void setFunctionRecord(vector<unsigned char>& bytes, uint32_t index, const FunctionRecord& record) {
+    memcpy(bytes.data() + headerOf(bytes).sections[IMAGE_FUNCTIONS].offset + index * sizeof record, &record, sizeof record);
+}
+
+static bool contains(const string& text, const string& part) {
+    return text.find(part) != string::npos;
+}
+
+// =============================================================================
+// 2. FILE-LEVEL DAMAGE
+// =============================================================================
+
+TEST_CASE(imageRoundTrip) {
+    vector<unsigned char> bytes = goodImage();
+    if (bytes.empty()) return;
+    CHECK_EQ(loadError(bytes), "");
+    CHECK_EQ(headerOf(bytes).sections[IMAGE_FUNCTIONS].count, 2u);
+}
+
+TEST_CASE(imageTruncated) {
+    vector<unsigned char> bytes = goodImage();
+    if (bytes.empty()) return;
+
+    vector<unsigned char> shorter(bytes.begin(), bytes.end() - 8);
+    CHECK(contains(loadError(shorter), "truncated or padded"));
+
+    vector<unsigned char> headerOnly(bytes.begin(), bytes.begin() + sizeof(ImageHeader) / 2);
+    CHECK(contains(loadError(headerOnly), "is not a TacticLang image"));
+
+    // Cut off and re-signed: the header agrees, the section table does not
+    vector<unsigned char> resigned(bytes.begin(), bytes.begin() + headerOf(bytes).sections[IMAGE_LINES].offset);
+    resign(resigned, headerOf(bytes));
+    CHECK(contains(loadError(resigned), "Image is malformed: section 7 lies outside the file"));
+}
+
+TEST_CASE(imageBadChecksum) {
+    vector<unsigned char> bytes = goodImage();
+    if (bytes.empty()) return;
+
+    bytes[headerOf(bytes).sections[IMAGE_CODE].offset + 4] ^= 0x40;
+    CHECK(contains(loadError(bytes), "checksum does not match"));
+
+    vector<unsigned char> version = goodImage();
+    ImageHeader header = headerOf(version);
+    header.version = IMAGE_VERSION + 1;
+    resign(version, header);
+    CHECK(contains(loadError(version), "is not supported"));
+}
+
+// =============================================================================
+// 3. STRUCTURAL DAMAGE
+// =============================================================================
+
+// The frame of 'scale' cut down to its parameter: 'doubled' is past the end
+TEST_CASE(imageSlotPastFrame) {
+    vector<unsigned char> bytes = goodImage();
+    if (bytes.empty()) return;
+
+    for (uint32_t i = 0; i < headerOf(bytes).sections[IMAGE_FUNCTIONS].count; i++) {
+        FunctionRecord record = functionRecord(bytes, i);
+        if (record.paramCount != 1) continue;
+        record.frameSize = 1;
+        setFunctionRecord(bytes, i, record);
+    }
+    resign(bytes, headerOf(bytes));
+    CHECK_EQ(loadError(bytes), "Image is malformed: a declaration uses slot 1 of 1.");
+}
+
+TEST_CASE(imageBodiesOutOfPlace) {
+    vector<unsigned char> bytes = goodImage();
+    if (bytes.empty()) return;
+
+    // The second body starts one word late
+    vector<unsigned char> late = bytes;
+    FunctionRecord record = functionRecord(late, 1);
+    record.body++;
+    setFunctionRecord(late, 1, record);
+    resign(late, headerOf(late));
+    CHECK(contains(loadError(late), "Image is malformed: tactic 1 does not start where the previous one ended"));
+
+    // The bodies swapped
+    vector<unsigned char> swapped = bytes;
+    FunctionRecord first = functionRecord(swapped, 0);
+    FunctionRecord second = functionRecord(swapped, 1);
+    swap(first.body, second.body);
+    setFunctionRecord(swapped, 0, first);
+    setFunctionRecord(swapped, 1, second);
+    resign(swapped, headerOf(swapped));
+    CHECK(contains(loadError(swapped), "Image is malformed: tactic 0 does not start where the previous one ended"));
+}
+
+// =============================================================================
+// 4. ROUND TRIPS
+// =============================================================================
+
+// The output of a run followed by its runtime error, if it has one
+static string runOutput(ProgramHandle program) {
+    string output;
+    ExecutionContext context(program);
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += e.what() + string("\n");
+    }
+    return output;
+}
+
+// A loaded image is the program it was written from: the same tree, the
+// same output and the same line in a runtime error. The compact encoding
+// keeps an image within half as large again as its source.
+TEST_CASE(imageMatchesSource) {
+    const char* files[] = { "ir/basics.tac", "ir/errors.tac", "ir/licm.tac", "ir/strength.tac", "ir/convert.tac" };
+    for (const char* name : files) {
+        SourceOptions options;
+        options.name = testFile(name);
+        string source = readFile(options.name);
+        string errors;
+        ProgramHandle compiled = compileProgram(source, options, errors);
+        CHECK_EQ(errors, "");
+        if (!compiled) continue;
+
+        size_t imageBytes = writeImage(compiled->getProgram(), imagePath);
+        ProgramHandle loaded = loadProgram(imagePath, errors);
+        remove(imagePath);
+        CHECK_EQ(errors, "");
+        if (!loaded) continue;
+        CHECK(imageBytes < source.size() * 3 / 2);
+
+        ostringstream expected, actual;
+        dumpProgram(compiled->getProgram(), expected);
+        dumpProgram(loaded->getProgram(), actual);
+        CHECK_EQ(actual.str(), expected.str());
+        CHECK_EQ(runOutput(loaded), runOutput(compiled));
+    }
+}
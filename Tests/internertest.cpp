@@ -0,0 +1,155 @@
+#include "testing.h"
+#include "interner.h"
+#include "scanner.h"
+#include "tacticlang.h"
+#include "astdump.h"
+#include "ir.h"
+#include "image.h"
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+// =============================================================================
+// 1. SYMBOLS AND TOKENS
+// =============================================================================
+
+TEST_CASE(internerRoundTrip) {
+    Interner& interner = Interner::global();
+    Symbol wave = interner.intern("internerRoundTripWave");
+    CHECK_EQ(interner.intern(string("internerRoundTripWave")), wave);
+    CHECK(interner.intern("internerRoundTripWave2") != wave);
+    CHECK_EQ(interner.name(wave), "internerRoundTripWave");
+
+    // Enough names to fill several segments of every shard
+    vector<Symbol> symbols;
+    for (int i = 0; i < 20000; i++) symbols.push_back(interner.intern("roundTrip" + to_string(i)));
+    for (int i = 0; i < 20000; i++) {
+        if (interner.name(symbols[i]) != "roundTrip" + to_string(i)) {
+            CHECK_EQ(interner.name(symbols[i]), "roundTrip" + to_string(i));
+            break;
+        }
+    }
+}
+
+TEST_CASE(tokensOwnNoText) {
+    CHECK_EQ(sizeof(Token), (size_t)16);
+
+    Scanner scanner("troop wave = 12; brief \"x\";");
+    vector<Token> tokens = scanner.scanTokens();
+    CHECK_EQ(tokens[0].symbol, NO_SYMBOL);                              // troop
+    CHECK_EQ(tokens[1].symbol, Interner::global().intern("wave"));
+    CHECK_EQ(tokens[3].text(), "12");
+    CHECK_EQ(tokens[6].text(), "\"x\"");
+}
+
+// =============================================================================
+// 2. CONCURRENCY
+// =============================================================================
+
+// Threads intern overlapping names while reading back the ones they got
+TEST_CASE(internerConcurrentUse) {
+    const int threadCount = 8;
+    const int names = 5000;
+    vector<vector<Symbol>> seen(threadCount);
+    vector<int> mismatches(threadCount, 0);
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < names; i++) {
+                string text = "concurrent" + to_string((i * 7 + t) % names);
+                Symbol symbol = Interner::global().intern(text);
+                if (Interner::global().name(symbol) != text) mismatches[t]++;
+                seen[t].push_back(symbol);
+            }
+        });
+    }
+    for (thread& worker : threads) worker.join();
+
+    for (int t = 0; t < threadCount; t++) {
+        CHECK_EQ(mismatches[t], 0);
+        for (int i = 0; i < names; i++) {
+            string text = "concurrent" + to_string((i * 7 + t) % names);
+            if (seen[t][i] != Interner::global().intern(text)) {
+                CHECK_EQ(seen[t][i], Interner::global().intern(text));
+                break;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// 3. PROGRAM INTERNERS
+// =============================================================================
+
+TEST_CASE(internerScopesNest) {
+    Interner outer, inner;
+    CHECK(&Interner::current() == &Interner::global());
+    {
+        InternerScope first(&outer);
+        CHECK(&Interner::current() == &outer);
+        {
+            InternerScope second(&inner);
+            CHECK(&Interner::current() == &inner);
+            InternerScope none(nullptr);
+            CHECK(&Interner::current() == &inner);
+        }
+        CHECK(&Interner::current() == &outer);
+
+        // Each thread starts from global()
+        const Interner* seen = nullptr;
+        thread([&] { seen = &Interner::current(); }).join();
+        CHECK(seen == &Interner::global());
+    }
+    CHECK(&Interner::current() == &Interner::global());
+}
+
+// A compiled or loaded program interns nothing into global(), reads its
+// names back from its own interner, and frees that with its last handle
+TEST_CASE(internerPerProgram) {
+    const char* source = "troop perProgramGlobal = 3;\n"
+                         "tactic perProgramTactic(troop perProgramParam) { brief \"perProgram literal\"; }\n"
+                         "tactic campaign() { perProgramTactic(perProgramGlobal); }\n";
+    SourceOptions options;
+    options.linkOptions.inlineCalls = false;
+    size_t globalNames = Interner::global().size();
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return;
+    CHECK_EQ(Interner::global().size(), globalNames);
+
+    weak_ptr<Interner> names = program->getProgram().names;
+    CHECK(!names.expired());
+    CHECK(names.lock()->size() >= 4);
+
+    ostringstream tree, ir;
+    dumpProgram(program->getProgram(), tree);
+    dumpIr(buildIr(program->getProgram()), ir);
+    CHECK(tree.str().find("perProgramTactic") != string::npos);
+    CHECK(tree.str().find("perProgramParam") != string::npos);
+    CHECK(ir.str().find("tactic perProgramTactic") != string::npos);
+
+    const char* imagePath = "internertest.tlimg";
+    writeImage(program->getProgram(), imagePath);
+    ProgramHandle loaded = loadProgram(imagePath, errors);
+    remove(imagePath);
+    CHECK_EQ(errors, "");
+    if (!loaded) return;
+    CHECK_EQ(Interner::global().size(), globalNames);
+    CHECK(loaded->getProgram().names != program->getProgram().names);
+    ostringstream loadedTree;
+    dumpProgram(loaded->getProgram(), loadedTree);
+    CHECK_EQ(loadedTree.str(), tree.str());
+
+    // A context holds the program, and so its names, while it lives
+    {
+        ExecutionContext context(program);
+        program.reset();
+        CHECK(!names.expired());
+        string output;
+        context.setBriefHandler([&](const string& text) { output += text; });
+        context.run();
+        CHECK_EQ(output, "perProgram literal");
+    }
+    CHECK(names.expired());
+}
@@ -0,0 +1,168 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include "ir.h"
+#include <cstring>
+
+// Runs each program under Tests/ir both ways, through the Interpreter as
+// --run does and from the optimized IR as --run-ir does, and expects the
+// same output and the same runtime error, if any. The corpus leans on the
+// passes that rewrite loops: licm and the IR_ROTATE strength reduction.
+
+// =============================================================================
+// 1. RUNNING BOTH WAYS
+// =============================================================================
+
+class CaptureIO : public RunIO {
+public:
+    string output;
+
+    void brief(const string& text) override { output += text + "\n"; }
+    bool intel(string&) override { return false; }
+};
+
+static ProgramHandle compileTestFile(const string& name) {
+    SourceOptions options;
+    options.name = testFile(name);
+    string errors;
+    ProgramHandle program = compileProgram(readFile(options.name), options, errors);
+    CHECK_EQ(errors, "");
+    return program;
+}
+
+// The output of the run followed by its runtime error, if it has one
+static string runAst(ProgramHandle program) {
+    string output;
+    ExecutionContext context(program);
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += e.what() + string("\n");
+    }
+    return output;
+}
+
+static string runOptimizedIr(ProgramHandle program) {
+    IrModule module = buildIr(program->getProgram());
+    optimizeIr(module);
+    CaptureIO io;
+    try {
+        runIr(module, RunOptions(), io);
+    } catch (RuntimeError& e) {
+        io.output += e.what() + string("\n");
+    }
+    return io.output;
+}
+
+static string optimizedDump(ProgramHandle program) {
+    IrModule module = buildIr(program->getProgram());
+    optimizeIr(module);
+    ostringstream out;
+    dumpIr(module, out);
+    return out.str();
+}
+
+// The dump of one tactic, up to the next one
+static string tacticDump(const string& dump, const string& name) {
+    size_t start = dump.find("tactic " + name + " ");
+    if (start == string::npos) return "";
+    size_t end = dump.find("\ntactic ", start);
+    return dump.substr(start, end == string::npos ? string::npos : end - start);
+}
+
+// The entry block of a tactic's dump, where hoisted instructions land
+static string entryBlock(const string& tactic) {
+    return tactic.substr(0, tactic.find("  b1:"));
+}
+
+static int countOf(const string& text, const string& part) {
+    int count = 0;
+    for (size_t at = text.find(part); at != string::npos; at = text.find(part, at + 1)) count++;
+    return count;
+}
+
+static void checkBothWays(const string& name) {
+    ProgramHandle program = compileTestFile(name);
+    if (!program) return;
+    string expected = runAst(program);
+    CHECK(!expected.empty());
+    CHECK_EQ(runOptimizedIr(program), expected);
+}
+
+// =============================================================================
+// 2. CORPUS
+// =============================================================================
+
+TEST_CASE(irBasics) {
+    checkBothWays("ir/basics.tac");
+}
+
+TEST_CASE(irRuntimeErrors) {
+    checkBothWays("ir/errors.tac");
+    ProgramHandle program = compileTestFile("ir/errors.tac");
+    if (program) CHECK(runAst(program).find("[Line 9] Runtime error: Division by zero.") != string::npos);
+}
+
+TEST_CASE(irLoopInvariantMotion) {
+    checkBothWays("ir/licm.tac");
+    ProgramHandle program = compileTestFile("ir/licm.tac");
+    if (!program) return;
+
+    // Both products are hoisted above the loop header; the guarded and
+    // never-run divisions stay inside their loops
+    string dump = optimizedDump(program);
+    string invariants = tacticDump(dump, "invariants");
+    CHECK_EQ(countOf(entryBlock(invariants), " = * "), 2);
+    CHECK_EQ(countOf(invariants, " = * "), 2);
+    CHECK_EQ(countOf(entryBlock(tacticDump(dump, "guarded")), " = / "), 0);
+    CHECK_EQ(countOf(entryBlock(tacticDump(dump, "neverRuns")), " = / "), 0);
+}
+
+TEST_CASE(irStrengthReduction) {
+    checkBothWays("ir/strength.tac");
+    ProgramHandle program = compileTestFile("ir/strength.tac");
+    if (!program) return;
+
+    string dump = optimizedDump(program);
+    CHECK_EQ(countOf(dump, " = rotate "), 6);
+    CHECK_EQ(countOf(tacticDump(dump, "everyThird"), " = rotate "), 1);
+    CHECK_EQ(countOf(tacticDump(dump, "offsets"), " = rotate "), 0);
+    CHECK_EQ(countOf(tacticDump(dump, "negative"), " = rotate "), 0);
+}
+
+// An ammo that does not fit in a troop is an error, never an undefined
+// cast; the conversion in 'neverRuns' must not be hoisted above its loop
+TEST_CASE(irConversionRange) {
+    checkBothWays("ir/convert.tac");
+    ProgramHandle program = compileTestFile("ir/convert.tac");
+    if (program) {
+        string output = runAst(program);
+        CHECK(output.find("0\n15\n") == 0);
+        CHECK(output.find("1500000000\n[Line 17] Runtime error: Ammo value 1.5e+10 does not fit in a troop.") != string::npos);
+        CHECK_EQ(countOf(entryBlock(tacticDump(optimizedDump(program), "neverRuns")), " = convert "), 0);
+    }
+
+    struct Case {
+        const char* body;
+        const char* output;
+    };
+    const Case cases[] = {
+        { "troop t = -2147483648.9; brief t; t = 2147483647.9; brief t;", "-2147483648\n2147483647\n" },
+        { "troop t = 2147483648.0;", "[Line 1] Runtime error: Ammo value 2.14748e+09 does not fit in a troop.\n" },
+        { "ammo z = 0.0; troop t = z / z;", "does not fit in a troop.\n" },
+        { "squad troop s = [1.5, -2.5]; brief s;", "[1, -2]\n" },
+        { "squad ammo a = [1.5, -3000000000.0]; squad troop s = a;",
+          "[Line 1] Runtime error: Ammo value -3e+09 does not fit in a troop.\n" },
+    };
+    for (const Case& c : cases) {
+        SourceOptions options;
+        string errors;
+        ProgramHandle each = compileProgram(string("tactic campaign() { ") + c.body + " }", options, errors);
+        CHECK_EQ(errors, "");
+        if (!each) continue;
+        string output = runAst(each);
+        CHECK_EQ(runOptimizedIr(each), output);
+        size_t at = output.size() - min(output.size(), strlen(c.output));
+        CHECK_EQ(output.substr(at), string(c.output));
+    }
+}
@@ -0,0 +1,130 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include "compiler.h"
+#include "astdump.h"
+#include <sstream>
+
+// Lazy compilation, as a run uses it, against the eager compilation of
+// --validate. Both must link to the same tree and run the same way; the
+// lazy one parses only the bodies reachable from 'campaign' and the
+// global initializers, across modules too.
+
+static const char* reportsSource =
+    "tactic banner(codename title) { brief \"== \" + title; }\n"
+    "tactic neverShown() {\n"
+    "    deploy (troop i = 0; i < 3; i = i + 1) { brief i; }\n"
+    "}\n";
+
+static const char* lazySource =
+    "#supply Reports\n"
+    "troop base = seed(4);\n"
+    "tactic seed(troop x) { retreat x * 10; }\n"
+    "tactic fib(troop n) {\n"
+    "    evaluate (n < 2) { retreat n; }\n"
+    "    retreat fib(n - 1) + fib(n - 2);\n"
+    "}\n"
+    "tactic orphan(troop n) {\n"
+    "    retreat lonely(n) + 1;\n"
+    "}\n"
+    "tactic lonely(troop n) { retreat n * n; }\n"
+    "tactic campaign() {\n"
+    "    banner(\"lazy\");\n"
+    "    brief base + fib(15);\n"
+    "}\n";
+
+static bool findReports(const string& name, const string&, string& path, string& source) {
+    path = name + ".tac";
+    source = reportsSource;
+    return name == "Reports";
+}
+
+// Scans, parses, supplies and resolves 'source'; null after an error,
+// with the errors and progress notes in 'messages'
+static unique_ptr<Compilation> front(const string& source, bool lazy, ostringstream& messages) {
+    unique_ptr<Compilation> compilation(new Compilation("main.tac", lazy, messages, messages, findReports));
+    bool ok = compilation->scan(source) && compilation->parse() && compilation->supply() && compilation->resolve();
+    return ok ? move(compilation) : nullptr;
+}
+
+// The dump of the linked program, then the output of running it
+static string dumpAndRun(const string& source, bool lazy) {
+    ostringstream messages;
+    unique_ptr<Compilation> compilation = front(source, lazy, messages);
+    CHECK(compilation != nullptr);
+    if (!compilation) return messages.str();
+    compilation->link(LinkOptions());
+
+    ostringstream out;
+    dumpProgram(compilation->program, out);
+    ExecutionContext context(make_shared<const CompiledProgram>(move(compilation->program)));
+    context.setBriefHandler([&](const string& text) { out << text << "\n"; });
+    Value result = context.run();
+    out << "retreat " << result.troop << "\n";
+    return out.str();
+}
+
+static bool contains(const string& text, const string& part) {
+    return text.find(part) != string::npos;
+}
+
+// =============================================================================
+// 1. SAME PROGRAM
+// =============================================================================
+
+TEST_CASE(lazyMatchesEager) {
+    string eager = dumpAndRun(lazySource, false);
+    CHECK_EQ(dumpAndRun(lazySource, true), eager);
+    CHECK(contains(eager, "== lazy\n650\nretreat 0\n"));
+}
+
+// =============================================================================
+// 2. UNREACHED BODIES
+// =============================================================================
+
+// Before the link drops them, the bodies nothing reaches are still tokens
+TEST_CASE(lazyLeavesUnreachedBodiesUnparsed) {
+    ostringstream messages;
+    unique_ptr<Compilation> compilation = front(lazySource, true, messages);
+    CHECK(compilation != nullptr);
+    if (!compilation) return;
+
+    string unparsed;
+    for (const Function& function : compilation->program.functions) {
+        if (!function.body) unparsed += Interner::global().name(function.name) + " ";
+    }
+    CHECK_EQ(unparsed, "neverShown orphan lonely ");
+    CHECK(contains(messages.str(), "Parsed 4 of 7 tactic bodies (reachable from campaign)."));
+
+    ostringstream eagerMessages;
+    unique_ptr<Compilation> eager = front(lazySource, false, eagerMessages);
+    CHECK(eager != nullptr);
+    if (!eager) return;
+    for (const Function& function : eager->program.functions) CHECK(function.body != nullptr);
+}
+
+// A syntax error in a body nothing calls: the lazy compile never parses it
+// and runs, the eager one reports it. Unmatched braces, and errors in
+// bodies that are reached, fail both.
+TEST_CASE(lazySyntaxErrorInUnreachedBody) {
+    string broken = lazySource;
+    broken.replace(broken.find("retreat lonely(n) + 1;"), 22, "retreat lonely(n) + ;");
+
+    CHECK_EQ(dumpAndRun(broken, true), dumpAndRun(lazySource, true));
+    ostringstream messages;
+    CHECK(front(broken, false, messages) == nullptr);
+    CHECK(contains(messages.str(), "[Line 9, Col 25] Error at ';': Expected expression"));
+
+    string unmatched = lazySource;
+    unmatched.replace(unmatched.find("retreat lonely(n) + 1;"), 22, "{ retreat lonely(n) + 1;");
+    ostringstream lazyUnmatched, eagerUnmatched;
+    CHECK(front(unmatched, true, lazyUnmatched) == nullptr);
+    CHECK(front(unmatched, false, eagerUnmatched) == nullptr);
+
+    string reached = lazySource;
+    reached.replace(reached.find("retreat n;"), 10, "retreat n +;");
+    ostringstream lazyReached, eagerReached;
+    CHECK(front(reached, true, lazyReached) == nullptr);
+    CHECK(front(reached, false, eagerReached) == nullptr);
+    CHECK(contains(lazyReached.str(), "[Line 5, Col 35] Error at ';': Expected expression"));
+    CHECK(contains(eagerReached.str(), "[Line 5, Col 35] Error at ';': Expected expression"));
+}
@@ -0,0 +1,110 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include "compiler.h"
+#include <sstream>
+
+// The linker over a main file and a module that a ModuleFinder hands over.
+// Inlining across files must not change what a program does, nor the line
+// a runtime error names: the callee's line, in the module.
+
+static const char* helpersSource =
+    "troop calls = 0;\n"
+    "tactic square(troop x) { retreat x * x; }\n"
+    "tactic report(codename label, troop value) { brief label + \": \" + value; }\n"
+    "tactic half(troop x) {\n"
+    "    retreat 100 / x;\n"
+    "}\n"
+    "tactic factorial(troop n) {\n"
+    "    calls = calls + 1;\n"
+    "    evaluate (n < 2) { retreat 1; }\n"
+    "    retreat n * factorial(n - 1);\n"
+    "}\n"
+    "tactic unused() { retreat 0; }\n";
+
+static const char* mainSource =
+    "#supply Helpers\n"
+    "tactic twice(troop x) { retreat square(x) + square(x); }\n"
+    "tactic campaign() {\n"
+    "    report(\"square\", square(7));\n"
+    "    report(\"twice\", twice(3));\n"
+    "    report(\"factorial\", factorial(6));\n"
+    "    report(\"calls\", calls);\n"
+    "    troop zero = 0;\n"
+    "    brief half(zero);\n"
+    "}\n";
+
+static bool findHelpers(const string& name, const string&, string& path, string& source) {
+    path = name + ".tac";
+    source = helpersSource;
+    return name == "Helpers";
+}
+
+// Compiles the two files as the command line does; the link's counts
+static LinkStats linkBoth(bool inlineCalls, size_t* fileCount = nullptr) {
+    ostringstream errors, log;
+    Compilation compilation("main.tac", false, errors, log, findHelpers);
+    bool ok = compilation.scan(mainSource) && compilation.parse() && compilation.supply() && compilation.resolve();
+    CHECK(ok);
+    CHECK_EQ(errors.str(), "");
+    if (fileCount) *fileCount = compilation.getFileCount();
+    LinkOptions options;
+    options.inlineCalls = inlineCalls;
+    return ok ? compilation.link(options) : LinkStats();
+}
+
+// The brief lines of a run, then its runtime error
+static string runBoth(bool inlineCalls) {
+    SourceOptions options;
+    options.findModule = findHelpers;
+    options.linkOptions.inlineCalls = inlineCalls;
+    string errors;
+    ProgramHandle program = compileProgram(mainSource, options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return errors;
+    ExecutionContext context(program);
+    string output;
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += string(e.what()) + "\n";
+    }
+    return output;
+}
+
+// =============================================================================
+// 1. LINK STATISTICS
+// =============================================================================
+
+// Seven tactics over the two files. Inlined, only 'campaign' and the
+// recursive 'factorial' remain; without inlining, all but 'unused'.
+// 'square' is inlined twice into 'twice', which is then inlined with it.
+TEST_CASE(linkSecondModuleStats) {
+    size_t files = 0;
+    LinkStats inlined = linkBoth(true, &files);
+    CHECK_EQ(files, (size_t)2);
+    CHECK_EQ(inlined.tacticsBefore, (size_t)7);
+    CHECK_EQ(inlined.tacticsKept, (size_t)2);
+    CHECK_EQ(inlined.inlinedCalls, 9);
+
+    LinkStats plain = linkBoth(false);
+    CHECK_EQ(plain.tacticsBefore, (size_t)7);
+    CHECK_EQ(plain.tacticsKept, (size_t)6);
+    CHECK_EQ(plain.inlinedCalls, 0);
+}
+
+// =============================================================================
+// 2. RUNS
+// =============================================================================
+
+// The same output either way, and the division by zero in 'half' reported
+// at its line in Helpers.tac, which names no file
+TEST_CASE(linkInliningKeepsOutputAndLines) {
+    const string expected = "square: 49\n"
+                            "twice: 18\n"
+                            "factorial: 720\n"
+                            "calls: 6\n"
+                            "[Line 5] Runtime error: Division by zero.\n";
+    CHECK_EQ(runBoth(true), expected);
+    CHECK_EQ(runBoth(false), expected);
+}
@@ -0,0 +1,223 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include <cstring>
+
+// 'deploy parallel' splits its iterations by the trip count alone, never
+// by the number of workers. Troop and codename reductions must match the
+// plain sequential loop; ammo ones must at least be the same bits for
+// every worker count. A step budget must run out at the same statement
+// however many workers share it.
+
+static const int workerCounts[] = { 1, 2, 3, 8 };
+
+static ProgramHandle compileSource(const string& source) {
+    SourceOptions options;
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    return program;
+}
+
+// Every 'brief' line of one run, with the given number of workers
+static vector<string> briefs(ProgramHandle program, int workers, Value* result = nullptr) {
+    RunOptions options;
+    options.workers = workers;
+    ExecutionContext context(program, options);
+    vector<string> lines;
+    context.setBriefHandler([&](const string& text) { lines.push_back(text); });
+    Value value = context.run();
+    if (result) *result = value;
+    return lines;
+}
+
+// A loop with one reduction of each kind, as 'deploy' or 'deploy parallel'.
+// The product's factors are odd, so wrapping never takes it to 0.
+static string reductions(const string& name, const string& deploy) {
+    return "tactic " + name + "(troop n) {\n"
+           "    troop sum = 0; troop product = 1; status all = true; status any = false; codename text = \"\";\n"
+           "    " + deploy + " (troop i = 0; i < n; i = i + 1) {\n"
+           "        sum = sum + i * i * 7919;\n"
+           "        product = product * (i % 7 * 2 + 1);\n"
+           "        all = all && i < n - 1;\n"
+           "        any = any || i == 500;\n"
+           "        text = text + (\"\" + i % 10);\n"
+           "    }\n"
+           "    brief sum; brief product; brief all; brief any; brief text;\n"
+           "}\n";
+}
+
+// =============================================================================
+// 1. EXACT REDUCTIONS
+// =============================================================================
+
+TEST_CASE(parallelTroopReductionsMatchSequential) {
+    ProgramHandle program = compileSource(reductions("sequential", "deploy") + reductions("split", "deploy parallel") +
+                                          "tactic campaign() {\n"
+                                          "    sequential(1000); split(1000);\n"
+                                          "    sequential(37); split(37);\n"
+                                          "}\n");
+    if (!program) return;
+
+    for (int workers : workerCounts) {
+        vector<string> lines = briefs(program, workers);
+        CHECK_EQ(lines.size(), (size_t)20);
+        if (lines.size() != 20) continue;
+        for (size_t i = 0; i < 5; i++) {
+            CHECK_EQ(lines[5 + i], lines[i]);
+            CHECK_EQ(lines[15 + i], lines[10 + i]);
+        }
+    }
+}
+
+// An operand of another type converts back to the accumulator's type on
+// every step. Chunked, that gives a different answer from the sequential
+// loop even with one worker, so the Resolver refuses it.
+TEST_CASE(parallelReductionTypesMustMatch) {
+    struct Case {
+        const char* declaration;
+        const char* body;
+        const char* error;
+    };
+    const Case cases[] = {
+        { "troop x = -1;", "x = x + 0.5;", "Reduction \'x\' has type troop but combines a value of type ammo" },
+        { "troop x = 1;", "x = x * 1.5;", "Reduction \'x\' has type troop but combines a value of type ammo" },
+        { "troop x = 0;", "x = x + i + 0.5;", "Reduction \'x\' has type troop but combines a value of type ammo" },
+        { "ammo x = 0.0;", "x = i + x;", "Reduction \'x\' has type ammo but combines a value of type troop" },
+        { "status x = true;", "x = x && i;", "Reduction \'x\' has type status but combines a value of type troop" },
+        { "codename x = \"\";", "x = x + i;", "Reduction \'x\' has type codename but combines a value of type troop" },
+        { "troop x = 0;", "x = x + half(i);", "is only known at run time; assign it to a troop variable first" },
+    };
+    for (const Case& c : cases) {
+        string source = string("tactic half(troop n) { retreat n / 2; }\n"
+                               "tactic campaign() {\n    ") + c.declaration +
+                        "\n    deploy parallel (troop i = 0; i < 100; i = i + 1) { " + c.body + " }\n"
+                        "    brief x;\n}\n";
+        SourceOptions options;
+        string errors;
+        ProgramHandle program = compileProgram(source, options, errors);
+        CHECK(program == nullptr);
+        if (errors.find(c.error) == string::npos) CHECK_EQ(errors, c.error);
+    }
+
+    // The same types on both sides, through locals, squads and built-ins
+    ProgramHandle program = compileSource("troop scale = 3;\n"
+                                          "tactic campaign() {\n"
+                                          "    troop x = 0; ammo y = 0.0; status z = false;\n"
+                                          "    deploy parallel (troop i = 0; i < 100; i = i + 1) {\n"
+                                          "        ammo half = i / 2.0;\n"
+                                          "        squad troop s = [i, 2 * i];\n"
+                                          "        x = x + -i * scale + s[1] + sum(s) + size(s);\n"
+                                          "        y = y + half * 1.5;\n"
+                                          "        z = z || half > 40.0 || !(i < 100);\n"
+                                          "    }\n"
+                                          "    brief x; brief y; brief z;\n"
+                                          "}\n");
+    if (program) CHECK_EQ(briefs(program, 1).size(), (size_t)3);
+}
+
+// =============================================================================
+// 2. AMMO REDUCTIONS
+// =============================================================================
+
+// Large and small terms so that the order of the additions shows in the
+// result; it must be the same order whatever the worker count
+TEST_CASE(parallelAmmoReductionsReproducible) {
+    ProgramHandle program = compileSource("tactic campaign() {\n"
+                                          "    ammo total = 0.0;\n"
+                                          "    deploy parallel (troop i = 0; i < 5000; i = i + 1) {\n"
+                                          "        total = total + 1.0 / (i + 1) + 100000000.0;\n"
+                                          "    }\n"
+                                          "    retreat total;\n"
+                                          "}\n");
+    if (!program) return;
+
+    Value first;
+    briefs(program, 1, &first);
+    CHECK(first.type == VAL_AMMO);
+    for (int workers : workerCounts) {
+        Value result;
+        briefs(program, workers, &result);
+        CHECK(result.type == VAL_AMMO);
+        CHECK(memcmp(&result.ammo, &first.ammo, sizeof(double)) == 0);
+    }
+}
+
+// =============================================================================
+// 3. STEP BUDGETS
+// =============================================================================
+
+// Iterations of uneven cost, so a budget runs out part way through a chunk
+static const char* budgetSource =
+    "tactic work(troop n) {\n"
+    "    troop s = 0;\n"
+    "    deploy (troop k = 0; k < n; k = k + 1) { s = s + k; }\n"
+    "    retreat s;\n"
+    "}\n"
+    "tactic campaign() {\n"
+    "    troop total = 0;\n"
+    "    deploy parallel (troop i = 0; i < 300; i = i + 1) {\n"
+    "        troop w = work(i % 17);\n"
+    "        total = total + w;\n"
+    "        evaluate (i % 50 == 0) { brief i; }\n"
+    "    }\n"
+    "    brief total;\n"
+    "}\n";
+
+struct BudgetRun {
+    string output;    // 'brief' lines, then the error if the run failed
+    long long stepsUsed;
+};
+
+static BudgetRun runWithBudget(ProgramHandle program, int workers, long long maxSteps) {
+    RunOptions options;
+    options.workers = workers;
+    options.maxSteps = maxSteps;
+    ExecutionContext context(program, options);
+    BudgetRun run;
+    context.setBriefHandler([&](const string& text) { run.output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        run.output += string(e.what()) + "\n";
+    }
+    run.stepsUsed = context.getStepsUsed();
+    return run;
+}
+
+TEST_CASE(parallelStepLimitMatchesOneWorker) {
+    ProgramHandle program = compileSource(budgetSource);
+    if (!program) return;
+
+    long long needed = runWithBudget(program, 1, 0).stepsUsed;
+    const long long budgets[] = { 1, 50, needed / 3, needed - 1, needed };
+    for (long long budget : budgets) {
+        BudgetRun expected = runWithBudget(program, 1, budget);
+        CHECK_EQ(expected.output.find("Step limit exceeded") != string::npos, budget < needed);
+        for (int workers : workerCounts) {
+            BudgetRun actual = runWithBudget(program, workers, budget);
+            CHECK_EQ(actual.output, expected.output);
+            CHECK_EQ(actual.stepsUsed, expected.stepsUsed);
+        }
+    }
+    CHECK_EQ(runWithBudget(program, 8, needed).stepsUsed, needed);
+}
+
+// A runtime error in one chunk with budget to spare: the chunks before it
+// are charged in full, and none after it
+TEST_CASE(parallelErrorChargesChunksBeforeIt) {
+    ProgramHandle program = compileSource("tactic campaign() {\n"
+                                          "    troop total = 0;\n"
+                                          "    deploy parallel (troop i = 0; i < 640; i = i + 1) {\n"
+                                          "        total = total + 100 / (400 - i);\n"
+                                          "    }\n"
+                                          "}\n");
+    if (!program) return;
+
+    BudgetRun expected = runWithBudget(program, 1, 1000000);
+    CHECK_EQ(expected.output, "[Line 4] Runtime error: Division by zero.\n");
+    for (int workers : workerCounts) {
+        BudgetRun actual = runWithBudget(program, workers, 1000000);
+        CHECK_EQ(actual.output, expected.output);
+        CHECK_EQ(actual.stepsUsed, expected.stepsUsed);
+    }
+}
@@ -0,0 +1,50 @@
+#include "testing.h"
+#include "tacticlang.h"
+
+// Literals and other syntax the Parser turns into values or errors itself
+
+// The first diagnostic; recovery may report more after it
+static string firstError(const string& source) {
+    SourceOptions options;
+    string errors;
+    compileProgram(source, options, errors);
+    return errors.substr(0, errors.find('\n'));
+}
+
+static Value campaignResult(const string& source) {
+    SourceOptions options;
+    string errors;
+    ProgramHandle program = compileProgram(source, options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return Value();
+    ExecutionContext context(program);
+    return context.run();
+}
+
+// =============================================================================
+// 1. NUMERIC LITERALS
+// =============================================================================
+
+TEST_CASE(parserDecimalLiteralRange) {
+    // Past DBL_MAX, and below the smallest subnormal: errors at the token
+    string huge = "1" + string(400, '0') + ".5";
+    CHECK_EQ(firstError("tactic campaign() { ammo a = " + huge + "; }"),
+             "[Line 1, Col 29] Error at '" + huge + "': Decimal literal is too large for ammo.");
+    string tiny = "0." + string(400, '0') + "1";
+    CHECK_EQ(firstError("tactic campaign() {\n    brief " + tiny + ";\n}"),
+             "[Line 2, Col 11] Error at '" + tiny + "': Decimal literal is too small for ammo; it would be 0.");
+
+    // A subnormal is a value, not an error
+    Value subnormal = campaignResult("tactic campaign() { retreat 0." + string(309, '0') + "1; }");
+    CHECK(subnormal.type == VAL_AMMO);
+    CHECK(subnormal.ammo > 0.0 && subnormal.ammo < 1e-308);
+    CHECK_EQ(campaignResult("tactic campaign() { retreat 2.5; }").ammo, 2.5);
+}
+
+TEST_CASE(parserIntegerLiteralRange) {
+    CHECK_EQ(campaignResult("tactic campaign() { retreat 2147483647; }").troop, 2147483647);
+    CHECK_EQ(firstError("tactic campaign() { retreat 2147483648; }"),
+             "[Line 1, Col 28] Error at '2147483648': Integer literal is too large for troop.");
+    CHECK_EQ(firstError("tactic campaign() { retreat 99999999999999999999999; }"),
+             "[Line 1, Col 28] Error at '99999999999999999999999': Integer literal is too large for troop.");
+}
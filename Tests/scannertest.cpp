@@ -0,0 +1,134 @@
+#include "testing.h"
+#include "scanner.h"
+#include "compiler.h"
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+
+// Pins the token stream of the table-driven scanner on the edge cases the
+// hand-written scanner it replaced handled one by one. A change to the token
+// spec in scanner.cpp or to lexgen.cpp that shifts any of these shows up here.
+
+// "TYPE(text)" for every token, space separated, EOF included
+static string describe(const string& source) {
+    Scanner scanner(source);
+    string result;
+    for (const Token& token : scanner.scanTokens()) {
+        if (!result.empty()) result += " ";
+        result += Scanner::tokenTypeToString(token.type) + "(" + token.text() + ")";
+    }
+    return result;
+}
+
+// "TYPE@line:column" for every token
+static string positions(const string& source) {
+    Scanner scanner(source);
+    string result;
+    for (const Token& token : scanner.scanTokens()) {
+        if (!result.empty()) result += " ";
+        result += Scanner::tokenTypeToString(token.type) + "@" + to_string(token.line) + ":" + to_string(token.column);
+    }
+    return result;
+}
+
+// =============================================================================
+// 1. KEYWORDS AND IDENTIFIERS
+// =============================================================================
+
+TEST_CASE(scannerKeywordPrefixes) {
+    CHECK_EQ(describe("troops troop troop_ trooper _troop campaigner tactic tacticx"),
+             "IDENTIFIER(troops) TROOP(troop) IDENTIFIER(troop_) IDENTIFIER(trooper) IDENTIFIER(_troop) "
+             "IDENTIFIER(campaigner) TACTIC(tactic) IDENTIFIER(tacticx) EOF()");
+    CHECK_EQ(describe("ammo1 statusquo true truex false_ brief"),
+             "IDENTIFIER(ammo1) IDENTIFIER(statusquo) TRUE(true) IDENTIFIER(truex) IDENTIFIER(false_) BRIEF(brief) EOF()");
+    CHECK_EQ(describe("squad squads parallel parallelx deploy deployed"),
+             "SQUAD(squad) IDENTIFIER(squads) PARALLEL(parallel) IDENTIFIER(parallelx) DEPLOY(deploy) "
+             "IDENTIFIER(deployed) EOF()");
+}
+
+// =============================================================================
+// 2. LITERALS
+// =============================================================================
+
+TEST_CASE(scannerNumericLiterals) {
+    // No leading or trailing '.', no exponent; a second '.' starts over
+    CHECK_EQ(describe("0 007 42 3.14 1. .5 1.2.3 12abc 2147483648"),
+             "INTEGER(0) INTEGER(007) INTEGER(42) DOUBLE(3.14) INTEGER(1) ERROR(Unexpected character: .) "
+             "ERROR(Unexpected character: .) INTEGER(5) DOUBLE(1.2) ERROR(Unexpected character: .) INTEGER(3) "
+             "INTEGER(12) IDENTIFIER(abc) INTEGER(2147483648) EOF()");
+}
+
+TEST_CASE(scannerStrings) {
+    CHECK_EQ(describe("\"hello\" \"\" \"two\nlines\" x"),
+             "STRING(\"hello\") STRING(\"\") STRING(\"two\nlines\") IDENTIFIER(x) EOF()");
+
+    // An unterminated string swallows the rest of the file
+    CHECK_EQ(describe("\"unterminated\n  troop x;"), "ERROR(Unterminated string) EOF()");
+    CHECK_EQ(positions("\"unterminated\n  troop x;"), "ERROR@2:11 EOF@2:11");
+
+    // Equal text interns to the equal symbol, with or without the quotes
+    Scanner scanner("\"wave\" wave \"wave\"");
+    vector<Token> tokens = scanner.scanTokens();
+    CHECK_EQ(tokens[0].symbol, tokens[1].symbol);
+    CHECK_EQ(tokens[0].symbol, tokens[2].symbol);
+}
+
+// =============================================================================
+// 3. OPERATORS, DIRECTIVES AND COMMENTS
+// =============================================================================
+
+TEST_CASE(scannerOperators) {
+    CHECK_EQ(describe("== = != ! <= < >= > && || & | + - * / % ==="),
+             "EQUAL(==) ASSIGN(=) NOT_EQUAL(!=) NOT(!) LESS_EQUAL(<=) LESS(<) GREATER_EQUAL(>=) GREATER(>) "
+             "AND(&&) OR(||) ERROR(Unexpected character: &) ERROR(Unexpected character: |) PLUS(+) MINUS(-) "
+             "MULTIPLY(*) DIVIDE(/) MODULO(%) EQUAL(==) ASSIGN(=) EOF()");
+    CHECK_EQ(describe("([{}]);,"),
+             "LPAREN(() LBRACKET([) LBRACE({) RBRACE(}) RBRACKET(]) RPAREN()) SEMICOLON(;) COMMA(,) EOF()");
+}
+
+TEST_CASE(scannerDirectivesAndComments) {
+    // '#' and a letter is a directive; anything else after '#' is a comment
+    CHECK_EQ(describe("#supply Base\n#Check for x\n# comment\n#\ntroop #supplyx #sup #9 y"),
+             "SUPPLY(#supply) IDENTIFIER(Base) ERROR(Unknown directive: #Check) IDENTIFIER(for) IDENTIFIER(x) "
+             "TROOP(troop) ERROR(Unknown directive: #supplyx) ERROR(Unknown directive: #sup) EOF()");
+    CHECK_EQ(describe("@ $ ~ troop` z"),
+             "ERROR(Unexpected character: @) ERROR(Unexpected character: $) ERROR(Unexpected character: ~) "
+             "TROOP(troop) ERROR(Unexpected character: `) IDENTIFIER(z) EOF()");
+}
+
+// =============================================================================
+// 4. POSITIONS
+// =============================================================================
+
+TEST_CASE(scannerLinesAndColumns) {
+    CHECK_EQ(positions("troop x = 1;\n  ammo y = 2.5;\r\n\tbrief y;"),
+             "TROOP@1:0 IDENTIFIER@1:6 ASSIGN@1:8 INTEGER@1:10 SEMICOLON@1:11 AMMO@2:3 IDENTIFIER@2:8 "
+             "ASSIGN@2:10 DOUBLE@2:12 SEMICOLON@2:15 BRIEF@3:2 IDENTIFIER@3:8 SEMICOLON@3:9 EOF@3:10");
+}
+
+// =============================================================================
+// 5. GENERATED TABLES
+// =============================================================================
+
+// scantables.cpp is checked in; it must be what lexgen makes of the spec
+// today. If this fails, regenerate it with --emit-lexer.
+TEST_CASE(scannerTablesMatchSpec) {
+    LexTables expected = buildLexTables(Scanner::tokenSpec());
+    const StaticLexTables& actual = scannerTables;
+    CHECK_EQ(actual.numClasses, expected.numClasses);
+    CHECK_EQ(actual.numStates, expected.numStates);
+    CHECK_EQ(actual.startState, expected.startState);
+    if (actual.numClasses != expected.numClasses || actual.numStates != expected.numStates) return;
+
+    CHECK(memcmp(actual.byteClass, expected.byteClass, 256) == 0);
+    CHECK(memcmp(actual.next, expected.next.data(), expected.next.size() * sizeof(unsigned short)) == 0);
+    CHECK(memcmp(actual.accept, expected.accept.data(), expected.accept.size() * sizeof(int)) == 0);
+
+    // And the writer reproduces the file, whatever line endings the
+    // checkout gave it
+    ostringstream written;
+    writeLexTables(expected, "scannerTables", "Scanner::tokenSpec() in scanner.cpp", written);
+    string file = readFile(testFile("../Project1/scantables.cpp"));
+    file.erase(remove(file.begin(), file.end(), '\r'), file.end());
+    CHECK(written.str() == file);
+}
@@ -0,0 +1,360 @@
+#include "testing.h"
+#include "tacticlang.h"
+#include "squad.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+// Squads through the language and through squad.h directly. The packed
+// SSE2 kernels must give the same bits as the scalar loops other targets
+// run, at every length, including the lengths that leave a remainder
+// after the last full vector.
+
+static const double NaN = numeric_limits<double>::quiet_NaN();
+static const double INF = numeric_limits<double>::infinity();
+
+static Value troops(const vector<int>& elements) {
+    Value squad = Value::makeSquad(VAL_TROOP_SQUAD, elements.size());
+    for (size_t i = 0; i < elements.size(); i++) squad.ownSquad().troops[i] = elements[i];
+    return squad;
+}
+
+static Value ammo(const vector<double>& elements) {
+    Value squad = Value::makeSquad(VAL_AMMO_SQUAD, elements.size());
+    for (size_t i = 0; i < elements.size(); i++) squad.ownSquad().ammo[i] = elements[i];
+    return squad;
+}
+
+// The same bits, so -0.0 does not match 0.0, except that any NaN matches
+// any NaN: which one adding two NaNs gives depends on the order of the
+// operands, and the compiler may swap them in the scalar loops as well
+static bool sameAmmo(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || memcmp(&a, &b, sizeof a) == 0;
+}
+
+// Same type and the same elements by sameAmmo()
+static bool sameBits(const Value& a, const Value& b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case VAL_TROOP: return a.troop == b.troop;
+        case VAL_AMMO:  return sameAmmo(a.ammo, b.ammo);
+        case VAL_TROOP_SQUAD:
+            return a.squad().troops == b.squad().troops;
+        case VAL_AMMO_SQUAD:
+            if (a.squad().ammo.size() != b.squad().ammo.size()) return false;
+            for (size_t i = 0; i < a.squad().ammo.size(); i++) {
+                if (!sameAmmo(a.squad().ammo[i], b.squad().ammo[i])) return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The error of 'operation', or "" if it throws none
+template <class F>
+static string errorOf(F operation) {
+    try {
+        operation();
+    } catch (RuntimeError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+// The 'brief' lines of 'campaign', then its runtime error if any
+static string run(const string& body) {
+    SourceOptions options;
+    string errors;
+    ProgramHandle program = compileProgram("tactic campaign() {\n" + body + "\n}\n", options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return errors;
+    ExecutionContext context(program);
+    string output;
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    try {
+        context.run();
+    } catch (RuntimeError& e) {
+        output += string(e.what()) + "\n";
+    }
+    return output;
+}
+
+static Value builtin(Builtin which, const Value& squad) {
+    return callBuiltin(which, &squad, 1);
+}
+
+// =============================================================================
+// 1. INDEXING
+// =============================================================================
+
+TEST_CASE(squadIndexing) {
+    CHECK_EQ(run("squad troop s = [10, 20, 30];\n"
+                 "brief s[0]; brief s[2];\n"
+                 "s[1] = 2.9; brief s;\n"
+                 "squad ammo a = [1.5, 2];\n"
+                 "a[1] = 7; brief a; brief a[1] + 1;"),
+             "10\n30\n[10, 2, 30]\n[1.5, 7]\n8\n");
+
+    Value s = troops({ 10, 20, 30 });
+    CHECK_EQ(errorOf([&] { squadElement(s, Value::makeTroop(3), 4); }),
+             "[Line 4] Runtime error: Index 3 is out of range for a squad of 3.");
+    CHECK_EQ(errorOf([&] { squadElement(s, Value::makeTroop(-1), 4); }),
+             "[Line 4] Runtime error: Index -1 is out of range for a squad of 3.");
+    CHECK_EQ(errorOf([&] { squadElement(s, Value::makeAmmo(1.0), 4); }),
+             "[Line 4] Runtime error: A squad index must be a troop, not ammo.");
+    CHECK_EQ(errorOf([&] { squadElement(Value::makeTroop(1), Value::makeTroop(0), 4); }),
+             "[Line 4] Runtime error: Only a squad can be indexed, not troop.");
+    CHECK_EQ(errorOf([&] { squadStore(s, Value::makeTroop(3), Value::makeTroop(1), 4); }),
+             "[Line 4] Runtime error: Index 3 is out of range for a squad of 3.");
+    CHECK_EQ(errorOf([&] { squadStore(s, Value::makeTroop(0), Value::makeAmmo(1e10), 4); }),
+             "[Line 4] Runtime error: Ammo value 1e+10 does not fit in a troop.");
+    CHECK_EQ(errorOf([&] { squadElement(troops({}), Value::makeTroop(0), 4); }),
+             "[Line 4] Runtime error: Index 0 is out of range for a squad of 0.");
+
+    // Through the language, with the line of the statement
+    CHECK_EQ(run("squad troop s = range(4);\nbrief s[3];\nbrief s[4];"),
+             "3\n[Line 4] Runtime error: Index 4 is out of range for a squad of 4.\n");
+}
+
+// =============================================================================
+// 2. COPY ON WRITE
+// =============================================================================
+
+TEST_CASE(squadCopyOnWrite) {
+    // A store into a shared squad copies it first; the other holder keeps its elements
+    Value a = troops({ 1, 2, 3 });
+    Value b = a;
+    CHECK(&a.squad() == &b.squad());
+    squadStore(b, Value::makeTroop(0), Value::makeTroop(9), 1);
+    CHECK(&a.squad() != &b.squad());
+    CHECK(sameBits(a, troops({ 1, 2, 3 })));
+    CHECK(sameBits(b, troops({ 9, 2, 3 })));
+
+    // Unshared, it stores in place
+    const SquadObject* before = &b.squad();
+    squadStore(b, Value::makeTroop(2), Value::makeAmmo(-4.5), 1);
+    CHECK(&b.squad() == before);
+    CHECK(sameBits(b, troops({ 9, 2, -4 })));
+
+    CHECK_EQ(run("squad troop a = [1, 2, 3];\n"
+                 "squad troop b = a;\n"
+                 "b[0] = 9;\n"
+                 "brief a; brief b;"),
+             "[1, 2, 3]\n[9, 2, 3]\n");
+
+    // Nor does a tactic that changes its parameter change the caller's squad
+    SourceOptions options;
+    string errors;
+    ProgramHandle program = compileProgram("tactic zero(squad troop s) { s[0] = 0; retreat s; }\n"
+                                           "tactic campaign() {\n"
+                                           "    squad troop a = [5, 6];\n"
+                                           "    squad troop b = zero(a);\n"
+                                           "    brief a; brief b;\n"
+                                           "}\n",
+                                           options, errors);
+    CHECK_EQ(errors, "");
+    if (!program) return;
+    string output;
+    ExecutionContext context(program);
+    context.setBriefHandler([&](const string& text) { output += text + "\n"; });
+    context.run();
+    CHECK_EQ(output, "[5, 6]\n[0, 6]\n");
+}
+
+// =============================================================================
+// 3. BROADCAST ARITHMETIC AND MASKS
+// =============================================================================
+
+TEST_CASE(squadBroadcastAndMasks) {
+    Value s = troops({ 1, 2, 3, 4, 5 });
+    CHECK(sameBits(squadBinary(TOK_PLUS, s, Value::makeTroop(10), 1), troops({ 11, 12, 13, 14, 15 })));
+    CHECK(sameBits(squadBinary(TOK_MINUS, Value::makeTroop(10), s, 1), troops({ 9, 8, 7, 6, 5 })));
+    CHECK(sameBits(squadBinary(TOK_MULTIPLY, s, Value::makeAmmo(0.5), 1), ammo({ 0.5, 1.0, 1.5, 2.0, 2.5 })));
+    CHECK(sameBits(squadBinary(TOK_DIVIDE, s, Value::makeTroop(2), 1), troops({ 0, 1, 1, 2, 2 })));
+    CHECK(sameBits(squadBinary(TOK_MODULO, Value::makeTroop(7), s, 1), troops({ 0, 1, 1, 3, 2 })));
+    CHECK(sameBits(squadBinary(TOK_PLUS, s, s, 1), troops({ 2, 4, 6, 8, 10 })));
+    CHECK(sameBits(squadNegate(s, 1), troops({ -1, -2, -3, -4, -5 })));
+
+    // Troop arithmetic wraps, and INT_MIN / -1 is INT_MIN as for scalars
+    Value edges = troops({ INT_MAX, INT_MIN, INT_MIN });
+    CHECK(sameBits(squadBinary(TOK_PLUS, edges, Value::makeTroop(1), 1), troops({ INT_MIN, INT_MIN + 1, INT_MIN + 1 })));
+    CHECK(sameBits(squadBinary(TOK_DIVIDE, edges, Value::makeTroop(-1), 1), troops({ -INT_MAX, INT_MIN, INT_MIN })));
+    CHECK(sameBits(squadBinary(TOK_MODULO, edges, Value::makeTroop(-1), 1), troops({ 0, 0, 0 })));
+    CHECK(sameBits(squadNegate(edges, 1), troops({ -INT_MAX, INT_MIN, INT_MIN })));
+
+    // Masks are troop squads of 0s and 1s, whatever the element type
+    CHECK(sameBits(squadBinary(TOK_LESS, s, Value::makeTroop(3), 1), troops({ 1, 1, 0, 0, 0 })));
+    CHECK(sameBits(squadBinary(TOK_GREATER_EQUAL, s, Value::makeTroop(3), 1), troops({ 0, 0, 1, 1, 1 })));
+    CHECK(sameBits(squadBinary(TOK_EQUAL, s, troops({ 1, 0, 3, 0, 5 }), 1), troops({ 1, 0, 1, 0, 1 })));
+    CHECK(sameBits(squadBinary(TOK_NOT_EQUAL, s, troops({ 1, 0, 3, 0, 5 }), 1), troops({ 0, 1, 0, 1, 0 })));
+    Value a = ammo({ 1.0, NaN, -0.0, INF, 2.5 });
+    CHECK(sameBits(squadBinary(TOK_LESS_EQUAL, a, Value::makeAmmo(1.0), 1), troops({ 1, 0, 1, 0, 0 })));
+    CHECK(sameBits(squadBinary(TOK_EQUAL, a, Value::makeAmmo(0.0), 1), troops({ 0, 0, 1, 0, 0 })));
+    CHECK(sameBits(squadBinary(TOK_NOT_EQUAL, a, a, 1), troops({ 0, 1, 0, 0, 0 })));
+    CHECK(sameBits(squadBinary(TOK_GREATER, s, a, 1), troops({ 0, 0, 1, 0, 1 })));
+
+    // Errors name the line and the operands
+    CHECK_EQ(errorOf([&] { squadBinary(TOK_DIVIDE, s, troops({ 1, 1, 0, 1, 1 }), 6); }),
+             "[Line 6] Runtime error: Division by zero.");
+    CHECK_EQ(errorOf([&] { squadBinary(TOK_PLUS, s, troops({ 1, 2 }), 6); }),
+             "[Line 6] Runtime error: Squads of sizes 5 and 2 cannot be combined.");
+    CHECK_EQ(errorOf([&] { squadBinary(TOK_AND, s, s, 6); }),
+             "[Line 6] Runtime error: Operator 'AND' cannot combine squad troop and squad troop.");
+    CHECK_EQ(errorOf([&] { squadBinary(TOK_PLUS, s, Value::makeCodename("x"), 6); }),
+             "[Line 6] Runtime error: Operator 'PLUS' cannot combine squad troop and codename.");
+    CHECK_EQ(errorOf([&] { squadBinary(TOK_MINUS, s, Value::makeStatus(true), 6); }),
+             "[Line 6] Runtime error: Operator 'MINUS' cannot combine squad troop and status.");
+
+    // Ammo division by zero is IEEE, not an error
+    Value quotient = squadBinary(TOK_DIVIDE, ammo({ 1.0, -1.0, 0.0 }), Value::makeAmmo(0.0), 1);
+    CHECK(quotient.squad().ammo[0] == INF && quotient.squad().ammo[1] == -INF && std::isnan(quotient.squad().ammo[2]));
+
+    CHECK_EQ(run("squad troop s = range(6);\n"
+                 "brief (s % 2 == 0) * s;\n"
+                 "brief s * 0.5 + 1;\n"
+                 "brief -s;"),
+             "[0, 0, 2, 0, 4, 0]\n[1, 1.5, 2, 2.5, 3, 3.5]\n[0, -1, -2, -3, -4, -5]\n");
+}
+
+// =============================================================================
+// 4. REDUCTIONS
+// =============================================================================
+
+TEST_CASE(squadReductions) {
+    Value s = troops({ 4, -7, 12, 0, 3 });
+    CHECK_EQ(builtin(BUILTIN_SUM, s).troop, 12);
+    CHECK_EQ(builtin(BUILTIN_MIN, s).troop, -7);
+    CHECK_EQ(builtin(BUILTIN_MAX, s).troop, 12);
+    CHECK_EQ(builtin(BUILTIN_SIZE, s).troop, 5);
+    CHECK_EQ(builtin(BUILTIN_SUM, troops({ INT_MAX, 1 })).troop, INT_MIN);
+    CHECK_EQ(builtin(BUILTIN_SUM, troops({})).troop, 0);
+    CHECK(builtin(BUILTIN_SUM, ammo({})).ammo == 0.0);
+    CHECK_EQ(errorOf([&] { callBuiltin(BUILTIN_MIN, &s, 2), callBuiltin(BUILTIN_MAX, &s, 2); }), "");
+    Value empty = ammo({});
+    CHECK_EQ(errorOf([&] { callBuiltin(BUILTIN_MAX, &empty, 2); }), "[Line 2] Runtime error: max() of an empty squad.");
+
+    // Ammo sums add the even and the odd elements apart, then the two
+    // totals, then a last odd element: here 2, where left to right gives 1
+    CHECK(builtin(BUILTIN_SUM, ammo({ 1e16, 1.0, -1e16, 1.0 })).ammo == 2.0);
+    CHECK(builtin(BUILTIN_SUM, ammo({ 1e16, 1.0, -1e16, 1.0, 0.5 })).ammo == 2.5);
+
+    // NaN: a sum of one is NaN. min and max keep the current best when a
+    // comparison fails, so a NaN loses unless it is where they start.
+    CHECK(std::isnan(builtin(BUILTIN_SUM, ammo({ 1.0, NaN, 2.0 })).ammo));
+    CHECK(builtin(BUILTIN_MIN, ammo({ 1.0, NaN, 0.5 })).ammo == 0.5);
+    CHECK(builtin(BUILTIN_MAX, ammo({ 1.0, NaN, 0.5, NaN, 3.0 })).ammo == 3.0);
+    CHECK(std::isnan(builtin(BUILTIN_MIN, ammo({ NaN, 1.0, 0.5 })).ammo));
+    CHECK(std::isnan(builtin(BUILTIN_MAX, ammo({ NaN })).ammo));
+    CHECK(builtin(BUILTIN_MIN, ammo({ INF, -INF, 0.0 })).ammo == -INF);
+    CHECK(builtin(BUILTIN_MAX, ammo({ -DBL_MAX, -INF })).ammo == -DBL_MAX);
+}
+
+// =============================================================================
+// 5. PACKED AND SCALAR KERNELS
+// =============================================================================
+
+// Operands of 'n' elements in every shape the kernels see: both squads,
+// and a number on either side
+struct Operands {
+    Value troopA, troopB, ammoA, ammoB;
+};
+
+static Operands randomOperands(size_t n, mt19937& random) {
+    // Edge values turn up often enough to land in every lane position
+    const int troopEdges[] = { 0, 1, -1, INT_MAX, INT_MIN, 7 };
+    const double ammoEdges[] = { 0.0, -0.0, 1.0, NaN, INF, -INF, DBL_MIN, 1e300, -2.5 };
+    vector<int> ta(n), tb(n);
+    vector<double> aa(n), ab(n);
+    for (size_t i = 0; i < n; i++) {
+        ta[i] = random() % 4 == 0 ? troopEdges[random() % 6] : (int)(random() % 2001) - 1000;
+        tb[i] = random() % 4 == 0 ? troopEdges[random() % 6] : (int)(random() % 2001) - 1000;
+        if (tb[i] == 0) tb[i] = 3;   // Troop division checks divisors one by one
+        aa[i] = random() % 4 == 0 ? ammoEdges[random() % 9] : ((int)(random() % 20001) - 10000) / 64.0;
+        ab[i] = random() % 4 == 0 ? ammoEdges[random() % 9] : ((int)(random() % 20001) - 10000) / 64.0;
+    }
+    return Operands{ troops(ta), troops(tb), ammo(aa), ammo(ab) };
+}
+
+// Every operator and built-in over 'operands', as one list of results
+static vector<Value> everything(const Operands& x) {
+    const TokenType ops[] = { TOK_PLUS, TOK_MINUS, TOK_MULTIPLY, TOK_DIVIDE, TOK_MODULO, TOK_LESS, TOK_GREATER,
+                              TOK_LESS_EQUAL, TOK_GREATER_EQUAL, TOK_EQUAL, TOK_NOT_EQUAL };
+    Value troopNumber = Value::makeTroop(-3);
+    Value ammoNumber = Value::makeAmmo(0.75);
+    vector<Value> results;
+    for (TokenType op : ops) {
+        results.push_back(squadBinary(op, x.troopA, x.troopB, 1));
+        results.push_back(squadBinary(op, x.troopA, troopNumber, 1));
+        results.push_back(squadBinary(op, troopNumber, x.troopB, 1));
+        results.push_back(squadBinary(op, x.ammoA, x.ammoB, 1));
+        results.push_back(squadBinary(op, x.ammoA, ammoNumber, 1));
+        results.push_back(squadBinary(op, ammoNumber, x.ammoB, 1));
+        results.push_back(squadBinary(op, x.troopA, x.ammoB, 1));
+    }
+    results.push_back(squadNegate(x.troopA, 1));
+    results.push_back(squadNegate(x.ammoA, 1));
+    const Builtin reductions[] = { BUILTIN_SUM, BUILTIN_MIN, BUILTIN_MAX };
+    for (Builtin which : reductions) {
+        if (which != BUILTIN_SUM && x.troopA.squadSize() == 0) continue;
+        results.push_back(builtin(which, x.troopA));
+        results.push_back(builtin(which, x.ammoA));
+        results.push_back(builtin(which, x.ammoB));
+    }
+    return results;
+}
+
+// Lengths around every multiple of the lane counts (4 troops, 2 ammo)
+TEST_CASE(squadPackedMatchesScalar) {
+    mt19937 random(20260418);
+    bool packed = setSquadPackedKernels(true);
+    for (size_t n = 0; n <= 67; n++) {
+        for (int round = 0; round < 3; round++) {
+            Operands operands = randomOperands(n, random);
+            setSquadPackedKernels(true);
+            vector<Value> fast = everything(operands);
+            setSquadPackedKernels(false);
+            vector<Value> plain = everything(operands);
+            CHECK_EQ(fast.size(), plain.size());
+            for (size_t i = 0; i < fast.size() && i < plain.size(); i++) {
+                if (!sameBits(fast[i], plain[i])) {
+                    CHECK_EQ("length " + to_string(n) + ", result " + to_string(i), string("bit-identical"));
+                    break;
+                }
+            }
+        }
+    }
+    setSquadPackedKernels(packed);
+}
+
+// Elementwise results at lengths that leave a remainder, against the
+// scalar operators one element at a time
+TEST_CASE(squadLengthsOffTheLanes) {
+    mt19937 random(7);
+    for (size_t n : { 1, 2, 3, 5, 6, 7, 9, 13, 31, 33, 1001, 1003 }) {
+        Operands x = randomOperands(n, random);
+        Value sums = squadBinary(TOK_PLUS, x.ammoA, x.ammoB, 1);
+        Value products = squadBinary(TOK_MULTIPLY, x.troopA, x.troopB, 1);
+        Value mask = squadBinary(TOK_LESS, x.ammoA, x.ammoB, 1);
+        bool ok = sums.squadSize() == n && products.squadSize() == n && mask.squadSize() == n;
+        for (size_t i = 0; ok && i < n; i++) {
+            double sum = x.ammoA.squad().ammo[i] + x.ammoB.squad().ammo[i];
+            int product = (int)((unsigned)x.troopA.squad().troops[i] * (unsigned)x.troopB.squad().troops[i]);
+            ok = sameAmmo(sums.squad().ammo[i], sum) && products.squad().troops[i] == product &&
+                 mask.squad().troops[i] == (x.ammoA.squad().ammo[i] < x.ammoB.squad().ammo[i] ? 1 : 0);
+        }
+        if (!ok) CHECK_EQ("length " + to_string(n), string("matches the scalar operators"));
+
+        unsigned total = 0;
+        for (int t : x.troopA.squad().troops) total += (unsigned)t;
+        CHECK_EQ(builtin(BUILTIN_SUM, x.troopA).troop, (int)total);
+        CHECK_EQ(builtin(BUILTIN_MIN, x.troopA).troop,
+                 *min_element(x.troopA.squad().troops.begin(), x.troopA.squad().troops.end()));
+        CHECK_EQ(builtin(BUILTIN_MAX, x.troopA).troop,
+                 *max_element(x.troopA.squad().troops.begin(), x.troopA.squad().troops.end()));
+    }
+}
@@ -0,0 +1,123 @@
+#include "testing.h"
+#include "telemetry.h"
+#include <iomanip>
+#include <vector>
+#include <sstream>
+#include <thread>
+
+// What --stats and --stats-json report: a PhaseScope times and counts the
+// work between its construction and destruction, and printJson writes the
+// phases as one JSON object that any parser must accept, whatever bytes
+// a phase name holds.
+
+// =============================================================================
+// 1. PHASE SCOPES AND COUNTERS
+// =============================================================================
+
+TEST_CASE(telemetryPhaseScope) {
+    Telemetry::instance().reset();
+    const int blocks = 50;
+    {
+        PhaseScope phase("unit");
+        vector<vector<char>> memory;
+        for (int i = 0; i < blocks; i++) memory.emplace_back(1000);
+        this_thread::sleep_for(chrono::milliseconds(5));
+        phase.setBytes(1234);
+        phase.setTokens(56);
+    }
+    { PhaseScope empty("empty"); }
+
+    const vector<PhaseStats>& phases = Telemetry::instance().getPhases();
+    CHECK_EQ(phases.size(), (size_t)2);
+    if (phases.size() != 2) return;
+    const PhaseStats& unit = phases[0];
+    CHECK_EQ(unit.name, "unit");
+    CHECK_EQ(unit.bytes, (size_t)1234);
+    CHECK_EQ(unit.tokens, (size_t)56);
+    CHECK(unit.wallMs >= 4.0);
+    CHECK(unit.allocations >= (uint64_t)blocks);
+    CHECK(unit.allocatedBytes >= (uint64_t)blocks * 1000);
+    CHECK(unit.peakRss > 0);
+    CHECK(unit.peakRss <= peakResidentBytes());
+
+    // Nothing allocated in a scope that does nothing, bar the record itself
+    CHECK_EQ(phases[1].name, "empty");
+    CHECK_EQ(phases[1].allocatedBytes < 1000, true);
+    CHECK_EQ(phases[1].tokens, (size_t)0);
+    Telemetry::instance().reset();
+    CHECK(Telemetry::instance().getPhases().empty());
+
+    // The counters see every operator new. The block goes through a
+    // volatile so the compiler cannot drop the allocations.
+    uint64_t count = allocationCount();
+    uint64_t bytes = allocatedByteCount();
+    static vector<int>* volatile block;
+    block = new vector<int>(256);
+    CHECK(allocationCount() >= count + 2);
+    CHECK(allocatedByteCount() >= bytes + 256 * sizeof(int));
+    delete block;
+}
+
+TEST_CASE(telemetryTokensPerSecond) {
+    PhaseStats stats;
+    CHECK_EQ(stats.tokensPerSecond(), 0.0);
+    stats.tokens = 1000;
+    CHECK_EQ(stats.tokensPerSecond(), 0.0);   // No time measured
+    stats.wallMs = 500.0;
+    CHECK_EQ(stats.tokensPerSecond(), 2000.0);
+}
+
+// =============================================================================
+// 2. JSON
+// =============================================================================
+
+TEST_CASE(telemetryJsonShape) {
+    Telemetry telemetry;
+    ostringstream empty;
+    telemetry.printJson(empty);
+    CHECK_EQ(empty.str(), "{\"phases\":[]}\n");
+
+    PhaseStats scan;
+    scan.name = "scan";
+    scan.wallMs = 2.5;
+    scan.bytes = 4096;
+    scan.tokens = 500;
+    scan.allocations = 3;
+    scan.allocatedBytes = 128;
+    scan.peakRss = 65536;
+    telemetry.record(scan);
+    PhaseStats run;
+    run.name = "run";
+    telemetry.record(run);
+
+    // The stream's own formatting is left as it was
+    ostringstream out;
+    out << setprecision(2);
+    telemetry.printJson(out);
+    out << 1.0 / 3;
+    CHECK_EQ(out.str(),
+             "{\"phases\":["
+             "{\"name\":\"scan\",\"wall_ms\":2.500,\"tokens\":500,\"tokens_per_sec\":200000.000,\"bytes\":4096,"
+             "\"allocations\":3,\"allocated_bytes\":128,\"peak_rss_bytes\":65536},"
+             "{\"name\":\"run\",\"wall_ms\":0.000,\"tokens\":0,\"tokens_per_sec\":0.000,\"bytes\":0,"
+             "\"allocations\":0,\"allocated_bytes\":0,\"peak_rss_bytes\":0}"
+             "]}\n"
+             "0.33");
+}
+
+// Quotes and backslashes are escaped, and every byte below 0x20 is \u00XX
+TEST_CASE(telemetryJsonEscapes) {
+    Telemetry telemetry;
+    PhaseStats stats;
+    stats.name = string("a\"b\\c\n\t\r", 8) + '\0' + "\x01\x1f\x7f" + "\xc3\xa9";
+    telemetry.record(stats);
+    ostringstream out;
+    telemetry.printJson(out);
+    string json = out.str();
+    size_t start = json.find("\"name\":\"") + 8;
+    CHECK_EQ(json.substr(start, json.find("\",\"wall_ms\"") - start),
+             "a\\\"b\\\\c\\u000a\\u0009\\u000d\\u0000\\u0001\\u001f\x7f\xc3\xa9");
+    for (char c : json) {
+        if ((unsigned char)c < 0x20 && c != '\n') CHECK_EQ((int)c, -1);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+using namespace std;
+
+// A minimal test harness: TEST_CASE registers a function at static
+// initialization, and testmain.cpp runs every registered case (or those
+// whose names contain an argument). A failed CHECK is reported with its
+// file and line and the case carries on. BENCHMARK registers a function
+// that prints its own timings; those run only with --bench.
+
+// =============================================================================
+// 1. TEST REGISTRY
+// =============================================================================
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+vector<TestCase>& testCases();
+vector<TestCase>& benchmarks();
+
+struct TestRegistration {
+    TestRegistration(vector<TestCase>& list, const char* name, void (*run)()) { list.push_back({ name, run }); }
+};
+
+#define TEST_CASE(name)                                                      \
+    static void name();                                                      \
+    static TestRegistration name##Registration(testCases(), #name, name);    \
+    static void name()
+
+#define BENCHMARK(name)                                                      \
+    static void name();                                                      \
+    static TestRegistration name##Registration(benchmarks(), #name, name);   \
+    static void name()
+
+// =============================================================================
+// 2. CHECKS
+// =============================================================================
+
+void checkFailed(const char* file, int line, const string& message);
+
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) checkFailed(__FILE__, __LINE__, "CHECK(" #condition ")");  \
+    } while (0)
+
+template <typename A, typename B>
+void checkEqual(const A& actual, const B& expected, const char* text, const char* file, int line) {
+    if (actual == expected) return;
+    ostringstream message;
+    message << text << "\n    actual:   " << actual << "\n    expected: " << expected;
+    checkFailed(file, line, message.str());
+}
+
+#define CHECK_EQ(actual, expected) \
+    checkEqual((actual), (expected), "CHECK_EQ(" #actual ", " #expected ")", __FILE__, __LINE__)
+
+// =============================================================================
+// 3. TEST FILES
+// =============================================================================
+
+// Path of a file under the Tests directory: the working directory, or the
+// directory given with --dir
+string testFile(const string& name);
+
+#endif // TESTING_H
@@ -0,0 +1,74 @@
+#include "testing.h"
+#include <iostream>
+
+// Usage: Tests [--dir <Tests directory>] [--bench] [name filter...]
+
+// =============================================================================
+// 1. REGISTRY AND CHECKS
+// =============================================================================
+
+static string testDirectory = ".";
+static int failedChecks = 0;
+
+vector<TestCase>& testCases() {
+    static vector<TestCase> cases;
+    return cases;
+}
+
+vector<TestCase>& benchmarks() {
+    static vector<TestCase> cases;
+    return cases;
+}
+
+void checkFailed(const char* file, int line, const string& message) {
+    cout << "    " << file << ":" << line << ": " << message << endl;
+    failedChecks++;
+}
+
+string testFile(const string& name) {
+    return testDirectory + "/" + name;
+}
+
+// =============================================================================
+// 2. MAIN FUNCTION
+// =============================================================================
+
+int main(int argc, char* argv[]) {
+    vector<string> filters;
+    bool bench = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            testDirectory = argv[++i];
+        } else if (arg == "--bench") {
+            bench = true;
+        } else {
+            filters.push_back(arg);
+        }
+    }
+
+    int run = 0;
+    int failed = 0;
+    for (const TestCase& test : bench ? benchmarks() : testCases()) {
+        bool selected = filters.empty();
+        for (const string& filter : filters) {
+            if (string(test.name).find(filter) != string::npos) selected = true;
+        }
+        if (!selected) continue;
+
+        cout << "[ RUN  ] " << test.name << endl;
+        int before = failedChecks;
+        try {
+            test.run();
+        } catch (exception& e) {
+            checkFailed(__FILE__, __LINE__, string("Unexpected exception: ") + e.what());
+        }
+        bool passed = failedChecks == before;
+        cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << test.name << endl;
+        run++;
+        if (!passed) failed++;
+    }
+
+    cout << endl << run - failed << " of " << run << (bench ? " benchmark(s)" : " test(s)") << " passed." << endl;
+    return failed == 0 ? 0 : 1;
+}